@@ -0,0 +1,111 @@
+// AiffFile.h - Declares the AiffFile class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef AIFF_FILE_H
+#define AIFF_FILE_H
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "BitDepth.h"
+#include "ConversionMethod.h"
+#include "LibCppLogging.h"
+#include "ChunkIndex.h"
+#include "PcmFile.h"
+
+/// @brief An AIFF or uncompressed AIFF-C file.
+///
+/// AIFF stores big endian samples, as does AIFF-C with the 'NONE' or 'twos'
+/// compression types; 'sowt' is the same format with little endian samples.
+/// Other AIFF-C compression types are rejected when the file is opened.
+class AiffFile : public PcmFile
+{
+public:
+    AiffFile(std::string fileName, std::shared_ptr<Logging::Logger> logger);
+
+    int BitsPerSample() const override { return sampleSize; }
+
+    long SampleRate() const override { return sampleRate; }
+
+    void Open() override;
+
+    /// @brief The FORM type, which is "AIFF" or "AIFC".
+    std::string FormType() const { return formType; }
+
+    /// @brief The AIFF-C compression type, or "NONE" for plain AIFF.
+    std::string CompressionType() const { return compressionType; }
+
+    int Channels() const override { return channels; }
+
+    /// @brief The number of samples in each channel.
+    std::uint32_t SampleFrames() const { return sampleFrames; }
+
+    /// @brief Locates the chunks other than 'COMM' and 'SSND', in file order.
+    const ChunkIndex& OtherChunks() const { return otherChunks; }
+
+    bool Convert(
+        std::string outputFileName,
+        BitDepth depth,
+        ConversionMethod method) override;
+
+    /// @brief Decodes the 80-bit IEEE extended sample rate in a COMM chunk.
+    static long DecodeSampleRate(const std::uint8_t* data);
+private:
+    static constexpr size_t CommonSize{ 18 };
+    static constexpr size_t SampleRateSize{ 10 };
+
+    std::string formType;
+    std::string compressionType;
+    int channels;
+    std::uint32_t sampleFrames;
+    int sampleSize;
+    long sampleRate;
+
+    /// @brief The sample rate as stored, so conversions write it unchanged
+    /// rather than re-encoding it.
+    std::uint8_t sampleRateBytes[SampleRateSize];
+
+    /// @brief The AIFF-C compression type and name that follow the common
+    /// fields in the COMM chunk, copied as-is to conversions.
+    std::vector<std::uint8_t> compressionInfo;
+
+    ChunkIndex otherChunks;
+
+    /// @brief The FORM size and the COMM and SSND chunks as stored, which
+    /// say whether the file is laid out as Convert would write it.
+    std::uint32_t formSize;
+    ChunkIndexEntry commonChunk;
+    ChunkIndexEntry soundChunk;
+    std::uint32_t soundBlockSize;
+
+    void ReadBytes(void* data, size_t size);
+
+    void ReadCommon(const ChunkIndexEntry& chunk);
+
+    void ReadSoundDataHeader(const ChunkIndexEntry& chunk);
+
+    void WriteChunkHeader(std::string id, std::uint32_t dataSize);
+
+    void WriteCommon(BitDepth depth);
+
+    /// @brief Whether the file is laid out exactly as Convert would write
+    /// it at depth: COMM first, the other chunks after it with nothing
+    /// between them, and SSND last with no offset or block size.
+    bool HasConvertedLayout(BitDepth depth) const;
+};
+
+#endif
@@ -0,0 +1,96 @@
+// AnalysisControl.h - Declares the AnalysisControl and ControlledSource
+// classes.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ANALYSIS_CONTROL_H
+#define ANALYSIS_CONTROL_H
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "ByteSource.h"
+
+/// @brief Lets one thread pause or cancel an analysis running on another.
+class AnalysisControl
+{
+public:
+    void Pause();
+
+    void Resume();
+
+    /// @brief Stops the analysis for good, waking it if it is paused.
+    void Cancel();
+
+    bool IsPaused() const { return paused.load(std::memory_order_acquire); }
+
+    bool IsCancelled() const
+    {
+        return cancelled.load(std::memory_order_acquire);
+    }
+
+    /// @brief Waits for as long as the analysis is paused.
+    /// @return False if the analysis is cancelled.
+    bool WaitWhilePaused();
+private:
+    std::atomic<bool> paused{ false };
+    std::atomic<bool> cancelled{ false };
+    std::mutex mutex;
+    std::condition_variable resumed;
+};
+
+/// @brief Reads through another source on behalf of an analysis that can be
+/// paused and cancelled part way through a file.
+///
+/// Reads wait while the analysis is paused and find the end of the source
+/// once it is cancelled, so a long file stops promptly without the media
+/// file knowing about either.
+class ControlledSource : public ByteSource
+{
+public:
+    /// @brief Called after each read with the bytes read so far.
+    using ReadHandler = std::function<void(std::uint64_t)>;
+
+    /// @param control May be nullptr, if the reads only need to be counted.
+    ControlledSource(std::shared_ptr<ByteSource> source, 
+                     AnalysisControl* control, 
+                     ReadHandler handler);
+
+    size_t Read(void* data, size_t size) override;
+
+    bool Seek(std::uint64_t position) override 
+    { 
+        return source->Seek(position); 
+    }
+
+    std::uint64_t Position() const override { return source->Position(); }
+
+    std::uint64_t Size() const override { return source->Size(); }
+
+    bool HasFailed() const override { return source->HasFailed(); }
+
+    std::uint64_t BytesRead() const { return bytesRead; }
+private:
+    std::shared_ptr<ByteSource> source;
+    AnalysisControl* control;
+    ReadHandler handler;
+    std::uint64_t bytesRead = 0;
+};
+
+#endif
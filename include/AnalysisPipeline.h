@@ -0,0 +1,152 @@
+// AnalysisPipeline.h - Declares the AnalysisPipeline class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ANALYSIS_PIPELINE_H
+#define ANALYSIS_PIPELINE_H
+
+#include <memory>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include "SampleAnalyzer.h"
+#include "SampleRing.h"
+
+/// @brief Passes each block of a single decode to every analyzer, so any
+/// number of them share one pass over the file.
+///
+/// Analyzers that are done are dropped from the blocks that follow, and
+/// once all of them are, IsDone tells the decoder it can stop reading.
+///
+/// By default each block is analyzed on the decoder's thread as it is
+/// decoded. With analysis threads, the analyzers are shared out between
+/// them and Process only copies the block into a SampleRing, so decoding
+/// the next block overlaps with analyzing the last.
+class AnalysisPipeline
+{
+public:
+    AnalysisPipeline() = default;
+
+    ~AnalysisPipeline() { End(); }
+
+    AnalysisPipeline(const AnalysisPipeline&) = delete;
+
+    AnalysisPipeline& operator=(const AnalysisPipeline&) = delete;
+
+    /// @brief Adds an analyzer, which takes part from the next Begin.
+    void Add(std::shared_ptr<SampleAnalyzer> analyzer);
+
+    /// @brief Removes every analyzer.
+    void Clear();
+
+    const std::vector<std::shared_ptr<SampleAnalyzer>>& Analyzers() const
+    {
+        return analyzers;
+    }
+
+    /// @brief The first analyzer of type T, or nullptr if there is none.
+    template <typename T>
+    std::shared_ptr<T> Find() const
+    {
+        for (const std::shared_ptr<SampleAnalyzer>& analyzer : analyzers)
+        {
+            std::shared_ptr<T> match = std::dynamic_pointer_cast<T>(analyzer);
+            if (match != nullptr)
+                return match;
+        }
+        return nullptr;
+    }
+
+    /// @brief Sets whether, from the next Begin, the analyzers run on
+    /// threads of their own and how blocks are buffered for them.
+    void SetRingSettings(const SampleRingSettings& settings)
+    {
+        ringSettings = settings;
+    }
+
+    const SampleRingSettings& RingSettings() const { return ringSettings; }
+
+    /// @brief How often the decoder and the analysis threads waited for
+    /// each other in the last analysis that used threads.
+    const SampleRingStats& RingStats() const { return ringStats; }
+
+    /// @brief Starts every analyzer on samples in format, ending any
+    /// analysis still running.
+    void Begin(const SampleFormat& format);
+
+    bool HasBegun() const { return hasBegun; }
+
+    const SampleFormat& Format() const { return format; }
+
+    /// @brief Passes the block to each analyzer that isn't done. A block
+    /// with a different channel count than the format is left out, as no
+    /// analyzer could carry its state across it.
+    void Process(const SampleBlock& block);
+
+    /// @brief Waits for the analysis threads to finish the blocks given to
+    /// them. Must be called before the results are read.
+    void End();
+
+    /// @brief Whether every analyzer is done, so no more samples are needed.
+    bool IsDone() const;
+
+    /// @brief Whether every analyzer can analyze a file in parts.
+    bool CanAppend() const;
+
+    /// @brief Passes samples from before the part of a file being analyzed
+    /// to every analyzer's Prime. Must be called after Begin and before the
+    /// first Process.
+    void Prime(const SampleBlock& block);
+
+    /// @brief Adds the analysis of the part of the file that follows, made
+    /// by a pipeline with the same analyzers in the same order. Both must
+    /// have ended.
+    /// @return False, leaving the results as they were, if the analyzers
+    /// don't match or can't be appended.
+    bool Append(const AnalysisPipeline& next);
+private:
+    /// @brief An analysis thread and the analyzers it runs.
+    struct Worker
+    {
+        std::vector<SampleAnalyzer*> analyzers;
+        std::thread thread;
+    };
+
+    std::vector<std::shared_ptr<SampleAnalyzer>> analyzers;
+
+    /// @brief The analyzers that still want samples and aren't given to an
+    /// analysis thread.
+    std::vector<SampleAnalyzer*> active;
+
+    SampleFormat format;
+    bool hasBegun = false;
+    SampleRingSettings ringSettings;
+    SampleRingStats ringStats;
+    std::unique_ptr<SampleRing> ring;
+    std::vector<Worker> workers;
+
+    /// @brief The number of analysis threads whose analyzers are all done.
+    std::atomic<size_t> finishedWorkers{ 0 };
+
+    void StartWorkers();
+
+    /// @brief Runs on an analysis thread, passing each block from the ring
+    /// to the worker's analyzers until they are done or the ring is empty.
+    void RunWorker(int index);
+
+    static void DropFinished(std::vector<SampleAnalyzer*>& analyzers);
+};
+
+#endif
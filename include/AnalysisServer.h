@@ -0,0 +1,206 @@
+// AnalysisServer.h - Declares the AnalysisServer class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ANALYSIS_SERVER_H
+#define ANALYSIS_SERVER_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include "BatchAnalyzer.h"
+#include "WorkQueue.h"
+#include "LibCppLogging.h"
+
+/// @brief Controls where an AnalysisServer listens and how it works.
+struct ServerSettings
+{
+    /// @brief The path of the Unix domain socket to listen on.
+    std::string socketPath;
+
+    /// @brief The number of files analyzed or converted at once.
+    unsigned int workerCount = 1;
+
+    /// @brief The most analysis results kept for files that haven't changed
+    /// since they were analyzed.
+    size_t cacheCapacity = 100000;
+
+    /// @brief How the files are read and whether they are verified.
+    BatchSettings batch;
+};
+
+/// @brief Counts of what an AnalysisServer has done since it started.
+struct ServerStats
+{
+    unsigned long connections = 0;
+    unsigned long requests = 0;
+
+    /// @brief Analyze requests answered from the cache.
+    unsigned long cacheHits = 0;
+
+    unsigned long filesAnalyzed = 0;
+    unsigned long filesConverted = 0;
+};
+
+/// @brief Answers analysis requests over a Unix domain socket, so callers
+/// that analyze files one at a time don't pay for starting a process each
+/// time.
+///
+/// Each request is a line of tab separated fields, shown with spaces here,
+/// and each response is a line of JSON:
+///
+///     analyze <path>    The file's inventory row, with analysis columns.
+///                       While the file is read, lines with a "progress"
+///                       member report how far it has got.
+///     probe <path>      The file's inventory row, from its header alone.
+///     convert <input> <output> <8|16|24|32> [directcopy|linearscale]
+///                       {"converted":<output>} once it is written.
+///     stats             The counts in ServerStats.
+///     ping              {"pong":true}
+///
+/// Failures are reported as {"error":<message>}, or in the inventory row's
+/// error member for a file that can't be analyzed. A connection can send
+/// any number of requests, which are answered in order.
+///
+/// Analysis and conversion run on a pool of workers. Analysis results are
+/// kept for as long as the file's size and modification time stay the
+/// same, so asking again about a file costs a stat.
+class AnalysisServer
+{
+public:
+    /// @brief How often a request waiting for its file reports progress.
+    static constexpr std::chrono::milliseconds ProgressInterval{ 250 };
+
+    /// @brief The longest request line accepted.
+    static constexpr size_t MaxRequestSize{ 64 * 1024 };
+
+    /// @param logger Where Start reports errors. Requests are never logged.
+    AnalysisServer(ServerSettings settings, 
+                   std::shared_ptr<Logging::Logger> logger);
+
+    ~AnalysisServer();
+
+    AnalysisServer(const AnalysisServer&) = delete;
+
+    AnalysisServer& operator=(const AnalysisServer&) = delete;
+
+    /// @brief Listens on the socket and starts the workers.
+    /// @return False if the socket couldn't be created.
+    bool Start();
+
+    /// @brief Accepts connections until Stop is called, then waits for the
+    /// requests already made to be answered.
+    void Run();
+
+    /// @brief Makes Run return. Safe to call from a signal handler.
+    void Stop();
+
+    ServerStats Stats() const;
+private:
+    /// @brief A request handed to the workers.
+    struct Job
+    {
+        std::vector<std::string> fields;
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::uint64_t bytesRead = 0;
+        bool done = false;
+        std::string response;
+    };
+
+    /// @brief The analysis of a file as it was when it was analyzed.
+    struct CachedResult
+    {
+        std::uint64_t size = 0;
+        std::int64_t modified = 0;
+        std::string response;
+        std::list<std::string>::iterator age;
+    };
+
+    ServerSettings settings;
+    std::shared_ptr<Logging::Logger> logger;
+    /// @brief The listening socket, atomic as Stop may read it from a
+    /// signal handler or another thread.
+    std::atomic<int> listener{ -1 };
+    std::atomic<bool> stopping{ false };
+    WorkQueue<std::shared_ptr<Job>> jobs;
+    std::vector<std::thread> workers;
+
+    /// @brief The sockets of the connections being served.
+    std::unordered_set<int> clients;
+    std::mutex clientsMutex;
+    std::condition_variable clientsClosed;
+
+    std::unordered_map<std::string, CachedResult> cache;
+
+    /// @brief The paths in the cache, most recently used first.
+    std::list<std::string> cacheAges;
+    std::mutex cacheMutex;
+
+    std::atomic<unsigned long> connections{ 0 };
+    std::atomic<unsigned long> requests{ 0 };
+    std::atomic<unsigned long> cacheHits{ 0 };
+    std::atomic<unsigned long> filesAnalyzed{ 0 };
+    std::atomic<unsigned long> filesConverted{ 0 };
+
+    /// @brief Reads and answers the requests on a connection until it is
+    /// closed.
+    void Serve(int client);
+
+    /// @return False if the response couldn't be sent.
+    bool HandleRequest(int client, const std::string& line);
+
+    bool HandleAnalyze(int client, const std::string& path);
+
+    /// @brief Queues a job and waits for it, sending its progress as it
+    /// runs.
+    /// @return False if the client went away.
+    bool RunJob(int client, std::shared_ptr<Job> job, std::uint64_t total);
+
+    void RunWorker();
+
+    std::string Analyze(Job& job, std::shared_ptr<Logging::Logger> logger);
+
+    std::string Convert(Job& job, std::shared_ptr<Logging::Logger> logger);
+
+    std::string StatsResponse() const;
+
+    bool FindCached(
+        const std::string& path, 
+        std::uint64_t size, 
+        std::int64_t modified, 
+        std::string& response);
+
+    void AddCached(
+        const std::string& path, 
+        std::uint64_t size, 
+        std::int64_t modified, 
+        const std::string& response);
+
+    /// @brief Waits for the connections and workers to finish and removes
+    /// the socket.
+    void Shutdown();
+};
+
+#endif
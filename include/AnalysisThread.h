@@ -18,25 +18,93 @@
 #define ANALYSIS_THREAD_H
 
 #include <vector>
+#include <string>
 #include <memory>
+#include <algorithm>
+#include <sstream>
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
 #include <wx/wx.h>
 #include "MediaFile.h"
+#include "FileReader.h"
+#include "FileTable.h"
+#include "AnalysisControl.h"
+#include "LibCppLogging.h"
 
+/// @brief The outcome of analyzing the file in one row of the file list.
+struct FileResult
+{
+    size_t row = 0;
+    int bitsPerSample = 0;
+    long sampleRate = 0;
+    FileVerdict verdict = FileVerdict::Pending;
+};
+
+/// @brief Analyzes a list of files, posting results to the window as it
+/// goes.
+///
+/// Results are posted in batches, as a per-file event would flood the
+/// window on a list of small files, and progress is weighted by the bytes
+/// read, so one long file doesn't hold the gauge still. The run can be
+/// paused or cancelled through its AnalysisControl; a file cancelled part
+/// way through has no result, while those already posted are kept.
+///
+/// Each file is opened when its turn comes and closed once it is analyzed,
+/// so the run holds no more than a file's worth of descriptors and memory.
 class AnalysisThread : public wxThread
 {
 public:
     static constexpr int StatusUpdateID{ 10000 };
     static constexpr int StatusCompleteID{ 10001 };
 
+    /// @brief The ID of the wxThreadEvent whose payload is a
+    /// std::vector<FileResult>.
+    static constexpr int StatusResultsID{ 10002 };
+
+    /// @brief The most results held back before they are posted.
+    static constexpr size_t ResultBatchSize{ 256 };
+
+    /// @brief The longest results and progress are held back.
+    static constexpr std::chrono::milliseconds PostInterval{ 250 };
+
+    /// @param paths The files to analyze, whose indices are the rows
+    /// posted with their results.
     AnalysisThread(wxFrame* parent, 
-                   std::vector<std::shared_ptr<MediaFile>>& fileList)
-        : parent{ parent }, fileList{ fileList } { }
+                   std::vector<std::string> paths,
+                   std::shared_ptr<Logging::Logger> logger,
+                   std::shared_ptr<AnalysisControl> control)
+        : parent{ parent }, paths{ std::move(paths) }, logger{ logger },
+          control{ control } { }
 
     ExitCode Entry() override;
 private:
+    using Clock = std::chrono::steady_clock;
+
     wxFrame* parent;
-    std::vector<std::shared_ptr<MediaFile>>& fileList;
+    std::vector<std::string> paths;
+    std::shared_ptr<Logging::Logger> logger;
+    std::shared_ptr<AnalysisControl> control;
+    std::vector<FileResult> results;
+
+    /// @brief The size of each file, found before the run starts.
+    std::vector<std::uint64_t> fileSizes;
+    std::uint64_t totalBytes = 0;
+    Clock::time_point lastStatus;
+    Clock::time_point lastResults;
+
+    /// @brief Opens and analyzes the file in the row, reading through a
+    /// ControlledSource so progress is seen and pausing takes effect
+    /// within the file.
+    FileResult AnalyzeFile(size_t row, std::uint64_t bytesBefore);
+
+    /// @brief Posts the progress, if it has been held back long enough or
+    /// force is set.
+    void PostStatus(size_t row, std::uint64_t bytesDone, bool force);
+
+    /// @brief Posts the results held back, if there are enough of them,
+    /// they have been held long enough, or force is set.
+    void PostResults(bool force);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,186 @@
+// BatchAnalyzer.h - Declares the BatchAnalyzer class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BATCH_ANALYZER_H
+#define BATCH_ANALYZER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <memory>
+#include "MediaProbe.h"
+#include "PageCache.h"
+#include "DistinctValueAnalyzer.h"
+#include "LoudnessAnalyzer.h"
+#include "AnalysisControl.h"
+#include "LibCppLogging.h"
+
+/// @brief Controls how a BatchAnalyzer reads and schedules files.
+struct BatchSettings
+{
+    /// @brief The number of files analyzed at once.
+    unsigned int workerCount = 1;
+
+    /// @brief Reads files ahead with io_uring where it is available.
+    bool useIoUring = false;
+
+    /// @brief The number of blocks each worker keeps in flight with io_uring.
+    unsigned int queueDepth = 64;
+
+    /// @brief How reads treat the page cache.
+    CachePolicy cachePolicy = CachePolicy::Normal;
+
+    /// @brief Checks the integrity of formats that carry checksums, in the
+    /// same pass as the analysis.
+    bool verify = false;
+
+    /// @brief Files larger than this many bytes are analyzed in parts of
+    /// about this size, which idle workers take up alongside other files,
+    /// so one long file doesn't leave the batch finishing on a single core.
+    /// 0 analyzes every file whole.
+    std::uint64_t partSize = std::uint64_t{ 256 } * 1024 * 1024;
+};
+
+/// @brief The outcome of analyzing one file in a batch.
+struct BatchResult
+{
+    /// @brief The file's header information; error is set if the file
+    /// couldn't be opened or analyzed.
+    ProbeResult probe;
+
+    bool isUpscaled = false;
+
+    /// @brief The low byte statistics' dither score, from 0 to 1; see
+    /// LowBitResult::score.
+    double ditherScore = 0;
+
+    /// @brief The distinct value statistics, whose analyzed flag is false
+    /// for sample sizes they aren't gathered for.
+    DistinctValueResult distinctValues;
+
+    LoudnessResult loudness;
+
+    /// @brief The integrity verdict for files that were verified, such as
+    /// "ok" or "crc_errors", or empty if the file wasn't verified.
+    std::string integrity;
+};
+
+/// @brief Totals for a completed batch.
+struct BatchStats
+{
+    unsigned long fileCount = 0;
+    unsigned long errorCount = 0;
+    std::uint64_t bytesAnalyzed = 0;
+
+    /// @brief Files whose integrity check found a problem.
+    unsigned long verifyFailureCount = 0;
+
+    double seconds = 0;
+
+    /// @brief True if the workers read through io_uring rather than falling
+    /// back to blocking reads.
+    bool usedIoUring = false;
+
+    /// @brief How much of the analyzed files was left in the page cache,
+    /// measured as each file was finished.
+    CacheResidency cacheResidency;
+
+    /// @brief The folders the walk couldn't finish, each with the reason,
+    /// whose remaining files weren't analyzed.
+    std::vector<std::string> walkErrors;
+};
+
+// The functions that analyze a single file are the API for programs that
+// link with the analysis library. Each call opens, reads and analyzes its
+// own file, sharing nothing with other calls, so any number of threads can
+// analyze files at once. The settings for how a batch is scheduled, such as
+// workerCount, are ignored.
+
+/// @brief Analyzes one file the way a batch does, for callers that get
+/// their files one at a time.
+/// @param logger Where the file writes its errors, or nullptr to discard
+/// them; the result's probe error says whether it failed either way.
+/// @param progress If given, called as the file is read with the bytes of
+/// its AnalysisRange read so far.
+BatchResult AnalyzeMediaFile(
+    const std::string& fileName, 
+    const BatchSettings& settings,
+    std::shared_ptr<Logging::Logger> logger = nullptr,
+    ControlledSource::ReadHandler progress = nullptr);
+
+/// @brief Analyzes a file through a descriptor the caller opened, such as
+/// an upload already on disk, telling its type from its first bytes.
+///
+/// A file is read from its start without moving its file position. A pipe
+/// or socket is read as a stream from where it is, which works for WAVE
+/// and FLAC but not AIFF. The descriptor is left open either way.
+/// @param name The name the result gives the file, which may be empty.
+BatchResult AnalyzeMediaDescriptor(
+    int descriptor,
+    const std::string& name,
+    const BatchSettings& settings,
+    std::shared_ptr<Logging::Logger> logger = nullptr);
+
+/// @brief Analyzes a file the caller holds in memory, telling its type
+/// from its first bytes.
+///
+/// The bytes are read where they are rather than copied, so they only need
+/// to stay alive until the call returns.
+/// @param name The name the result gives the file, which may be empty.
+BatchResult AnalyzeMediaBuffer(
+    const void* data,
+    std::uint64_t size,
+    const std::string& name,
+    const BatchSettings& settings,
+    std::shared_ptr<Logging::Logger> logger = nullptr);
+
+/// @brief Analyzes every supported file under a folder.
+///
+/// Files are found by a directory walk that feeds the workers through a
+/// bounded queue. With io_uring each worker opens the next file while it is
+/// still analyzing the current one and queues reads for both, so the disk
+/// stays busy through the gaps between files that blocking reads leave.
+///
+/// The queue hands out the largest files it holds first, so a batch isn't
+/// left waiting on a long file that happened to be started last. A WAVE,
+/// AIFF or FLAC file larger than BatchSettings::partSize is queued as
+/// parts that any worker can take, read with blocking reads, and joined
+/// into one result by the worker that finishes the last of them.
+class BatchAnalyzer
+{
+public:
+    using ResultHandler = std::function<void(const BatchResult&)>;
+
+    using FileFilter = std::function<bool(const std::string&)>;
+
+    BatchAnalyzer(BatchSettings settings);
+
+    /// @brief Analyzes path, which may be a single file or a folder.
+    /// @param handler Called once per file as results come in. It is called
+    /// from the worker threads, so it must be safe to call concurrently.
+    /// @param filter If given, called with each file the walk finds, which
+    /// is only analyzed if it returns true, such as to pass over files an
+    /// earlier run finished. Files it turns away aren't counted.
+    BatchStats Run(
+        std::string path, 
+        ResultHandler handler, 
+        FileFilter filter = nullptr);
+private:
+    BatchSettings settings;
+};
+
+#endif
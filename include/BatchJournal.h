@@ -0,0 +1,100 @@
+// BatchJournal.h - Declares the BatchJournal class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef BATCH_JOURNAL_H
+#define BATCH_JOURNAL_H
+
+#include <string>
+#include <unordered_set>
+#include <functional>
+#include <mutex>
+#include <chrono>
+#include <cstddef>
+
+/// @brief An append-only record of the files a batch has finished, so a
+/// batch that is interrupted can resume where it stopped.
+///
+/// Each record is a line holding a file's path and the text the batch
+/// keeps for it, such as its inventory row. Records are gathered in memory
+/// and written and synced together, every FlushCount records or once
+/// FlushInterval has passed, so a batch of small files pays for a sync
+/// every so often rather than once per file. A crash loses at most the
+/// records not yet flushed, whose files are simply done again, and a line
+/// the crash cut short is dropped when the journal is next opened.
+///
+/// The first line names the kind of batch that wrote the journal, so one
+/// batch's journal isn't resumed by a batch that would record different
+/// results.
+class BatchJournal
+{
+public:
+    using RecordHandler = std::function<void(const std::string& path, 
+                                             const std::string& text)>;
+
+    static constexpr size_t FlushCount{ 256 };
+
+    static constexpr std::chrono::seconds FlushInterval{ 5 };
+
+    /// @param kind Describes the batch, such as its mode and output format.
+    BatchJournal(std::string fileName, std::string kind);
+
+    BatchJournal(const BatchJournal&) = delete;
+
+    BatchJournal& operator=(const BatchJournal&) = delete;
+
+    /// @brief Flushes and closes the journal.
+    ~BatchJournal();
+
+    /// @brief Opens the journal, creating it if it doesn't exist, and reads
+    /// the records earlier runs left in it.
+    /// @param handler If given, called with each earlier record in the
+    /// order they were written.
+    /// @return Why the journal can't be used, or an empty string if it can.
+    std::string Open(const RecordHandler& handler = nullptr);
+
+    /// @brief Whether an earlier run recorded the file. Records made since
+    /// the journal was opened aren't included, so this can be called while
+    /// other threads call Record.
+    bool Contains(const std::string& path) const;
+
+    /// @brief The number of files earlier runs recorded.
+    size_t EarlierCount() const { return finished.size(); }
+
+    /// @brief Records that a file is finished, writing the records gathered
+    /// so far if it is time to. Safe to call from several threads at once.
+    void Record(const std::string& path, const std::string& text);
+
+    /// @brief Writes and syncs the records not yet on disk.
+    /// @return False if any record couldn't be written, in which case no
+    /// more are, so the journal never holds a gap.
+    bool Flush();
+private:
+    std::string fileName;
+    std::string kind;
+    int descriptor;
+    std::unordered_set<std::string> finished;
+    std::mutex mutex;
+    std::string pending;
+    size_t pendingCount;
+    std::chrono::steady_clock::time_point lastFlush;
+    bool hasFailed;
+
+    /// @brief Writes the pending records; the caller holds the mutex.
+    bool FlushPending();
+};
+
+#endif
@@ -0,0 +1,132 @@
+// BlockPrefetcher.h - Declares the BlockPrefetcher class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BLOCK_PREFETCHER_H
+#define BLOCK_PREFETCHER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "ByteSource.h"
+#include "IoRing.h"
+#include "PageCache.h"
+
+/// @brief Keeps block reads in flight across the files of a batch.
+///
+/// Each call to Add queues a range of a file and returns a ByteSource that
+/// reads it. Up to queueDepth blocks are read ahead with io_uring, starting
+/// with the oldest range that still has unread blocks, so once the current
+/// file's remaining blocks are all requested the next file's reads are
+/// already under way while the current one is still being analyzed.
+///
+/// Ranges must be read in the order they were added. Without io_uring each
+/// read is made with a blocking pread when it is needed instead.
+///
+/// A BlockPrefetcher and its sources are meant to be used from one thread.
+class BlockPrefetcher
+{
+public:
+    static constexpr size_t DefaultBlockSize{ 256 * 1024 };
+
+    BlockPrefetcher(unsigned int queueDepth, 
+                    size_t blockSize = DefaultBlockSize);
+
+    ~BlockPrefetcher();
+
+    BlockPrefetcher(const BlockPrefetcher&) = delete;
+
+    BlockPrefetcher& operator=(const BlockPrefetcher&) = delete;
+
+    /// @brief True if reads are queued with io_uring rather than made with
+    /// blocking calls.
+    bool IsAsync() const { return ring.IsAvailable(); }
+
+    /// @brief Sets how reads treat the page cache for ranges added after.
+    /// With streaming, each file is dropped from the cache once its range
+    /// is closed.
+    void SetCachePolicy(CachePolicy policy) { cachePolicy = policy; }
+
+    /// @brief Queues a range of a file to be read.
+    /// @return A source for the range, or nullptr if the file can't be
+    /// opened. Reading starts at range.offset.
+    std::shared_ptr<ByteSource> Add(std::string fileName, ByteRange range);
+
+    /// @brief The total number of bytes read from storage so far.
+    std::uint64_t BytesRead() const { return bytesRead; }
+private:
+    friend class PrefetchedRange;
+
+    enum class BlockState
+    {
+        Free,
+        Reading,
+        Ready
+    };
+
+    struct RangeState
+    {
+        int descriptor = -1;
+        std::uint64_t end = 0;
+        std::uint64_t nextRequest = 0;
+        std::uint64_t position = 0;
+        std::uint64_t size = 0;
+        unsigned int blocksInUse = 0;
+        bool isClosed = false;
+        bool hasFailed = false;
+        CachePolicy cachePolicy = CachePolicy::Normal;
+    };
+
+    struct Block
+    {
+        std::vector<std::uint8_t> data;
+        BlockState state = BlockState::Free;
+        std::shared_ptr<RangeState> range;
+        std::uint64_t offset = 0;
+        size_t length = 0;
+    };
+
+    IoRing ring;
+    size_t blockSize;
+    std::vector<Block> blocks;
+    std::deque<std::shared_ptr<RangeState>> ranges;
+    std::uint64_t bytesRead;
+    CachePolicy cachePolicy;
+
+    size_t Read(RangeState& range, void* data, size_t size);
+
+    void Close(RangeState& range);
+
+    void RequestBlocks();
+
+    size_t ReadDirect(RangeState& range, void* data, size_t size);
+
+    bool WaitForBlock();
+
+    void Release(Block& block);
+
+    Block* FindBlock(RangeState& range);
+
+    Block* FindFreeBlock();
+
+    void RemoveClosedRanges();
+
+    void CloseRangeFile(RangeState& range);
+};
+
+#endif
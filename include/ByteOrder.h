@@ -0,0 +1,92 @@
+// ByteOrder.h - Declares helpers for decoding and encoding integers by byte.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BYTE_ORDER_H
+#define BYTE_ORDER_H
+
+#include <cstdint>
+#include <cstddef>
+
+/// @brief The order of the bytes in a multi-byte integer.
+enum class Endianness
+{
+    Little,
+    Big
+};
+
+/// @brief Decodes an unsigned little endian integer of the given byte count.
+/// @param data Points to the first (least significant) byte.
+/// @param size The number of bytes in the integer, from 1 to 4.
+inline std::uint32_t DecodeLittleEndian(const std::uint8_t* data, int size)
+{
+    std::uint32_t value{ 0 };
+    for (int i = size - 1; i >= 0; i--)
+        value = (value << 8) | data[i];
+    return value;
+}
+
+/// @brief Decodes an unsigned big endian integer of the given byte count.
+/// @param data Points to the first (most significant) byte.
+/// @param size The number of bytes in the integer, from 1 to 4.
+inline std::uint32_t DecodeBigEndian(const std::uint8_t* data, int size)
+{
+    std::uint32_t value{ 0 };
+    for (int i = 0; i < size; i++)
+        value = (value << 8) | data[i];
+    return value;
+}
+
+/// @brief Decodes a signed PCM sample of the given byte count.
+///
+/// The sample is sign extended so a 24-bit sample of 0xFFFFFF becomes -1.
+/// 8-bit PCM is unsigned in WAVE files, so it is returned as-is (0 - 255).
+/// The byte order is a template argument so a loop over a block of samples
+/// decodes, and for big endian data swaps, each sample in a single step.
+template <Endianness Order = Endianness::Little>
+inline std::int32_t DecodeSample(const std::uint8_t* data, int size)
+{
+    std::uint32_t value = Order == Endianness::Big 
+        ? DecodeBigEndian(data, size) 
+        : DecodeLittleEndian(data, size);
+    if (size == 1)
+        return static_cast<std::int32_t>(value);
+
+    int unusedBits = 32 - size * 8;
+    return static_cast<std::int32_t>(value << unusedBits) >> unusedBits;
+}
+
+/// @brief Encodes an integer as little endian into the given byte count.
+///
+/// Only the least significant size bytes of the value are encoded, so the
+/// value is truncated the same way a field of that size would truncate it.
+inline void EncodeLittleEndian(std::int64_t value, std::uint8_t* data, int size)
+{
+    for (int i = 0; i < size; i++)
+        data[i] = static_cast<std::uint8_t>((value >> (i * 8)) & 0xFF);
+}
+
+/// @brief Encodes an integer as big endian into the given byte count, 
+/// truncating it the same way as EncodeLittleEndian.
+inline void EncodeBigEndian(std::int64_t value, std::uint8_t* data, int size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        int shift = (size - 1 - i) * 8;
+        data[i] = static_cast<std::uint8_t>((value >> shift) & 0xFF);
+    }
+}
+
+#endif
@@ -0,0 +1,61 @@
+// ByteSource.h - Declares the ByteSource interface.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BYTE_SOURCE_H
+#define BYTE_SOURCE_H
+
+#include <cstdint>
+#include <cstddef>
+
+/// @brief Describes a run of bytes in a file.
+struct ByteRange
+{
+    std::uint64_t offset = 0;
+    std::uint64_t size = 0;
+};
+
+/// @brief Supplies the bytes of a media file to the code that analyzes it.
+///
+/// Media files read their samples through this interface rather than from a
+/// particular kind of stream, so the same analysis can run over a buffered
+/// file, a prefetched range, or any other way of getting at the bytes.
+/// Positions are always offsets from the start of the file.
+class ByteSource
+{
+public:
+    virtual ~ByteSource() = default;
+
+    /// @brief Reads up to size bytes into data.
+    /// @return The number of bytes read, which is only less than size at the
+    /// end of the source or on a read error.
+    virtual size_t Read(void* data, size_t size) = 0;
+
+    /// @brief Moves the read position to the given offset from the start.
+    /// @return False if the source can't seek to that position.
+    virtual bool Seek(std::uint64_t position) = 0;
+
+    /// @brief The offset from the start of the file of the next byte read.
+    virtual std::uint64_t Position() const = 0;
+
+    /// @brief The size of the file in bytes, or 0 if it isn't known.
+    virtual std::uint64_t Size() const = 0;
+
+    /// @brief Whether a short read was caused by an error rather than by
+    /// reaching the end of the source.
+    virtual bool HasFailed() const { return false; }
+};
+
+#endif
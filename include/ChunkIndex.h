@@ -0,0 +1,43 @@
+// ChunkIndex.h - Declares the ChunkIndexEntry struct and ChunkIndex type.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CHUNK_INDEX_H
+#define CHUNK_INDEX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/// @brief Locates a chunk in a media file without holding its contents.
+struct ChunkIndexEntry
+{
+    /// @brief The four character chunk ID, such as 'LIST' or 'bext'.
+    std::string id;
+
+    /// @brief The offset of the chunk data, just past the chunk header.
+    std::uint64_t offset = 0;
+
+    /// @brief The size of the chunk data as recorded in the chunk header.
+    std::uint32_t size = 0;
+
+    /// @brief The size of the chunk data including the pad byte that keeps
+    /// the next chunk on an even offset.
+    std::uint64_t PaddedSize() const { return size + (size & 1); }
+};
+
+using ChunkIndex = std::vector<ChunkIndexEntry>;
+
+#endif
@@ -0,0 +1,76 @@
+// DescriptorSource.h - Declares the DescriptorSource class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DESCRIPTOR_SOURCE_H
+#define DESCRIPTOR_SOURCE_H
+
+#include <cstdint>
+#include <cstddef>
+#include "ByteSource.h"
+#include "FileDescriptor.h"
+
+/// @brief Reads a media file through a descriptor someone else opened.
+///
+/// The source doesn't own the descriptor, so whoever opened it must keep it
+/// open for as long as the source is in use, and closes it afterwards. Each
+/// read says where it is from rather than moving the descriptor's file
+/// position, so on POSIX systems sources on the same descriptor can be read
+/// from different threads at once. There is no buffer: Analyze reads in
+/// large blocks, and the few small reads of a header aren't worth copying
+/// through one.
+class DescriptorSource : public ByteSource
+{
+public:
+    DescriptorSource(int descriptor) : 
+        descriptor{ descriptor }, 
+        size{ DescriptorSize(descriptor) }, 
+        position{ 0 } 
+    { }
+
+    size_t Read(void* data, size_t size) override
+    {
+        std::uint8_t* destination = static_cast<std::uint8_t*>(data);
+        size_t bytesRead{ 0 };
+        while (bytesRead < size)
+        {
+            long long result = ReadDescriptorAt(
+                descriptor, destination + bytesRead, size - bytesRead, 
+                position);
+            if (result <= 0)
+                break;
+
+            bytesRead += result;
+            position += result;
+        }
+        return bytesRead;
+    }
+
+    bool Seek(std::uint64_t position) override
+    {
+        this->position = position;
+        return true;
+    }
+
+    std::uint64_t Position() const override { return position; }
+
+    std::uint64_t Size() const override { return size; }
+private:
+    int descriptor;
+    std::uint64_t size;
+    std::uint64_t position;
+};
+
+#endif
@@ -0,0 +1,114 @@
+// DistinctValueAnalyzer.h - Declares the DistinctValueAnalyzer class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DISTINCT_VALUE_ANALYZER_H
+#define DISTINCT_VALUE_ANALYZER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "SampleAnalyzer.h"
+
+/// @brief The outcome of a DistinctValueAnalyzer.
+struct DistinctValueResult
+{
+    /// @brief The most distinct values a 16-bit source can have, however it
+    /// was scaled on the way to a higher bit depth.
+    static constexpr std::uint64_t SourceValues{ 65536 };
+
+    /// @brief Whether the samples were analyzed, which is only done for
+    /// sample sizes from 17 to 24 bits.
+    bool analyzed = false;
+
+    std::uint64_t sampleCount = 0;
+
+    /// @brief The number of different sample values across all channels.
+    std::uint64_t distinctValues = 0;
+
+    /// @brief The greatest common divisor of the differences between the
+    /// samples, which is the spacing of the lattice they lie on: 1 for a
+    /// natural recording, 256 for a padded 16-bit source, or 0 if every
+    /// sample had the same value.
+    std::uint32_t quantizationStep = 0;
+
+    /// @brief The lowest and highest sample values.
+    std::int32_t minimum = 0;
+    std::int32_t maximum = 0;
+
+    /// @brief Whether the samples are likely a 16-bit source that was
+    /// scaled up, with or without gain: no more values than 16 bits allow,
+    /// each used many times over, that either lie on a coarse lattice or
+    /// leave most of the levels in their range unused.
+    bool IsLikelyScaledUpscale() const;
+};
+
+/// @brief Counts the distinct sample values and their quantization step in
+/// one pass over samples of up to 24 bits.
+///
+/// Gain applied after padding a 16-bit source leaves non-zero low bytes, so
+/// it passes the zero low byte test, but the samples still take at most
+/// 65536 values. Those are marked in a bitmap with a bit for every 24-bit
+/// value, which at 2 MB mostly stays in the cache because neighbouring
+/// samples mark neighbouring bits. The quantization step is kept as a
+/// running GCD of each sample's difference from the first, which stops
+/// being updated once it reaches 1.
+///
+/// Analyzers that each took part of the samples, such as on separate
+/// threads or parts of a file, are combined with Merge, which ORs their
+/// bitmaps.
+class DistinctValueAnalyzer : public SampleAnalyzer
+{
+public:
+    DistinctValueAnalyzer() = default;
+
+    /// @brief Clears the statistics, allocating the bitmap if samples of
+    /// bitsPerSample bits can be analyzed and releasing it otherwise.
+    void Reset(int bitsPerSample);
+
+    bool IsEnabled() const { return !bitmap.empty(); }
+
+    /// @brief Adds count samples, stride samples apart, from any channel.
+    void Add(const std::int32_t* samples, size_t count, size_t stride = 1);
+
+    /// @brief Adds the samples another analyzer took.
+    void Merge(const DistinctValueAnalyzer& other);
+
+    void Begin(const SampleFormat& format) override;
+
+    void Process(const SampleBlock& block) override;
+
+    bool CanAppend() const override { return true; }
+
+    /// @brief Merges the next part's analyzer, as the order of the samples
+    /// doesn't matter.
+    void Append(const SampleAnalyzer& next) override
+    {
+        Merge(static_cast<const DistinctValueAnalyzer&>(next));
+    }
+
+    DistinctValueResult Result() const;
+private:
+    static constexpr int MaxBitsPerSample{ 24 };
+    static constexpr std::uint32_t ValueMask{ (1u << MaxBitsPerSample) - 1 };
+    static constexpr size_t BitmapWords{ (1u << MaxBitsPerSample) / 64 };
+
+    std::vector<std::uint64_t> bitmap;
+    std::uint64_t sampleCount = 0;
+    std::int32_t origin = 0;
+    std::uint32_t step = 0;
+};
+
+#endif
@@ -0,0 +1,60 @@
+// EffectiveBitsAnalyzer.h - Declares the EffectiveBitsAnalyzer class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef EFFECTIVE_BITS_ANALYZER_H
+#define EFFECTIVE_BITS_ANALYZER_H
+
+#include <cstdint>
+#include "SampleAnalyzer.h"
+
+/// @brief Finds how many bits of each sample are used, from the low bits
+/// that are zero in every sample: 16 for a 16-bit source padded to 24.
+///
+/// The samples are ORed together, so a low bit is only clear at the end if
+/// it was clear in all of them. Once the lowest bit is set no sample can
+/// lower the count, so the analyzer is done.
+class EffectiveBitsAnalyzer : public SampleAnalyzer
+{
+public:
+    EffectiveBitsAnalyzer() = default;
+
+    void Begin(const SampleFormat& format) override;
+
+    void Process(const SampleBlock& block) override;
+
+    bool IsDone() const override { return (usedBits & 1) != 0; }
+
+    bool CanAppend() const override { return true; }
+
+    void Append(const SampleAnalyzer& next) override;
+
+    int BitsPerSample() const { return bitsPerSample; }
+
+    /// @brief The sample size less the low bits that were zero in every
+    /// sample, or 0 if every sample was zero.
+    int EffectiveBits() const;
+private:
+    int bitsPerSample = 0;
+
+    /// @brief Every sample so far ORed together.
+    std::uint32_t usedBits = 0;
+
+    /// @brief The number of low bits clear in usedBits, or 32 if none is
+    /// set.
+    int ZeroLowBits() const;
+};
+
+#endif
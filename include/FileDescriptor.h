@@ -0,0 +1,191 @@
+// FileDescriptor.h - Declares portable wrappers around OS file descriptors.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FILE_DESCRIPTOR_H
+#define FILE_DESCRIPTOR_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// The POSIX and Windows CRT descriptor APIs only differ in their names and
+// flags, so these wrappers let FileReader and FileWriter share one code path.
+
+#ifdef _WIN32
+constexpr int ReadOnlyFlags{ _O_RDONLY | _O_BINARY };
+constexpr int WriteOnlyFlags{ _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY };
+constexpr int AppendFlags{ _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY };
+#else
+constexpr int ReadOnlyFlags{ O_RDONLY };
+constexpr int WriteOnlyFlags{ O_WRONLY | O_CREAT | O_TRUNC };
+constexpr int AppendFlags{ O_WRONLY | O_CREAT | O_APPEND };
+#endif
+
+/// @brief The descriptor of standard input, which is the same everywhere.
+constexpr int StandardInputDescriptor{ 0 };
+
+inline int OpenDescriptor(const std::string& fileName, int flags)
+{
+#ifdef _WIN32
+    return _open(fileName.c_str(), flags, _S_IREAD | _S_IWRITE);
+#else
+    return open(fileName.c_str(), flags, 0644);
+#endif
+}
+
+inline void CloseDescriptor(int descriptor)
+{
+#ifdef _WIN32
+    _close(descriptor);
+#else
+    close(descriptor);
+#endif
+}
+
+/// @brief Reads up to size bytes, retrying if a signal interrupts the read.
+/// @return The number of bytes read, 0 at the end of the file, or -1.
+inline long long ReadDescriptor(int descriptor, void* data, size_t size)
+{
+#ifdef _WIN32
+    return _read(descriptor, data, static_cast<unsigned int>(size));
+#else
+    ssize_t result;
+    do
+    {
+        result = read(descriptor, data, size);
+    } while (result < 0 && errno == EINTR);
+    return result;
+#endif
+}
+
+/// @brief Reads up to size bytes from offset, leaving the descriptor's file
+/// position alone where the platform allows, so others sharing the
+/// descriptor aren't disturbed.
+/// @return The number of bytes read, 0 at the end of the file, or -1.
+inline long long ReadDescriptorAt(
+    int descriptor, 
+    void* data, 
+    size_t size, 
+    std::uint64_t offset)
+{
+#ifdef _WIN32
+    if (_lseeki64(descriptor, offset, SEEK_SET) < 0)
+        return -1;
+    return _read(descriptor, data, static_cast<unsigned int>(size));
+#else
+    ssize_t result;
+    do
+    {
+        result = pread(descriptor, data, size, static_cast<off_t>(offset));
+    } while (result < 0 && errno == EINTR);
+    return result;
+#endif
+}
+
+/// @brief Writes all size bytes, continuing after partial writes.
+/// @return True if every byte was written.
+inline bool WriteDescriptor(int descriptor, const void* data, size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0)
+    {
+#ifdef _WIN32
+        int result = _write(descriptor, bytes, static_cast<unsigned int>(size));
+#else
+        ssize_t result = write(descriptor, bytes, size);
+        if (result < 0 && errno == EINTR)
+            continue;
+#endif
+        if (result <= 0)
+            return false;
+
+        bytes += result;
+        size -= result;
+    }
+    return true;
+}
+
+/// @brief Waits for what has been written to reach the disk, so it
+/// survives a crash or power loss.
+/// @return True if the data is on disk.
+inline bool SyncDescriptor(int descriptor)
+{
+#if defined(_WIN32)
+    return _commit(descriptor) == 0;
+#elif defined(__APPLE__)
+    return fsync(descriptor) == 0;
+#else
+    // Only the data and the size are needed to read the file back, so the
+    // other metadata isn't waited for.
+    return fdatasync(descriptor) == 0;
+#endif
+}
+
+inline bool SeekDescriptor(int descriptor, std::uint64_t position)
+{
+#ifdef _WIN32
+    return _lseeki64(descriptor, position, SEEK_SET) >= 0;
+#else
+    return lseek(descriptor, static_cast<off_t>(position), SEEK_SET) >= 0;
+#endif
+}
+
+/// @brief Whether the descriptor is for something that can be seeked, such
+/// as a file, rather than a pipe or socket.
+inline bool IsSeekable(int descriptor)
+{
+#ifdef _WIN32
+    return _telli64(descriptor) >= 0;
+#else
+    return lseek(descriptor, 0, SEEK_CUR) >= 0;
+#endif
+}
+
+/// @brief The offset of the descriptor's file position from the start.
+inline std::uint64_t DescriptorPosition(int descriptor)
+{
+#ifdef _WIN32
+    long long position = _telli64(descriptor);
+#else
+    off_t position = lseek(descriptor, 0, SEEK_CUR);
+#endif
+    return position < 0 ? 0 : static_cast<std::uint64_t>(position);
+}
+
+inline std::uint64_t DescriptorSize(int descriptor)
+{
+#ifdef _WIN32
+    struct _stat64 info;
+    if (_fstat64(descriptor, &info) != 0)
+        return 0;
+#else
+    struct stat info;
+    if (fstat(descriptor, &info) != 0)
+        return 0;
+#endif
+    return static_cast<std::uint64_t>(info.st_size);
+}
+
+#endif
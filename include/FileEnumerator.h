@@ -0,0 +1,46 @@
+// FileEnumerator.h - Declares the media file enumeration functions.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FILE_ENUMERATOR_H
+#define FILE_ENUMERATOR_H
+
+#include <string>
+#include <functional>
+#include <system_error>
+
+/// @brief Called with a folder the walk couldn't finish and the reason.
+using EnumerationErrorHandler = 
+    std::function<void(const std::string&, const std::error_code&)>;
+
+/// @brief Finds the supported media files at path.
+///
+/// If path is a file it is passed to found as-is. If it is a directory,
+/// found is called with each supported media file beneath it as the walk
+/// discovers them, so callers can start work before the walk finishes.
+/// Directories the user isn't allowed to read are skipped quietly. Any other
+/// error reading a directory, such as a network share dropping out or a
+/// folder deleted part way through the walk, skips the rest of that
+/// directory and is passed to failed, if given, before the walk moves on.
+///
+/// If stop is given it is checked before each entry, and the walk ends
+/// once it returns true.
+void EnumerateMediaFiles(
+    const std::string& path, 
+    const std::function<void(const std::string&)>& found,
+    const std::function<bool()>& stop = nullptr,
+    const EnumerationErrorHandler& failed = nullptr);
+
+#endif
@@ -0,0 +1,42 @@
+// FileListView.h - Declares the FileListView class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FILE_LIST_VIEW_H
+#define FILE_LIST_VIEW_H
+
+#include <wx/wx.h>
+#include <wx/listctrl.h>
+#include "FileTable.h"
+
+/// @brief A virtual list of the files in a FileTable's view.
+///
+/// The list holds no items of its own; it asks the table for the text of
+/// each row as it is drawn, so only the rows on screen cost anything and
+/// showing a new view is a matter of setting the item count.
+class FileListView : public wxListView
+{
+public:
+    FileListView(wxWindow* parent, const FileTable& table, wxSize size);
+
+    /// @brief Shows the table's current view.
+    void RefreshView();
+protected:
+    wxString OnGetItemText(long item, long column) const override;
+private:
+    const FileTable& table;
+};
+
+#endif
@@ -0,0 +1,109 @@
+// FileReader.h - Declares the FileReader class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FILE_READER_H
+#define FILE_READER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "ByteSource.h"
+#include "PageCache.h"
+
+/// @brief Reads a file through a large buffer and supports seeking.
+///
+/// Binary::RawFileStream reads one field at a time and can only move
+/// forward, so skipping a chunk means reading it. FileReader works on the
+/// file descriptor directly so media files can seek past chunks they don't
+/// need and read sample data in large blocks.
+///
+/// The buffer fills a little at a time after opening or seeking and grows
+/// as reading continues in order, so parsing a header only reads a few KB
+/// while streaming sample data still reads in large blocks.
+///
+/// With the streaming cache policy, data is dropped from the page cache
+/// behind the read position and the whole file is dropped on close.
+class FileReader : public ByteSource
+{
+public:
+    static constexpr size_t DefaultBufferSize{ 1024 * 1024 };
+
+    FileReader(std::string fileName, size_t bufferSize = DefaultBufferSize);
+
+    ~FileReader();
+
+    FileReader(const FileReader&) = delete;
+
+    FileReader& operator=(const FileReader&) = delete;
+
+    std::string FileName() const { return fileName; }
+
+    bool IsOpen() const { return descriptor >= 0; }
+
+    /// @brief The OS file descriptor, or -1 if the file is not open.
+    int Descriptor() const { return descriptor; }
+
+    /// @brief Sets how reads treat the page cache. Takes effect from the
+    /// next read if the file is already open.
+    void SetCachePolicy(CachePolicy policy);
+
+    void Open();
+
+    void Close();
+
+    /// @brief Reads up to size bytes into data.
+    /// @return The number of bytes read, which is only less than size at the
+    /// end of the file or on a read error.
+    size_t Read(void* data, size_t size) override;
+
+    /// @brief Moves the read position to the given offset from the start.
+    bool Seek(std::uint64_t position) override;
+
+    /// @brief Moves the read position forward by count bytes.
+    bool Skip(std::uint64_t count) { return Seek(Position() + count); }
+
+    /// @brief The offset from the start of the file of the next byte read.
+    std::uint64_t Position() const override
+    { 
+        return bufferStart + bufferPosition; 
+    }
+
+    /// @brief The size of the file in bytes.
+    std::uint64_t Size() const override;
+private:
+    static constexpr size_t InitialReadSize{ 4096 };
+
+    /// @brief How far reading gets ahead of the last drop from the cache
+    /// before the data behind it is dropped.
+    static constexpr std::uint64_t DropInterval{ 4 * 1024 * 1024 };
+
+    std::string fileName;
+    int descriptor;
+    std::vector<std::uint8_t> buffer;
+    std::uint64_t bufferStart;
+    size_t bufferPosition;
+    size_t bufferLength;
+    size_t readSize;
+    CachePolicy cachePolicy;
+    std::uint64_t droppedUpTo;
+
+    size_t FillBuffer();
+
+    void DropBehind();
+};
+
+#endif
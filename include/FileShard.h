@@ -0,0 +1,62 @@
+// FileShard.h - Declares the FileShard class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef FILE_SHARD_H
+#define FILE_SHARD_H
+
+#include <string>
+#include <unordered_set>
+#include <cstdint>
+#include <cstddef>
+
+/// @brief The files under a folder that one of several processes handles,
+/// so a batch can be spread across machines without dividing the file list
+/// by hand.
+///
+/// Every process walks the whole folder and divides it the same way: the
+/// files are taken largest first and each is given to the shard with the
+/// fewest bytes so far, so the shards end up with close to the same amount
+/// to read however the sizes are spread. Ties are broken by the file's path
+/// relative to the folder, so processes that mount the folder in different
+/// places still agree. Adding or removing files can move others to a
+/// different shard, so every process should see the same files.
+class FileShard
+{
+public:
+    /// @brief The bytes each file counts for on top of its size when the
+    /// shards are balanced, for the cost of opening it and reading its
+    /// header, so a shard isn't given every one of a run of tiny files.
+    static constexpr std::uint64_t FileCost{ 64 * 1024 };
+
+    /// @brief Divides the supported files under path into count shards and
+    /// keeps those of the shard at index, counting from 0.
+    FileShard(const std::string& path, unsigned int index, unsigned int count);
+
+    /// @brief Whether the file, as the walk of the folder names it, is in
+    /// this shard.
+    bool Contains(const std::string& fileName) const;
+
+    size_t FileCount() const { return files.size(); }
+
+    /// @brief The combined size of the shard's files, in bytes.
+    std::uint64_t Size() const { return size; }
+private:
+    std::unordered_set<std::string> files;
+    std::uint64_t size;
+};
+
+#endif
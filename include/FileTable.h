@@ -0,0 +1,192 @@
+// FileTable.h - Declares the FileTable class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FILE_TABLE_H
+#define FILE_TABLE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_set>
+#include <cstdint>
+#include <cstddef>
+#include "MediaFile.h"
+
+/// @brief What the analysis of a file concluded, in the order the verdict
+/// column sorts in.
+enum class FileVerdict : std::uint8_t
+{
+    Pending,
+    Natural,
+    Scaled,
+    Dithered,
+    Upscaled,
+    Failed
+};
+
+/// @brief The text the file list shows for a verdict.
+std::string VerdictText(FileVerdict verdict);
+
+/// @brief Classes a file from the results of its last Analyze.
+FileVerdict ClassifyFile(const MediaFile& file);
+
+/// @brief The files of a session and their results, kept compactly enough
+/// for a list of hundreds of thousands to stay responsive.
+///
+/// Every path is stored end to end in one string, so a row is a few fixed
+/// size fields rather than a set of strings and list items of its own.
+/// The list shows a view of the rows: the indices of those that pass the
+/// filter, in the sort order, which is rebuilt by UpdateView.
+///
+/// A path can only be added once; the rows are indexed by path, so finding
+/// a duplicate doesn't mean searching the table.
+class FileTable
+{
+public:
+    /// @brief Returned by Add for a path that is already in the table.
+    static constexpr size_t NoRow{ static_cast<size_t>(-1) };
+
+    enum class Column
+    {
+        FileName = 0,
+        BitDepth,
+        SampleRate,
+        Verdict
+    };
+
+    FileTable();
+
+    FileTable(const FileTable&) = delete;
+
+    FileTable& operator=(const FileTable&) = delete;
+
+    /// @brief Adds a file with no results yet, unless the path is already
+    /// in the table.
+    /// @return The index of its row, or NoRow if the path was a duplicate.
+    size_t Add(const std::string& path);
+
+    void Clear();
+
+    size_t RowCount() const { return rows.size(); }
+
+    std::string Path(size_t row) const;
+
+    /// @brief The last component of the row's path.
+    std::string_view FileName(size_t row) const;
+
+    int BitsPerSample(size_t row) const { return rows[row].bitsPerSample; }
+
+    long SampleRate(size_t row) const { return rows[row].sampleRate; }
+
+    FileVerdict Verdict(size_t row) const { return rows[row].verdict; }
+
+    void SetFormat(size_t row, int bitsPerSample, long sampleRate);
+
+    void SetVerdict(size_t row, FileVerdict verdict);
+
+    /// @brief The text of a cell, which is blank for a format not yet read.
+    std::string CellText(size_t row, Column column) const;
+
+    /// @brief Shows only rows whose file name contains text, ignoring case,
+    /// and, if upscaledOnly, whose verdict is some kind of upscale. Takes
+    /// effect at the next UpdateView.
+    void SetFilter(const std::string& text, bool upscaledOnly);
+
+    /// @brief Sorts the view by the column. Takes effect at the next
+    /// UpdateView.
+    void SetSort(Column column, bool ascending);
+
+    Column SortColumn() const { return sortColumn; }
+
+    bool IsSortAscending() const { return sortAscending; }
+
+    /// @brief Whether new results can change which rows the view shows or
+    /// their order, rather than only the text of the rows.
+    bool ViewDependsOnResults() const
+    {
+        return upscaledOnly || sortColumn != Column::FileName;
+    }
+
+    /// @brief Rebuilds the view from the rows, filter and sort order.
+    void UpdateView();
+
+    /// @brief Adds the rows from firstRow on to the view, if they pass the
+    /// filter, without sorting the rows already in it again. Rows are
+    /// added at the end of the table, so this keeps the view up to date as
+    /// files are added.
+    void ExtendView(size_t firstRow);
+
+    size_t ViewCount() const { return view.size(); }
+
+    /// @brief The row shown at a position in the view.
+    size_t RowAt(size_t position) const { return view[position]; }
+private:
+    struct Row
+    {
+        std::uint64_t pathOffset = 0;
+        std::uint32_t pathLength = 0;
+
+        /// @brief The length of the file name at the end of the path.
+        std::uint32_t nameLength = 0;
+
+        std::uint32_t sampleRate = 0;
+        std::uint8_t bitsPerSample = 0;
+        FileVerdict verdict = FileVerdict::Pending;
+    };
+
+    /// @brief Hashes the path of a row, for the index.
+    struct PathHash
+    {
+        const FileTable* table;
+
+        size_t operator()(std::uint32_t row) const;
+    };
+
+    /// @brief Compares the paths of two rows, for the index.
+    struct PathEqual
+    {
+        const FileTable* table;
+
+        bool operator()(std::uint32_t a, std::uint32_t b) const;
+    };
+
+    std::string paths;
+    std::vector<Row> rows;
+
+    /// @brief The rows, keyed by their paths.
+    std::unordered_set<std::uint32_t, PathHash, PathEqual> index;
+    std::vector<std::uint32_t> view;
+    std::string filterText;
+    bool upscaledOnly = false;
+    Column sortColumn = Column::FileName;
+    bool sortAscending = true;
+
+    std::string_view PathView(size_t row) const;
+
+    bool PassesFilter(size_t row) const;
+
+    /// @brief Whether row a belongs before row b in the view, in the sort
+    /// order and direction.
+    bool SortsBefore(std::uint32_t a, std::uint32_t b) const
+    {
+        return sortAscending ? Precedes(a, b) : Precedes(b, a);
+    }
+
+    /// @brief Whether row a sorts before row b in the sort column.
+    bool Precedes(size_t a, size_t b) const;
+};
+
+#endif
@@ -0,0 +1,100 @@
+// FileWriter.h - Declares the FileWriter class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FILE_WRITER_H
+#define FILE_WRITER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "FileReader.h"
+#include "PageCache.h"
+
+/// @brief Writes a file through a large buffer.
+///
+/// The counterpart of FileReader. Besides buffered writes, it can copy a
+/// range of another file straight into the output so callers never need to
+/// hold that range in memory. On Linux those copies happen in the kernel
+/// with copy_file_range or sendfile, falling back to a buffered copy.
+///
+/// With the streaming cache policy, written data is flushed to storage and
+/// dropped from the page cache as the file grows and again on close.
+class FileWriter
+{
+public:
+    static constexpr size_t DefaultBufferSize{ 1024 * 1024 };
+
+    FileWriter(std::string fileName, size_t bufferSize = DefaultBufferSize);
+
+    ~FileWriter();
+
+    FileWriter(const FileWriter&) = delete;
+
+    FileWriter& operator=(const FileWriter&) = delete;
+
+    std::string FileName() const { return fileName; }
+
+    bool IsOpen() const { return descriptor >= 0; }
+
+    /// @brief Sets how writes treat the page cache. Must be called before
+    /// the file is opened.
+    void SetCachePolicy(CachePolicy policy) { cachePolicy = policy; }
+
+    /// @brief Creates the file, truncating it if it already exists.
+    void Open();
+
+    /// @brief Flushes any buffered data, waits for the file to reach the
+    /// disk and closes it, so a file that was closed survives a crash.
+    /// @return False if anything written since Open failed to reach the
+    /// file, in which case it is incomplete.
+    bool Close();
+
+    /// @brief Writes size bytes from data.
+    /// @return False if the data could not be written.
+    bool Write(const void* data, size_t size);
+
+    /// @brief Copies size bytes starting at offset in source to the output.
+    /// @return False if the range could not be read or written in full.
+    bool WriteFrom(FileReader& source, std::uint64_t offset,
+                   std::uint64_t size);
+
+    /// @brief Makes the output an exact copy of source.
+    ///
+    /// Must be called before anything else is written. Where the filesystem
+    /// supports reflinks the output shares the source's extents, so no data
+    /// is copied at all; otherwise the whole file goes through WriteFrom.
+    bool CloneFrom(FileReader& source);
+
+    /// @brief Writes any buffered data to the file.
+    bool Flush();
+private:
+    std::string fileName;
+    int descriptor;
+    std::vector<std::uint8_t> buffer;
+    size_t bufferLength;
+    CachePolicy cachePolicy;
+    std::uint64_t droppedUpTo;
+    bool hasFailed;
+
+    /// @brief How much is written after the last drop from the cache before
+    /// the data written since is flushed and dropped.
+    static constexpr std::uint64_t DropInterval{ 16 * 1024 * 1024 };
+
+    void DropWritten(bool isClosing);
+};
+
+#endif
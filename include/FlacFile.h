@@ -17,30 +17,32 @@
 #ifndef FLAC_FILE_H
 #define FLAC_FILE_H
 
-#include <stdio.h>
 #include <string>
 #include <filesystem>
 #include <memory>
 #include <sstream>
+#include <vector>
 #include "LibCppBinary.h"
 #include "LibCppLogging.h"
 #include "MediaFile.h"
 #include "SampleDumper.h"
 #include "FLAC++/decoder.h"
 #include "FlacFormat.h"
+#include "ByteSource.h"
+#include "FileReader.h"
 
-class FlacFile : public MediaFile, public FLAC::Decoder::File
+class FlacFile : public MediaFile, public FLAC::Decoder::Stream
 {
 public:
     FlacFile(std::string fileName, std::shared_ptr<Logging::Logger> logger) :
-        FLAC::Decoder::File(),
+        FLAC::Decoder::Stream(),
         fileName{ fileName }, 
-        isUpscaled{ false },
-        logger{ logger }
+        logger{ logger },
+        reader{ std::make_shared<FileReader>(fileName) },
+        input{ reader },
+        source{ reader }
         {}
 
-    ~FlacFile();
-
     std::string FileName() const override { return fileName; }
 
     int BitsPerSample() const override { return format.bitsPerSample; }
@@ -49,19 +51,103 @@ public:
 
     FlacFormat Format() const { return format; }
 
-    bool IsOpen() const override { return file != nullptr; }
+    /// @brief Whether the file is open, which a file read from a source
+    /// given to SetInput always is.
+    bool IsOpen() const override { return input != reader || reader->IsOpen(); }
+
+    bool Exists() const override 
+    { 
+        return input != reader || MediaFile::Exists(); 
+    }
 
     void Open() override;
 
     void Analyze(bool dumpSamples) override;
 
-    void Convert(
+    bool Convert(
         std::string outputFileName, 
         BitDepth depth, 
         ConversionMethod method) override;
 
-    bool IsUpscaled() const override { return isUpscaled; }
+    ByteRange AnalysisRange() const override
+    {
+        return ByteRange{ 0, input->Size() };
+    }
+
+    void SetAnalysisSource(std::shared_ptr<ByteSource> source) override
+    {
+        this->source = source != nullptr ? source : input;
+    }
+
+    void SetInput(std::shared_ptr<ByteSource> input) override
+    {
+        this->input = input != nullptr ? input : reader;
+        source = this->input;
+    }
+
+    /// @brief Analyzes part of the stream, found by seeking, which needs a
+    /// stream whose length is known. A stream being verified can't be
+    /// split, as its MD5 covers the whole of it.
+    bool SetAnalysisPart(
+        std::uint64_t firstSample, 
+        std::uint64_t sampleCount, 
+        std::uint64_t leadIn) override;
+
+    void SetCachePolicy(CachePolicy policy) override
+    {
+        reader->SetCachePolicy(policy);
+    }
+
+    /// @brief Sets whether Analyze tells the analyzers which low bits the
+    /// subframe headers prove zero, letting them skip those frames. Turning
+    /// it off checks every sample, to cross-check the two.
+    void SetUseWastedBits(bool useWastedBits) 
+    { 
+        this->useWastedBits = useWastedBits; 
+    }
+
+    /// @brief The wasted-bits counts for each channel from the last Analyze.
+    const std::vector<WastedBitsStats>& WastedBits() const 
+    { 
+        return wastedBits; 
+    }
+
+    /// @brief Sets whether Analyze also checks the stream's integrity: the
+    /// frame CRCs, which are always checked, and the MD5 of the decoded
+    /// audio, which libFLAC computes as it decodes.
+    void SetVerify(bool verify) { this->verify = verify; }
+
+    bool IsVerifying() const { return verify; }
+
+    /// @brief The outcome of the checks made by the last Analyze.
+    const FlacVerifyResult& VerifyResult() const { return verifyResult; }
+
+    std::uint64_t FrameCount() const { return frameCount; }
+
+    /// @brief The number of frames whose subframe headers alone proved
+    /// them upscaled in the last Analyze.
+    std::uint64_t FramesSettledByHeaders() const 
+    { 
+        return framesSettledByHeaders; 
+    }
 protected:
+    // The decoder pulls its input through these callbacks rather than from
+    // a FILE*, so it decodes whatever ByteSource the analysis is reading.
+    ::FLAC__StreamDecoderReadStatus read_callback(
+        FLAC__byte buffer[], 
+        size_t *bytes) override;
+
+    ::FLAC__StreamDecoderSeekStatus seek_callback(
+        FLAC__uint64 absolute_byte_offset) override;
+
+    ::FLAC__StreamDecoderTellStatus tell_callback(
+        FLAC__uint64 *absolute_byte_offset) override;
+
+    ::FLAC__StreamDecoderLengthStatus length_callback(
+        FLAC__uint64 *stream_length) override;
+
+    bool eof_callback() override;
+
     ::FLAC__StreamDecoderWriteStatus write_callback(
         const ::FLAC__Frame *frame, 
         const FLAC__int32 * const buffer[]) override;
@@ -71,12 +157,52 @@ protected:
 	void error_callback(::FLAC__StreamDecoderErrorStatus status) override;
 private:
     std::string fileName;
-    FILE* file;
-    bool isUpscaled;
     FlacFormat format;
     std::shared_ptr<Logging::Logger> logger;
+    std::shared_ptr<FileReader> reader;
+
+    /// @brief The file as a whole: the reader, or the source given to
+    /// SetInput.
+    std::shared_ptr<ByteSource> input;
+
+    std::shared_ptr<ByteSource> source;
     std::shared_ptr<SampleDumper> dumper;
     bool dumpSamples = false;
+    bool useWastedBits = true;
+    bool verify = false;
+    bool stoppedEarly = false;
+    FlacVerifyResult verifyResult;
+    std::vector<WastedBitsStats> wastedBits;
+    std::uint64_t frameCount = 0;
+    std::uint64_t framesSettledByHeaders = 0;
+
+    /// @brief The samples of the part set by SetAnalysisPart: the first one
+    /// decoded, the first one counted and the one after the last.
+    bool hasPart = false;
+    std::uint64_t leadInStart = 0;
+    std::uint64_t partStart = 0;
+    std::uint64_t partEnd = 0;
+
+    /// @brief The first sample of each channel of a frame that is inside
+    /// the part.
+    std::vector<const FLAC__int32*> partChannels;
+
+    /// @brief Moves the decoder to the start of the part's lead-in.
+    /// @return False if the stream couldn't be seeked.
+    bool SeekToPart();
+
+    /// @brief Primes the analyzers with the samples of a frame before the
+    /// part and passes them those inside it.
+    /// @return Whether to carry on decoding, which stops after the part.
+    bool AnalyzePartOf(const ::FLAC__Frame *frame, const SampleBlock& block);
+
+    void CountWastedBits(const ::FLAC__Frame *frame);
+
+    /// @brief The number of low bits the subframe headers prove zero in
+    /// every decoded sample of the frame.
+    int ZeroLowBits(const ::FLAC__Frame *frame) const;
+
+    void ProcessSamples(const FLAC__int32 * const buffer[]);
 
     template <typename T>
     void ProcessNext(FLAC__int32 sampleValue)
@@ -91,13 +217,6 @@ private:
 
             dumper->Dump(&sample);
         }
-
-        // Perform a bitwise and against the bitmask 0xFF to select the
-        // bits in the least significant byte. If even one is of the 
-        // least significant bytes is non-zero, the file is not likely
-        // to be an upscale conversion.
-        if ((sample.Value() & 0xFF) != 0)
-            isUpscaled = false;
     }
 };
 
@@ -17,6 +17,8 @@
 #ifndef FLAC_FORMAT_H
 #define FLAC_FORMAT_H
 
+#include <cstdint>
+#include <string>
 #include "FLAC++/decoder.h"
 
 struct FlacFormat
@@ -28,4 +30,72 @@ struct FlacFormat
     uint32_t blockSize = 0;
 };
 
-#endif
\ No newline at end of file
+/// @brief The outcome of verifying a FLAC stream while analyzing it.
+struct FlacVerifyResult
+{
+    /// @brief True if the stream had an MD5 signature of its audio to check.
+    bool hasMd5 = false;
+
+    bool md5Matches = false;
+
+    /// @brief Frames whose CRC didn't match their contents.
+    std::uint64_t crcErrors = 0;
+
+    /// @brief Other decode errors, such as lost sync or bad frame headers.
+    std::uint64_t otherErrors = 0;
+
+    /// @brief True if decoding reached the end of the stream.
+    bool decodedToEnd = false;
+
+    std::uint64_t samplesDecoded = 0;
+
+    std::uint64_t totalSamples = 0;
+
+    /// @brief A one word verdict: ok, md5_mismatch, crc_errors,
+    /// decode_errors, truncated, or no_md5 if the stream decoded cleanly but
+    /// had no signature to check it against.
+    const char* Verdict() const
+    {
+        if (crcErrors > 0)
+            return "crc_errors";
+        if (otherErrors > 0 || !decodedToEnd)
+            return "decode_errors";
+        if (totalSamples > 0 && samplesDecoded < totalSamples)
+            return "truncated";
+        if (!hasMd5)
+            return "no_md5";
+        return md5Matches ? "ok" : "md5_mismatch";
+    }
+
+    /// @brief True if nothing was found wrong. A missing signature only
+    /// means there was less to check, not that the stream is damaged.
+    bool IsIntact() const
+    {
+        std::string verdict = Verdict();
+        return verdict == "ok" || verdict == "no_md5";
+    }
+};
+
+/// @brief Wasted-bits counts from the subframe headers of one channel.
+///
+/// A subframe's wasted bits are the low bits that are zero in every sample
+/// it holds, which the encoder shifts out before coding. In stereo frames
+/// coded as a difference the second subframe holds the side channel rather
+/// than the right.
+struct WastedBitsStats
+{
+    std::uint64_t subframeCount = 0;
+    std::uint64_t totalWastedBits = 0;
+    std::uint32_t minimumWastedBits = 0;
+
+    /// @brief The number of subframes with at least a byte of wasted bits.
+    std::uint64_t byteWastedCount = 0;
+
+    double MeanWastedBits() const
+    {
+        return subframeCount > 0 
+            ? static_cast<double>(totalWastedBits) / subframeCount : 0.0;
+    }
+};
+
+#endif
@@ -0,0 +1,92 @@
+// ImportThread.h - Declares the ImportThread class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IMPORT_THREAD_H
+#define IMPORT_THREAD_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <filesystem>
+#include <wx/wx.h>
+#include "MediaProbe.h"
+#include "FileEnumerator.h"
+#include "AnalysisThread.h"
+#include "AnalysisControl.h"
+
+/// @brief A file found by an import, with its format if it could be read.
+struct ImportedFile
+{
+    std::string path;
+    int bitsPerSample = 0;
+    long sampleRate = 0;
+
+    /// @brief True if the file couldn't be opened or isn't supported.
+    bool failed = false;
+};
+
+/// @brief Finds the media files in a list of files and folders in the
+/// background, posting them to the window in batches with their formats.
+///
+/// Folders are walked recursively as the files in them are probed, so the
+/// list fills in while a large library is still being enumerated. Each file
+/// is only open while its header is read, so an import of any size never
+/// holds more than one descriptor.
+class ImportThread : public wxThread
+{
+public:
+    /// @brief The ID of the wxThreadEvent whose payload is a
+    /// std::vector<ImportedFile> and whose int is the session it was for.
+    static constexpr int ImportResultsID{ 10003 };
+
+    /// @brief The ID of the wxThreadEvent posted when the import ends,
+    /// whose int is the session it was for.
+    static constexpr int ImportCompleteID{ 10004 };
+
+    /// @brief The most files held back before they are posted. Larger than
+    /// an analysis batch, as probing is quick and each batch is merged into
+    /// the sorted view.
+    static constexpr size_t ImportBatchSize{ 4096 };
+
+    /// @param session Posted with every result, so the window can tell them
+    /// from those of a selection it has since replaced.
+    ImportThread(wxFrame* parent, 
+                 std::vector<std::string> roots,
+                 int session,
+                 std::shared_ptr<AnalysisControl> control)
+        : parent{ parent }, roots{ std::move(roots) }, session{ session },
+          control{ control } { }
+
+    ExitCode Entry() override;
+private:
+    using Clock = std::chrono::steady_clock;
+
+    wxFrame* parent;
+    std::vector<std::string> roots;
+    int session;
+    std::shared_ptr<AnalysisControl> control;
+    std::vector<ImportedFile> results;
+    Clock::time_point lastResults;
+
+    void Import(const std::string& path);
+
+    /// @brief Posts the files held back, if there are enough of them, they
+    /// have been held long enough, or force is set.
+    void PostResults(bool force);
+};
+
+#endif
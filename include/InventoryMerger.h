@@ -0,0 +1,62 @@
+// InventoryMerger.h - Declares the InventoryMerger class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INVENTORY_MERGER_H
+#define INVENTORY_MERGER_H
+
+#include <string>
+#include <map>
+#include <ostream>
+#include <cstddef>
+#include "InventoryWriter.h"
+
+/// @brief Combines the inventories the shards of a batch wrote into one
+/// report.
+///
+/// The rows are kept by path and written in path order, so the report is
+/// the same whatever order the shards finished in. A path found in more
+/// than one inventory, such as a file a resumed shard finished before the
+/// files moved between shards, is written once, from the first inventory
+/// added that has it.
+class InventoryMerger
+{
+public:
+    InventoryMerger(InventoryFormat format);
+
+    /// @brief Reads the rows of an inventory in the merger's format.
+    /// @return Why it couldn't be merged, or an empty string if it was.
+    std::string Add(const std::string& fileName);
+
+    /// @brief Writes the header, if the format has one, and every row.
+    void Write(std::ostream& output) const;
+
+    size_t RowCount() const { return rows.size(); }
+
+    /// @brief The rows passed over because their path was already merged.
+    size_t DuplicateCount() const { return duplicateCount; }
+private:
+    InventoryFormat format;
+    std::string header;
+    std::map<std::string, std::string> rows;
+    size_t duplicateCount;
+};
+
+/// @brief Whether the file's extension marks it as an inventory in the
+/// format: .csv for CSV, and .json, .jsonl or .ndjson for NDJSON.
+bool IsInventoryFile(const std::string& fileName, InventoryFormat format);
+
+#endif
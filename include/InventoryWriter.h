@@ -0,0 +1,89 @@
+// InventoryWriter.h - Declares the InventoryWriter class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INVENTORY_WRITER_H
+#define INVENTORY_WRITER_H
+
+#include <string>
+#include <ostream>
+#include <mutex>
+#include "MediaProbe.h"
+#include "BatchAnalyzer.h"
+
+/// @brief Represents the formats an inventory can be written in.
+enum InventoryFormat
+{
+    /// @brief Comma separated values with a header row.
+    Csv,
+
+    /// @brief One JSON object per line (newline delimited JSON).
+    Ndjson
+};
+
+/// @brief Writes probe results as rows of an inventory.
+///
+/// Write may be called from several threads at once; each row is written
+/// whole, in the order the calls are made.
+class InventoryWriter
+{
+public:
+    /// @param includesAnalysis Adds upscaled and integrity columns for batch
+    /// analysis.
+    InventoryWriter(
+        std::ostream& output, 
+        InventoryFormat format, 
+        bool includesAnalysis = false);
+
+    /// @brief Writes the header row, if the format has one.
+    void WriteHeader();
+
+    void Write(const ProbeResult& result);
+
+    /// @brief Writes a row with the result of analyzing the file. The
+    /// analysis columns are left empty if the file couldn't be analyzed.
+    void Write(const BatchResult& result);
+
+    /// @brief Formats the row Write would write for the result, without
+    /// the line break, so it can be kept and written later.
+    std::string Format(const BatchResult& result);
+
+    /// @brief Writes a row made by Format, such as one kept in a journal.
+    void WriteFormatted(const std::string& row);
+private:
+    std::ostream& output;
+    InventoryFormat format;
+    bool includesAnalysis;
+    std::mutex mutex;
+
+    void WriteRow(const ProbeResult& result, const BatchResult* analysis);
+
+    std::string FormatCsv(
+        const ProbeResult& result, 
+        const BatchResult* analysis);
+
+    std::string FormatNdjson(
+        const ProbeResult& result, 
+        const BatchResult* analysis);
+};
+
+/// @brief Quotes text as a JSON string, escaping what JSON requires.
+std::string QuoteJson(const std::string& text);
+
+/// @brief Chooses the inventory format from the output file's extension,
+/// using NDJSON for .json, .jsonl and .ndjson files and CSV otherwise.
+InventoryFormat GetInventoryFormat(std::string fileName);
+
+#endif
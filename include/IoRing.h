@@ -0,0 +1,80 @@
+// IoRing.h - Declares the IoRing class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IO_RING_H
+#define IO_RING_H
+
+#include <cstdint>
+#include <cstddef>
+
+/// @brief Submits reads to the Linux io_uring interface.
+///
+/// This talks to the kernel through the raw system calls rather than
+/// liburing so the project doesn't gain another dependency. It only
+/// supports what the batch analyzer needs: queueing reads at an offset and
+/// waiting for them to complete. When the project is built without io_uring
+/// support, or the kernel refuses to create a ring, IsAvailable is false
+/// and callers are expected to read with ordinary blocking calls instead.
+///
+/// An IoRing is meant to be used from a single thread.
+class IoRing
+{
+public:
+    IoRing(unsigned int entries);
+
+    ~IoRing();
+
+    IoRing(const IoRing&) = delete;
+
+    IoRing& operator=(const IoRing&) = delete;
+
+    bool IsAvailable() const { return ringDescriptor >= 0; }
+
+    /// @brief Queues a read of size bytes at offset into data.
+    /// @param tag Identifies the read when it completes.
+    /// @return False if the submission queue is full.
+    bool PrepareRead(int descriptor, void* data, unsigned int size,
+                     std::uint64_t offset, std::uint64_t tag);
+
+    /// @brief Hands the queued reads to the kernel.
+    /// @return False if the kernel rejected the submission.
+    bool Submit();
+
+    /// @brief Waits for a read to complete.
+    /// @param tag Set to the tag the read was queued with.
+    /// @param result Set to the number of bytes read or a negative errno.
+    /// @return False if waiting failed.
+    bool WaitCompletion(std::uint64_t& tag, int& result);
+private:
+    int ringDescriptor;
+    unsigned int pendingSubmissions;
+    void* submissionRing;
+    size_t submissionRingSize;
+    void* completionRing;
+    size_t completionRingSize;
+    void* submissionEntries;
+    size_t submissionEntriesSize;
+    unsigned int* submissionHead;
+    unsigned int* submissionTail;
+    unsigned int submissionMask;
+    unsigned int* submissionArray;
+    unsigned int* completionHead;
+    unsigned int* completionTail;
+    unsigned int completionMask;
+    void* completionEntries;
+};
+
+#endif
@@ -0,0 +1,166 @@
+// LevelAnalyzer.h - Declares the LevelAnalyzer class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LEVEL_ANALYZER_H
+#define LEVEL_ANALYZER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "SampleAnalyzer.h"
+
+/// @brief The signal levels of one channel, relative to full scale.
+struct LevelChannelStats
+{
+    std::uint64_t sampleCount = 0;
+
+    /// @brief The lowest and highest sample values.
+    std::int32_t minimum = 0;
+    std::int32_t maximum = 0;
+
+    /// @brief The largest sample magnitude, from 0 to 1.
+    double peak = 0;
+
+    /// @brief The root mean square of the samples, from 0 to 1.
+    double rms = 0;
+
+    /// @brief The mean of the samples, from -1 to 1.
+    double dcOffset = 0;
+
+    /// @brief The number of samples at the lowest or highest value the
+    /// sample size can hold.
+    std::uint64_t clippedSamples = 0;
+
+    /// @brief The number of runs of at least LevelAnalyzer::MinClipRun
+    /// consecutive samples at full scale, each of which is a likely clip.
+    std::uint64_t clippedRuns = 0;
+
+    double PeakDbfs() const { return ToDecibels(peak); }
+
+    double RmsDbfs() const { return ToDecibels(rms); }
+
+    /// @brief Converts a level relative to full scale to decibels, which is
+    /// negative infinity for silence.
+    static double ToDecibels(double level);
+};
+
+/// @brief The outcome of a LevelAnalyzer.
+struct LevelResult
+{
+    std::vector<LevelChannelStats> channels;
+};
+
+/// @brief Measures the peak, RMS, DC offset and clipping of each channel in
+/// one pass over the samples.
+///
+/// The scan is one loop over an array that keeps the minimum, maximum, sum
+/// and sum of squares in separate lanes, which the compiler turns into
+/// vector instructions. Interleaved blocks of 1, 2, 4 or 8 channels are
+/// scanned in place with the lanes split between the channels; other
+/// channel counts are copied out a channel at a time first. Clipping is
+/// only searched for, one sample at a time, in the blocks whose minimum or
+/// maximum reached full scale.
+class LevelAnalyzer : public SampleAnalyzer
+{
+public:
+    /// @brief The shortest run of full scale samples counted as a clip.
+    static constexpr int MinClipRun{ 3 };
+
+    LevelAnalyzer() = default;
+
+    /// @brief Clears the statistics and sizes them for the channel count
+    /// and for signed samples of bitsPerSample bits.
+    void Reset(int channelCount, int bitsPerSample);
+
+    int ChannelCount() const { return static_cast<int>(accumulators.size()); }
+
+    /// @brief Adds count consecutive samples of one channel.
+    void Add(int channel, const std::int32_t* samples, size_t count);
+
+    /// @brief Adds a block of interleaved samples that starts with the
+    /// first channel.
+    void AddInterleaved(const std::int32_t* samples, size_t count);
+
+    void Begin(const SampleFormat& format) override;
+
+    void Process(const SampleBlock& block) override;
+
+    bool CanAppend() const override { return true; }
+
+    /// @brief Takes the run of full scale samples each channel ends with,
+    /// which a clip at the start of the part continues.
+    void Prime(const SampleBlock& block) override;
+
+    void Append(const SampleAnalyzer& next) override;
+
+    LevelResult Result() const;
+private:
+    /// @brief The number of independent accumulators a scan keeps, enough
+    /// to fill a vector register of each type.
+    static constexpr int ScanLanes{ 8 };
+
+    /// @brief The minimum, maximum, sum and sum of squares of a run of
+    /// samples.
+    struct ScanTotals
+    {
+        std::int32_t minimum = INT32_MAX;
+        std::int32_t maximum = INT32_MIN;
+        std::int64_t sum = 0;
+        double sumOfSquares = 0;
+
+        void Merge(const ScanTotals& other);
+    };
+
+    struct ChannelAccumulator
+    {
+        std::uint64_t sampleCount = 0;
+        std::int32_t minimum = 0;
+        std::int32_t maximum = 0;
+        std::int64_t sum = 0;
+        double sumOfSquares = 0;
+        std::uint64_t clippedSamples = 0;
+        std::uint64_t clippedRuns = 0;
+
+        /// @brief The length of the run of full scale samples that the
+        /// last block ended with, which the next block may continue.
+        std::uint64_t currentRun = 0;
+    };
+
+    int bitsPerSample = 0;
+    std::int32_t clipLow = 0;
+    std::int32_t clipHigh = 0;
+    std::vector<ChannelAccumulator> accumulators;
+
+    /// @brief One channel of an interleaved block.
+    std::vector<std::int32_t> channelSamples;
+
+    /// @brief Scans the samples into lane totals, where sample i goes to
+    /// lane i % ScanLanes, so that an interleaved block whose channel count
+    /// divides the lane count gives each channel whole lanes of its own.
+    static void Scan(const std::int32_t* samples, size_t count,
+                     ScanTotals (&totals)[ScanLanes]);
+
+    /// @brief Adds a scan of count samples of one channel, stride samples
+    /// apart, searching them for clipping if it reached full scale.
+    void AddTotals(int channel, const ScanTotals& totals,
+                   const std::int32_t* samples, size_t count, size_t stride);
+
+    void CountClipping(ChannelAccumulator& accumulator,
+                       const std::int32_t* samples, size_t count,
+                       size_t stride);
+};
+
+#endif
@@ -0,0 +1,163 @@
+// LoudnessAnalyzer.h - Declares the LoudnessAnalyzer class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LOUDNESS_ANALYZER_H
+#define LOUDNESS_ANALYZER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "SampleAnalyzer.h"
+
+/// @brief The EBU R128 loudness of a file.
+struct LoudnessResult
+{
+    /// @brief Whether the samples were measured, which needs a known sample
+    /// rate and at least one channel.
+    bool measured = false;
+
+    /// @brief The gated loudness of the whole file in LUFS, or negative
+    /// infinity if no block was loud enough to pass the gates.
+    double integratedLoudness = 0;
+
+    /// @brief The spread of the short-term loudness in LU, from the 10th to
+    /// the 95th percentile of the gated 3 second blocks.
+    double loudnessRange = 0;
+
+    /// @brief The highest true peak of each channel, relative to full scale.
+    std::vector<double> channelTruePeaks;
+
+    /// @brief The highest true peak of any channel in dBTP.
+    double TruePeakDbtp() const;
+};
+
+/// @brief Measures integrated loudness, loudness range and true peak as
+/// defined by ITU-R BS.1770-4 and EBU R128 in one pass over the samples.
+///
+/// Each channel is K-weighted by two biquads, and the mean square of the
+/// weighted samples is kept for every 100 ms. Those are all the gating
+/// needs, as the 400 ms momentary blocks and 3 second short-term blocks
+/// overlap in steps of 100 ms, so the gates are applied when the result
+/// is taken. An hour of audio keeps 36000 of them.
+///
+/// The biquads are recursive, so each step of a channel depends on the
+/// last, but the channels are independent. Frames are filtered with the
+/// channels as the inner loop, which is unrolled for mono and stereo so
+/// their states sit side by side in one vector register. The true peak
+/// uses the standard's 4x oversampling FIR, one channel at a time, which
+/// is skipped for runs of samples too quiet for its output to beat the
+/// peak so far.
+class LoudnessAnalyzer : public SampleAnalyzer
+{
+public:
+    LoudnessAnalyzer() = default;
+
+    /// @brief The number of frames in each 100 ms the gating is built on.
+    static size_t SubBlockLength(long sampleRate);
+
+    /// @brief Clears the measurement and sets it up for the channels, the
+    /// sample rate and signed samples of bitsPerSample bits.
+    ///
+    /// The channels are weighted as the standard requires for 5.0 and 5.1
+    /// in WAVE channel order, with the surrounds at +1.5 dB and the LFE
+    /// excluded; any other layout weights every channel equally.
+    void Reset(int channelCount, long sampleRate, int bitsPerSample);
+
+    int ChannelCount() const { return channels; }
+
+    /// @brief Adds a block of interleaved samples that starts with the
+    /// first channel and holds whole frames.
+    void AddInterleaved(const std::int32_t* samples, size_t count);
+
+    /// @brief Adds frameCount samples from each channel's own array.
+    void AddPlanar(const std::int32_t* const* samples, size_t frameCount);
+
+    void Begin(const SampleFormat& format) override;
+
+    void Process(const SampleBlock& block) override;
+
+    /// @brief Whether parts can be appended, which needs each part but the
+    /// last to hold whole multiples of SubBlockLength frames, so the 100 ms
+    /// blocks of the parts line up with those of the whole file.
+    bool CanAppend() const override { return true; }
+
+    /// @brief Runs the samples through the K-weighting filter and the true
+    /// peak history without measuring them, which settles the filter to
+    /// well within rounding after a few tens of milliseconds.
+    void Prime(const SampleBlock& block) override;
+
+    void Append(const SampleAnalyzer& next) override;
+
+    LoudnessResult Result() const;
+private:
+    /// @brief The number of taps in each phase of the true peak filter.
+    static constexpr int TruePeakTaps{ 12 };
+
+    /// @brief The coefficients of a biquad, normalized so a0 is 1.
+    struct Biquad
+    {
+        double b0 = 1;
+        double b1 = 0;
+        double b2 = 0;
+        double a1 = 0;
+        double a2 = 0;
+    };
+
+    int channels = 0;
+    double sampleScale = 0;
+    Biquad shelf;
+    Biquad highPass;
+    std::vector<double> channelWeights;
+
+    /// @brief The state of each stage of each channel's filter, a pair of
+    /// delays per stage in transposed direct form II.
+    std::vector<double> shelfState;
+    std::vector<double> highPassState;
+
+    size_t subBlockLength = 0;
+    size_t subBlockFill = 0;
+
+    /// @brief The sum of squares of each channel's weighted samples in the
+    /// current 100 ms.
+    std::vector<double> subBlockSums;
+
+    /// @brief The channel weighted mean square of every complete 100 ms.
+    std::vector<double> subBlockPowers;
+
+    std::vector<float> truePeaks;
+
+    /// @brief The last samples of each channel, which the true peak filter
+    /// needs ahead of the next block.
+    std::vector<float> truePeakHistory;
+
+    /// @brief The block being measured as interleaved frames, scaled to
+    /// full scale, and one channel of it with its history in front.
+    std::vector<double> frames;
+    std::vector<float> channelSamples;
+
+    void AddFrames(size_t frameCount);
+
+    /// @brief Filters the frames with the version of Filter for the channel
+    /// count.
+    void FilterFrames(const double* input, size_t frameCount);
+
+    template <int Channels>
+    void Filter(const double* input, size_t frameCount);
+
+    void MeasureTruePeaks(size_t frameCount);
+};
+
+#endif
@@ -0,0 +1,139 @@
+// LowBitAnalyzer.h - Declares the LowBitAnalyzer class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LOW_BIT_ANALYZER_H
+#define LOW_BIT_ANALYZER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "SampleAnalyzer.h"
+
+/// @brief The low byte statistics of one channel.
+struct LowBitChannelStats
+{
+    std::uint64_t sampleCount = 0;
+
+    /// @brief The Shannon entropy of the low byte in bits, from 0 when it
+    /// never changes to 8 when every value is equally likely.
+    double entropy = 0;
+
+    /// @brief The correlation, from -1 to 1, between the low byte and the
+    /// upper bits stepping by one, or 0 if they never did.
+    ///
+    /// When the low byte is part of the signal, the upper bits step up just
+    /// as it wraps from its highest values to its lowest, so the two are
+    /// strongly anti-correlated. Noise added to an upscale is independent
+    /// of the upper bits, so it leaves the correlation near 0.
+    double correlation = 0;
+};
+
+/// @brief The outcome of a LowBitAnalyzer.
+struct LowBitResult
+{
+    /// @brief The score at and above which a file that fails the zero low
+    /// byte test is classed as a likely dithered upscale.
+    static constexpr double DitheredThreshold{ 0.5 };
+
+    std::vector<LowBitChannelStats> channels;
+
+    /// @brief How much the low bytes look like noise added to an upscale,
+    /// from 0 to 1: low entropy that is independent of the upper bits.
+    double score = 0;
+
+    bool IsLikelyDitheredUpscale() const { return score >= DitheredThreshold; }
+};
+
+/// @brief Gathers statistics of the low byte of each sample in one pass.
+///
+/// An upscale that was dithered or processed after padding has a non-zero
+/// low byte, so it passes as a natural bit depth on the zero low byte test
+/// alone. Its low byte is small noise around zero, though, where a natural
+/// recording's is spread evenly and follows the signal.
+///
+/// Everything is counted in one histogram per channel, with a row for each
+/// way the upper bits moved: down one, up one, or anything else. The rows
+/// sum to the low byte histogram for the entropy, and the up and down rows
+/// give the sums for the correlation, so each sample costs one increment.
+/// The histograms stay in the L1 cache, and each is split into lanes that
+/// consecutive samples take turns updating, so an increment never waits on
+/// the one before it when a run of samples lands in the same bin.
+class LowBitAnalyzer : public SampleAnalyzer
+{
+public:
+    LowBitAnalyzer() = default;
+
+    /// @brief Clears the statistics and sizes them for the channel count.
+    void Reset(int channelCount);
+
+    int ChannelCount() const { return static_cast<int>(accumulators.size()); }
+
+    /// @brief Adds count samples of one channel, stride samples apart.
+    void Add(int channel, const std::int32_t* samples, size_t count,
+             size_t stride = 1);
+
+    /// @brief Adds a block of interleaved samples that starts with the
+    /// first channel.
+    void AddInterleaved(const std::int32_t* samples, size_t count);
+
+    /// @brief Starts on samples wider than 8 bits, as the low byte of an
+    /// 8-bit sample is the whole sample.
+    void Begin(const SampleFormat& format) override;
+
+    void Process(const SampleBlock& block) override;
+
+    bool CanAppend() const override { return true; }
+
+    /// @brief Takes the upper bits of each channel's last sample, which the
+    /// part's first sample steps from.
+    void Prime(const SampleBlock& block) override;
+
+    void Append(const SampleAnalyzer& next) override;
+
+    LowBitResult Result() const;
+private:
+    static constexpr int Lanes{ 4 };
+    static constexpr int Rows{ 3 };
+    static constexpr int ByteValues{ 256 };
+
+    /// @brief The rows of samples where the upper bits stepped down by one,
+    /// didn't step by one, and stepped up by one.
+    static constexpr int StepDownRow{ 0 };
+    static constexpr int StepUpRow{ 2 };
+
+    /// @brief How many samples the 32-bit lane counts may take before they
+    /// are folded into the 64-bit totals.
+    static constexpr std::uint64_t FoldInterval{ 0xFFFFFFFF };
+
+    struct ChannelAccumulator
+    {
+        std::uint32_t lanes[Lanes][Rows][ByteValues]{ };
+        std::uint64_t totals[Rows][ByteValues]{ };
+        std::uint64_t sampleCount = 0;
+        std::uint64_t unfoldedCount = 0;
+        std::int32_t previousUpper = 0;
+
+        /// @brief Whether previousUpper is set, which it isn't before the
+        /// first sample of the file.
+        bool hasPrevious = false;
+
+        void Fold();
+    };
+
+    std::vector<ChannelAccumulator> accumulators;
+};
+
+#endif
@@ -28,6 +28,10 @@
 #include "FlacFile.h"
 #include "LibCppLogging.h"
 #include "AnalysisThread.h"
+#include "ImportThread.h"
+#include "MediaDropTarget.h"
+#include "FileTable.h"
+#include "FileListView.h"
 #include "Version.h"
 
 class MainWindow : public wxFrame
@@ -36,29 +40,79 @@ public:
     MainWindow(wxString programInfo);
 private:
     wxMenuItem* openMenuItem;
-    wxListView* fileListView;
+    wxMenuItem* openFolderMenuItem;
+    wxTextCtrl* filterText;
+    wxCheckBox* upscaledOnlyBox;
+    FileListView* fileListView;
     wxButton* analyzeButton;
+    wxButton* pauseButton;
+    wxButton* cancelButton;
     wxGauge* progressBar;
     wxString programInfo;
-    std::vector<std::shared_ptr<MediaFile>> fileList;
+
+    /// @brief The selected files and their results, which the file list
+    /// view shows. The files themselves are only opened to import and
+    /// analyze them, on threads of their own.
+    FileTable fileTable;
     std::shared_ptr<Logging::Logger> logger;
     std::shared_ptr<Logging::LogFile> logFile;
 
+    /// @brief Pauses and cancels the analysis that is running, if any.
+    std::shared_ptr<AnalysisControl> analysisControl;
+
+    /// @brief Stops the imports into the current selection, if any.
+    std::shared_ptr<AnalysisControl> importControl;
+
+    /// @brief Counts the selections opened, so imports into one that has
+    /// been replaced are ignored.
+    int importSession = 0;
+
     void OnOpen(wxCommandEvent& event);
 
+    void OnOpenFolder(wxCommandEvent& event);
+
     void OnExit(wxCommandEvent& event);
 
     void OnAbout(wxCommandEvent& event);
 
     void OnAnalyze(wxCommandEvent& event);
 
+    void OnPause(wxCommandEvent& event);
+
+    void OnCancel(wxCommandEvent& event);
+
     void OnStatusUpdate(wxCommandEvent& event);
 
+    void OnResults(wxThreadEvent& event);
+
+    void OnImportResults(wxThreadEvent& event);
+
+    void OnImportComplete(wxThreadEvent& event);
+
     void OnAnalysisComplete(wxCommandEvent& event);
 
+    void OnColumnClick(wxListEvent& event);
+
+    void OnFilterChanged(wxCommandEvent& event);
+
     void PopulateFileListView();
 
-    void UpdateFileListView();
+    /// @brief Starts finding the media files in a list of files and
+    /// folders on a thread of its own, adding them to the table as they are
+    /// found.
+    /// @param newSelection Replaces the files in the table, rather than
+    /// adding to them.
+    void StartImport(std::vector<std::string> roots, bool newSelection);
+
+    /// @brief The paths of the files in the table, in row order.
+    std::vector<std::string> TablePaths() const;
+
+    /// @brief Shows a batch of results, rebuilding the view only if they
+    /// could change it.
+    void ShowResults();
+
+    /// @brief Rebuilds the table's view and shows it.
+    void RefreshFileListView();
 
     void ShowError(wxString message);
 
@@ -0,0 +1,53 @@
+// MappedFile.h - Declares the MappedFile class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include "MemorySource.h"
+
+/// @brief Reads a file by mapping it into memory.
+///
+/// Reads copy straight out of the page cache without a read system call
+/// per block. Mapping is only supported on POSIX systems; elsewhere, and
+/// for empty files, IsOpen stays false after Open and callers should fall
+/// back to FileReader.
+class MappedFile : public MemorySource
+{
+public:
+    MappedFile(std::string fileName);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string FileName() const { return fileName; }
+
+    bool IsOpen() const { return mapping != nullptr; }
+
+    void Open();
+
+    void Close();
+private:
+    std::string fileName;
+    void* mapping;
+    std::uint64_t mappingSize;
+};
+
+#endif
@@ -0,0 +1,42 @@
+// MediaDropTarget.h - Declares the MediaDropTarget class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIA_DROP_TARGET_H
+#define MEDIA_DROP_TARGET_H
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <wx/wx.h>
+#include <wx/dnd.h>
+
+/// @brief Accepts files and folders dropped on a window and passes their
+/// paths on, leaving the folders to be walked by whoever handles them.
+class MediaDropTarget : public wxFileDropTarget
+{
+public:
+    using DropHandler = std::function<void(std::vector<std::string>)>;
+
+    MediaDropTarget(DropHandler handler) : handler{ handler } { }
+
+    bool OnDropFiles(wxCoord x, 
+                     wxCoord y, 
+                     const wxArrayString& fileNames) override;
+private:
+    DropHandler handler;
+};
+
+#endif
@@ -20,9 +20,22 @@
 #include <string>
 #include <algorithm>
 #include <stdexcept>
+#include <memory>
+#include <cstdint>
+#include <filesystem>
 #include "BitDepth.h"
 #include "ConversionMethod.h"
 #include "MediaFileType.h"
+#include "ByteSource.h"
+#include "PageCache.h"
+#include "AnalysisPipeline.h"
+#include "UpscaleAnalyzer.h"
+#include "EffectiveBitsAnalyzer.h"
+#include "LowBitAnalyzer.h"
+#include "DistinctValueAnalyzer.h"
+#include "LevelAnalyzer.h"
+#include "LoudnessAnalyzer.h"
+#include "SampleHashAnalyzer.h"
 #include "LibCppLogging.h"
 
 class MediaFormatError : public std::runtime_error
@@ -51,12 +64,103 @@ public:
 
     virtual void Analyze(bool dumpSamples) = 0;
 
-    virtual void Convert(
+    /// @brief Writes the file converted to depth to outputFileName,
+    /// logging the reason for any failure.
+    /// @return True if the whole file was converted and written.
+    virtual bool Convert(
         std::string outputFileName, 
         BitDepth depth, 
         ConversionMethod method) = 0;
 
-    virtual bool IsUpscaled() const = 0;
+    /// @brief The analyzers Analyze passes the decoded samples to, in one
+    /// pass. Every file starts with the upscale, effective bits, low bits,
+    /// distinct values, level and loudness analyzers.
+    ///
+    /// Once every analyzer is done, Analyze stops reading, unless it is
+    /// dumping the samples or something else needs the whole file.
+    AnalysisPipeline& Analyzers() { return analyzers; }
+
+    const AnalysisPipeline& Analyzers() const { return analyzers; }
+
+    /// @brief Whether the last Analyze found a zero low byte in every
+    /// sample. False if the file has no UpscaleAnalyzer.
+    bool IsUpscaled() const;
+
+    /// @brief The low byte statistics gathered by the last Analyze, which
+    /// tell a dithered upscale from a natural bit depth. Empty for 8-bit
+    /// files, where the low byte is the whole sample.
+    LowBitResult LowBits() const;
+
+    /// @brief The distinct values and quantization step found by the last
+    /// Analyze, which expose a 16-bit source scaled up with gain. Only
+    /// analyzed for sample sizes from 17 to 24 bits.
+    DistinctValueResult DistinctValues() const;
+
+    /// @brief The peak, RMS, DC offset and clipping of each channel found
+    /// by the last Analyze.
+    LevelResult Levels() const;
+
+    /// @brief The EBU R128 integrated loudness, loudness range and true
+    /// peak measured by the last Analyze.
+    LoudnessResult Loudness() const;
+
+    /// @brief The part of the file Analyze reads, which is only known once
+    /// the file is open.
+    virtual ByteRange AnalysisRange() const = 0;
+
+    /// @brief Makes Analyze read from source rather than from the file the
+    /// MediaFile opened itself, so a batch can read files ahead of time.
+    ///
+    /// The source must be positioned at the start of AnalysisRange. Passing
+    /// nullptr goes back to reading the file's input.
+    virtual void SetAnalysisSource(std::shared_ptr<ByteSource> source) = 0;
+
+    /// @brief Limits the next Analyze to frameCount sample frames from
+    /// firstFrame, so a long file can be analyzed in parts on several
+    /// threads and the parts joined with AnalysisPipeline::Append.
+    ///
+    /// The leadIn frames before the part are decoded too, to prime the
+    /// analyzers, but aren't counted. A frameCount that runs past the end
+    /// analyzes the rest of the file. Must be called after Open.
+    /// @return False if the file can't be analyzed in parts, such as one
+    /// that can't seek or has an analyzer that can't be appended.
+    virtual bool SetAnalysisPart(
+        std::uint64_t firstFrame, 
+        std::uint64_t frameCount, 
+        std::uint64_t leadIn)
+    {
+        return false;
+    }
+
+    /// @brief Makes Open and Analyze read the whole file from input rather
+    /// than opening the file by name, so a file held in memory or already
+    /// open elsewhere can be analyzed. Must be called before Open.
+    ///
+    /// The file name is then only a label. Passing nullptr goes back to
+    /// opening the file by name.
+    virtual void SetInput(std::shared_ptr<ByteSource> input) = 0;
+
+    /// @brief Sets how the file and any converted output treat the page
+    /// cache. Must be called before Open.
+    virtual void SetCachePolicy(CachePolicy policy) = 0;
+protected:
+    MediaFile();
+
+    AnalysisPipeline analyzers;
 };
 
+/// @brief Creates the MediaFile subclass for the type of the file.
+/// @return The file, or nullptr if the type is not supported.
+std::shared_ptr<MediaFile> CreateMediaFile(
+    std::string fileName, 
+    std::shared_ptr<Logging::Logger> logger);
+
+/// @brief Creates the MediaFile subclass for a type found some other way
+/// than by the file's name, such as by DetectType.
+/// @return The file, or nullptr if the type is not supported.
+std::shared_ptr<MediaFile> CreateMediaFile(
+    MediaFileType type,
+    std::string fileName, 
+    std::shared_ptr<Logging::Logger> logger);
+
 #endif
\ No newline at end of file
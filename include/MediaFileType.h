@@ -17,11 +17,25 @@
 #ifndef MEDIA_FILE_TYPE_H
 #define MEDIA_FILE_TYPE_H
 
+#include <string>
+#include <cstddef>
+
 enum MediaFileType
 {
     Wave,
     Flac,
+    Aiff,
     Unsupported
 };
 
+/// @brief Determines the type of a media file from its extension.
+MediaFileType GetType(std::string fileName);
+
+/// @brief The number of bytes from the start of a file DetectType needs.
+constexpr size_t TypeSignatureSize{ 12 };
+
+/// @brief Determines the type of a media file from its first bytes, for
+/// files that don't have a name to go by.
+MediaFileType DetectType(const void* header, size_t size);
+
 #endif
\ No newline at end of file
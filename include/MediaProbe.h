@@ -0,0 +1,79 @@
+// MediaProbe.h - Declares the ProbeResult struct and probe functions.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIA_PROBE_H
+#define MEDIA_PROBE_H
+
+#include <string>
+#include <cstdint>
+#include "MediaFileType.h"
+#include "ByteSource.h"
+
+class MediaFile;
+
+/// @brief The header information of a media file, as found by a probe.
+struct ProbeResult
+{
+    std::string fileName;
+    MediaFileType type = MediaFileType::Unsupported;
+
+    /// @brief Describes the encoding, such as "WAVE PCM", "FLAC" or
+    /// "AIFF-C sowt".
+    std::string format;
+
+    int bitsPerSample = 0;
+    long sampleRate = 0;
+    int channels = 0;
+
+    /// @brief The number of samples in each channel.
+    std::uint64_t totalSamples = 0;
+
+    /// @brief The size of the file in bytes.
+    std::uint64_t fileSize = 0;
+
+    /// @brief Describes why the probe failed, or is empty if it succeeded.
+    std::string error;
+
+    /// @brief The length of the audio in seconds.
+    double Duration() const
+    {
+        return sampleRate > 0 ? static_cast<double>(totalSamples) / sampleRate
+                              : 0.0;
+    }
+};
+
+/// @brief Reads just enough of a media file to describe its format.
+///
+/// Unlike MediaFile::Open, a probe reads a few KB at most: WAVE chunks other
+/// than 'fmt ' and AIFF chunks before 'COMM' are seeked past, and FLAC files
+/// are read up to STREAMINFO without creating a decoder. Failures are
+/// reported through the result's error field rather than thrown, so a batch
+/// of probes can carry on.
+ProbeResult ProbeMediaFile(std::string fileName);
+
+/// @brief Probes a file read from source, such as one held in memory,
+/// telling its type from its first bytes rather than from a name.
+///
+/// Only the type of a stream, whose size is 0, is found, so that it can be
+/// read from the start again; DescribeMediaFile fills in the rest.
+/// @param name The name to give the result, which may be empty.
+ProbeResult ProbeMediaSource(ByteSource& source, std::string name);
+
+/// @brief Fills in a probe's format fields from a WAVE or FLAC file that
+/// has been opened and, for FLAC, analyzed, for files read as a stream.
+void DescribeMediaFile(const MediaFile& file, ProbeResult& result);
+
+#endif
@@ -0,0 +1,77 @@
+// MemorySource.h - Declares the MemorySource class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEMORY_SOURCE_H
+#define MEMORY_SOURCE_H
+
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include "ByteSource.h"
+
+/// @brief Reads a media file that is already in memory.
+///
+/// The source doesn't copy or own the bytes, so whoever supplies them must
+/// keep them alive for as long as the source is in use.
+class MemorySource : public ByteSource
+{
+public:
+    MemorySource(const void* data, std::uint64_t size) :
+        data{ static_cast<const std::uint8_t*>(data) }, 
+        size{ size }, 
+        position{ 0 } 
+    { }
+
+    size_t Read(void* destination, size_t count) override
+    {
+        count = static_cast<size_t>(
+            std::min<std::uint64_t>(count, size - position));
+        if (count > 0)
+            std::memcpy(destination, data + position, count);
+        position += count;
+        return count;
+    }
+
+    bool Seek(std::uint64_t position) override
+    {
+        if (position > size)
+            return false;
+
+        this->position = position;
+        return true;
+    }
+
+    std::uint64_t Position() const override { return position; }
+
+    std::uint64_t Size() const override { return size; }
+protected:
+    MemorySource() : data{ nullptr }, size{ 0 }, position{ 0 } { }
+
+    /// @brief Points the source at different bytes and rewinds it.
+    void SetData(const void* data, std::uint64_t size)
+    {
+        this->data = static_cast<const std::uint8_t*>(data);
+        this->size = size;
+        position = 0;
+    }
+private:
+    const std::uint8_t* data;
+    std::uint64_t size;
+    std::uint64_t position;
+};
+
+#endif
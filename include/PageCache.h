@@ -0,0 +1,70 @@
+// PageCache.h - Declares functions for controlling the OS page cache.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PAGE_CACHE_H
+#define PAGE_CACHE_H
+
+#include <string>
+#include <cstdint>
+
+/// @brief Represents how file I/O should treat the OS page cache.
+enum class CachePolicy
+{
+    /// @brief Leaves caching to the OS.
+    Normal,
+
+    /// @brief Drops file data from the cache once it has been read or
+    /// written, so scanning a large library doesn't evict the cache that
+    /// other programs on the machine depend on.
+    Streaming
+};
+
+/// @brief The number of a file's pages that are in the page cache.
+struct CacheResidency
+{
+    std::uint64_t cachedPages = 0;
+    std::uint64_t totalPages = 0;
+
+    CacheResidency& operator+=(const CacheResidency& other)
+    {
+        cachedPages += other.cachedPages;
+        totalPages += other.totalPages;
+        return *this;
+    }
+};
+
+// These only do anything on Linux; elsewhere they are no-ops and
+// MeasureCacheResidency reports nothing cached.
+
+/// @brief Tells the OS the file will be read in order, so it reads ahead
+/// further and frees pages behind the reader sooner.
+void AdviseSequential(int descriptor);
+
+/// @brief Drops size bytes of the file starting at offset from the cache.
+/// A size of 0 means to the end of the file.
+void DropFromCache(int descriptor, std::uint64_t offset, std::uint64_t size);
+
+/// @brief Writes a range of the file to storage and then drops it from the
+/// cache, as written pages can't be dropped until they are clean.
+void DropWrittenFromCache(
+    int descriptor, 
+    std::uint64_t offset, 
+    std::uint64_t size);
+
+/// @brief Counts how much of a file is in the page cache.
+CacheResidency MeasureCacheResidency(std::string fileName);
+
+#endif
@@ -0,0 +1,317 @@
+// PcmFile.h - Declares the PcmFile class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PCM_FILE_H
+#define PCM_FILE_H
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+#include "LibCppBinary.h"
+#include "LibCppLogging.h"
+#include "BitDepth.h"
+#include "ConversionMethod.h"
+#include "SampleConverter.h"
+#include "MediaFile.h"
+#include "SampleDumper.h"
+#include "ByteOrder.h"
+#include "FileReader.h"
+#include "FileWriter.h"
+
+/// @brief A media file that stores uncompressed PCM samples in one chunk,
+/// such as a WAVE or AIFF file.
+///
+/// Derived classes parse their container in Open, setting where the samples
+/// are, their byte order and whether 8-bit samples are signed. Reading the
+/// samples in blocks for analysis and conversion is shared, with the byte
+/// order fixed per block so big endian data is swapped as it is decoded.
+class PcmFile : public MediaFile
+{
+public:
+    PcmFile(std::string fileName, std::shared_ptr<Logging::Logger> logger);
+
+    /// @brief Whether the file is open, which a file read from a source
+    /// given to SetInput always is.
+    bool IsOpen() const override { return input != reader || reader->IsOpen(); }
+
+    bool Exists() const override 
+    { 
+        return input != reader || MediaFile::Exists(); 
+    }
+
+    std::string FileName() const override { return fileName; }
+
+    void Analyze(bool dumpSamples) override;
+
+    /// @brief The number of channels, whose samples are interleaved.
+    virtual int Channels() const = 0;
+
+    /// @brief The sample data, or the part of it set by SetAnalysisPart,
+    /// lead-in included.
+    ByteRange AnalysisRange() const override
+    {
+        return hasPart ? part : ByteRange{ dataOffset, dataSize };
+    }
+
+    void SetAnalysisSource(std::shared_ptr<ByteSource> source) override
+    {
+        sampleSource = source != nullptr ? source : input;
+    }
+
+    void SetInput(std::shared_ptr<ByteSource> input) override
+    {
+        this->input = input != nullptr ? input : reader;
+        sampleSource = this->input;
+    }
+
+    bool SetAnalysisPart(
+        std::uint64_t firstFrame, 
+        std::uint64_t frameCount, 
+        std::uint64_t leadIn) override;
+
+    void SetCachePolicy(CachePolicy policy) override;
+protected:
+    static constexpr size_t SamplesPerBlock{ 16 * 1024 };
+
+    std::string fileName;
+
+    /// @brief The offset of the first sample from the start of the file.
+    std::uint64_t dataOffset;
+
+    /// @brief The size of the sample data in bytes.
+    std::uint64_t dataSize;
+
+    /// @brief The byte order of the samples in the file.
+    Endianness sampleOrder;
+
+    /// @brief Whether 8-bit samples are signed, as in AIFF, rather than
+    /// unsigned as in WAVE. They are offset to unsigned as they're decoded
+    /// so both look the same to the analysis and the sample converter.
+    bool hasSigned8BitSamples;
+
+    std::shared_ptr<FileReader> reader;
+
+    /// @brief Where Open reads the header from: the reader, or the source
+    /// given to SetInput.
+    std::shared_ptr<ByteSource> input;
+
+    std::shared_ptr<ByteSource> sampleSource;
+    std::shared_ptr<FileWriter> writer;
+    CachePolicy cachePolicy;
+    std::shared_ptr<Logging::Logger> logger;
+    std::shared_ptr<SampleDumper> sampleDumper;
+
+    /// @brief Collects interleaved samples for the analyzers, which take
+    /// them a block of whole sample frames at a time.
+    std::vector<std::int32_t> sampleBlock;
+    size_t sampleBlockSize;
+
+    /// @brief The first sample of each channel in the sample block.
+    std::vector<const std::int32_t*> blockChannels;
+
+    /// @brief The bytes of the part of the sample data Analyze reads, if
+    /// SetAnalysisPart was called.
+    ByteRange part;
+    bool hasPart;
+
+    /// @brief The frames at the start of the part that only prime the
+    /// analyzers, and how many of them Analyze has yet to pass on.
+    std::uint64_t leadInFrames;
+    std::uint64_t primeFrames;
+
+    /// @brief The number of bytes each sample occupies in the file.
+    int BytesPerSample() const { return (BitsPerSample() + 7) / 8; }
+
+    long CalculateNumberOfSamples();
+
+    long CalculateNewDataSize(BitDepth depth, long numberOfSamples);
+
+    /// @brief Opens the reader, unless the file is read from a source given
+    /// to SetInput.
+    /// @return Whether there is an open input to read.
+    bool OpenInput();
+
+    /// @brief Passes the collected frames to the analyzers, or to their
+    /// Prime while there is lead-in left, and clears them.
+    void AnalyzeSampleBlock();
+
+    /// @brief The number of samples to collect for the next block, which
+    /// stops short at the end of the lead-in.
+    size_t NextBlockSize() const;
+
+    /// @brief Creates the writer for a conversion and opens the output.
+    /// @return False, having logged the error, if the output can't be opened.
+    bool OpenWriter(std::string outputFileName);
+
+    /// @brief Converts every sample to the new depth and writes it to the
+    /// output in the same byte order as the input.
+    /// @return False if a sample couldn't be converted, read or written.
+    bool WriteConvertedSamples(ConversionMethod method, BitDepth depth);
+
+    /// @brief Reads the range of sample data from source in blocks, passing
+    /// each decoded sample to process until it returns false or the data
+    /// runs out.
+    template <typename Function>
+    void ReadSamples(ByteSource& source, ByteRange range, Function process)
+    {
+        if (sampleOrder == Endianness::Big)
+            DecodeSamples<Endianness::Big>(source, range, process);
+        else
+            DecodeSamples<Endianness::Little>(source, range, process);
+    }
+
+    template <Endianness Order, typename Function>
+    void DecodeSamples(ByteSource& source, ByteRange range, Function process)
+    {
+        size_t bytesPerSample = BytesPerSample();
+        std::vector<std::uint8_t> block(bytesPerSample * SamplesPerBlock);
+        std::uint64_t bytesRemaining = range.size;
+        bytesRemaining -= bytesRemaining % bytesPerSample;
+
+        // Flipping the top bit of a signed byte offsets it to unsigned.
+        std::int32_t signFlip =
+            bytesPerSample == 1 && hasSigned8BitSamples ? 0x80 : 0;
+
+        if (!source.Seek(range.offset))
+            return;
+
+        while (bytesRemaining > 0)
+        {
+            size_t count = static_cast<size_t>(
+                std::min<std::uint64_t>(block.size(), bytesRemaining));
+            size_t bytesRead = source.Read(block.data(), count);
+            bytesRead -= bytesRead % bytesPerSample;
+
+            for (size_t i = 0; i < bytesRead; i += bytesPerSample)
+            {
+                std::int32_t value = DecodeSample<Order>(
+                    &block[i], static_cast<int>(bytesPerSample));
+                if (!process(value ^ signFlip))
+                    return;
+            }
+
+            // A short read means the file is truncated, so stop at the last
+            // complete sample rather than reading past the end of the file.
+            if (bytesRead < count)
+                break;
+
+            bytesRemaining -= bytesRead;
+        }
+    }
+
+    template <typename T>
+    bool ConvertSamples(ConversionMethod method, BitDepth depth)
+    {
+        switch (depth)
+        {
+            case BitDepth::UInt8:
+                return ConvertSamples<T, Binary::UInt8Field>(method, depth);
+            case BitDepth::Int16:
+                return ConvertSamples<T, Binary::Int16Field>(method, depth);
+            case BitDepth::Int24:
+                return ConvertSamples<T, Binary::Int24Field>(method, depth);
+            case BitDepth::Int32:
+                return ConvertSamples<T, Binary::Int32Field>(method, depth);
+            default:
+                return false;
+        }
+    }
+
+    template <typename T, typename U>
+    bool ConvertSamples(ConversionMethod method, BitDepth depth)
+    {
+        auto converter = SampleConverter<T>(method, depth);
+        long samplesConverted{ 0 };
+        ReadSamples(*reader, ByteRange{ dataOffset, dataSize }, 
+                    [&](std::int32_t value)
+        {
+            if (!ConvertNext<T, U>(converter, value))
+                return false;
+
+            samplesConverted++;
+            return true;
+        });
+
+        // The header written before the samples promises all of them, so a
+        // sample that couldn't be converted, or a file that ended early,
+        // leaves the output incomplete.
+        return samplesConverted == CalculateNumberOfSamples();
+    }
+
+    template <typename T, typename U>
+    bool ConvertNext(SampleConverter<T>& converter, std::int32_t value)
+    {
+        T sample{ 0 };
+        sample.SetValue(value);
+        std::shared_ptr<Binary::DataField> newSample = converter.Convert(sample);
+
+        if (newSample != nullptr)
+        {
+            // The converter always returns a field of the type that matches
+            // the depth it was created with, which is U.
+            auto typedSample = std::static_pointer_cast<U>(newSample);
+            int size = static_cast<int>(typedSample->Size());
+            std::int64_t newValue = typedSample->Value();
+            if (size == 1 && hasSigned8BitSamples)
+                newValue ^= 0x80;
+
+            std::uint8_t bytes[4];
+            if (sampleOrder == Endianness::Big)
+                EncodeBigEndian(newValue, bytes, size);
+            else
+                EncodeLittleEndian(newValue, bytes, size);
+            return writer->Write(bytes, size);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    /// @brief Adds a sample to the block, analyzing the block once full.
+    /// @return False once the analyzers need no more samples.
+    template <typename T>
+    bool AnalyzeNextSample(std::int32_t value, bool dumpSamples)
+    {
+        if (dumpSamples)
+        {
+            if (sampleDumper == nullptr)
+                sampleDumper = std::make_shared<SampleDumper>(fileName);
+
+            T sample{ 0 };
+            sample.SetValue(value);
+            sampleDumper->Dump(&sample);
+        }
+
+        // 8-bit samples are unsigned, so they're offset to be centered on
+        // zero like the others.
+        if constexpr (std::is_same_v<T, Binary::UInt8Field>)
+            sampleBlock.push_back(value - 0x80);
+        else
+            sampleBlock.push_back(value);
+
+        if (sampleBlock.size() < sampleBlockSize)
+            return true;
+
+        AnalyzeSampleBlock();
+        return dumpSamples || !analyzers.IsDone();
+    }
+};
+
+#endif
@@ -22,6 +22,15 @@
 #include <iomanip>
 #include <sstream>
 #include <memory>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <csignal>
 #include "LibCppCmdLine.h"
 #include "WaveFile.h"
 #include "BitDepth.h"
@@ -29,6 +38,19 @@
 #include "LibCppLogging.h"
 #include "MediaFile.h"
 #include "FlacFile.h"
+#include "AiffFile.h"
+#include "MediaProbe.h"
+#include "InventoryWriter.h"
+#include "FileEnumerator.h"
+#include "WorkQueue.h"
+#include "BatchAnalyzer.h"
+#include "ReadStrategy.h"
+#include "AnalysisServer.h"
+#include "StreamSource.h"
+#include "FileDescriptor.h"
+#include "BatchJournal.h"
+#include "FileShard.h"
+#include "InventoryMerger.h"
 
 class Program
 {
@@ -38,6 +60,39 @@ public:
     static constexpr int ExitStatusInputFileError{ 2 };
     static constexpr int ExitStatusUnsupportedFile{ 3 };
     static constexpr int ExitStatusNotImplemented{ 4 };
+    static constexpr int ExitStatusOutputFileError{ 5 };
+    static constexpr int ExitStatusVerifyFailed{ 6 };
+    static constexpr int ExitStatusServerError{ 7 };
+
+    /// @brief The input file name that reads standard input as a stream.
+    static constexpr const char* StandardInputName{ "-" };
+
+    /// @brief Probes mostly wait on storage rather than the CPU, so probe
+    /// mode runs this many workers per core to keep reads in flight.
+    static constexpr unsigned int ProbeWorkersPerCore{ 4 };
+
+    /// @brief Analysis needs the CPU as well as storage, so folder analysis
+    /// with blocking reads runs fewer workers per core than probe mode. With
+    /// io_uring one worker per core is enough, as each keeps its own reads
+    /// in flight.
+    static constexpr unsigned int AnalysisWorkersPerCore{ 2 };
+
+    /// @brief The io_uring queue depths that can be chosen with -q.
+    static constexpr unsigned int QueueDepths[]{ 16, 32, 64, 128, 256 };
+
+    static constexpr unsigned int DefaultQueueDepth{ 64 };
+
+    /// @brief The numbers of analysis threads that can be chosen with -g,
+    /// each of which runs beside the thread decoding the file.
+    static constexpr unsigned int AnalysisThreadCounts[]{ 1, 2, 3, 4 };
+
+    /// @brief Added to the output file's name to name the journal -R keeps.
+    static constexpr const char* JournalExtension{ ".journal" };
+
+    /// @brief Added to the name of a file being converted in a folder until
+    /// it is complete, so an interrupted conversion is never taken for a
+    /// finished one.
+    static constexpr const char* PartialExtension{ ".partial" };
 
     Program(int argc, char** argv);
 
@@ -59,6 +114,31 @@ private:
     std::shared_ptr<CmdLine::OptionParam> to32BitParam;
     std::shared_ptr<CmdLine::Option> logOption;
     std::shared_ptr<CmdLine::Option> dumpOption;
+    std::shared_ptr<CmdLine::Option> probeOption;
+    std::shared_ptr<CmdLine::Option> ioUringOption;
+    std::shared_ptr<CmdLine::ValueOption> queueDepthOption;
+    std::vector<std::shared_ptr<CmdLine::OptionParam>> queueDepthParams;
+    std::shared_ptr<CmdLine::Option> noCacheOption;
+    std::shared_ptr<CmdLine::ValueOption> readOption;
+    std::shared_ptr<CmdLine::OptionParam> bufferedParam;
+    std::shared_ptr<CmdLine::OptionParam> mappedParam;
+    std::shared_ptr<CmdLine::OptionParam> memoryParam;
+    std::shared_ptr<CmdLine::Option> benchmarkOption;
+    std::shared_ptr<CmdLine::Option> verifyOption;
+    std::shared_ptr<CmdLine::Option> quickOption;
+    std::shared_ptr<CmdLine::Option> hashOption;
+    std::shared_ptr<CmdLine::ValueOption> analysisThreadsOption;
+    std::vector<std::shared_ptr<CmdLine::OptionParam>> analysisThreadsParams;
+    std::shared_ptr<CmdLine::Option> serveOption;
+    std::shared_ptr<CmdLine::Option> resumeOption;
+    std::shared_ptr<CmdLine::Option> shardOption;
+    std::shared_ptr<CmdLine::PosParam> shardParam;
+
+    /// @brief The shard chosen with -H, counting from 1, and the number of
+    /// shards, or 0 for both if the batch isn't sharded.
+    unsigned int shardIndex{ 0 };
+    unsigned int shardCount{ 0 };
+    std::shared_ptr<CmdLine::Option> mergeOption;
     std::shared_ptr<Logging::StandardOutput> standardOutput;
     std::shared_ptr<Logging::StandardError> standardError;
     std::shared_ptr<Logging::LogFile> logFile;
@@ -83,11 +163,68 @@ private:
 
     int PrintFlacInfo(FlacFile* file);
 
+    int PrintAiffInfo(AiffFile* file);
+
+    /// @brief Chooses the analyzers Analyze runs from the options.
+    void ConfigureAnalyzers(MediaFile* file);
+
     void PrintAnalysisResults(MediaFile* file);
 
+    void PrintRingStats(MediaFile* file);
+
+    int PrintVerifyResults(FlacFile* file);
+
+    void PrintCacheResidency(std::string label, CacheResidency residency);
+
+    CachePolicy GetCachePolicy();
+
+    ReadStrategy GetReadStrategy();
+
+    int BenchmarkAnalysis();
+
     std::shared_ptr<MediaFile> OpenFile(std::string fileName);
-};
 
-MediaFileType GetType(std::string fileName);
+    /// @brief Creates a file that reads standard input as a stream, telling
+    /// its type from its first bytes.
+    /// @return The file, or nullptr if the type is not supported.
+    std::shared_ptr<MediaFile> CreateStreamFile();
+
+    /// @brief Chooses where a batch inventory goes: the output file if one
+    /// was given, in the format its extension picks, or standard output.
+    /// @return The stream to write to, or nullptr if the file can't be opened.
+    std::ostream* OpenInventory(
+        std::ofstream& outputFile, 
+        InventoryFormat& format);
+
+    /// @brief Divides the input folder into the shards chosen with -H.
+    /// @return This process's shard, or nullptr if no shard was chosen.
+    std::unique_ptr<FileShard> OpenShard();
+
+    int ProbeFiles();
+
+    /// @brief Opens the journal kept beside the output file, so a batch
+    /// can resume where an earlier run stopped.
+    /// @param kind Describes the batch; see BatchJournal.
+    /// @param handler Called with each record of the earlier runs.
+    /// @return The journal, or nullptr if there is no output file to keep it
+    /// beside or it can't be used.
+    std::unique_ptr<BatchJournal> OpenJournal(
+        std::string kind, 
+        const BatchJournal::RecordHandler& handler = nullptr);
+
+    int AnalyzeFiles();
+
+    /// @brief Converts every supported file under the input folder into the
+    /// same tree under the output folder.
+    int ConvertFiles();
+
+    /// @brief Combines the inventories in the input folder, such as those
+    /// the shards of a batch wrote, into one report.
+    int MergeInventories();
+
+    /// @brief Answers requests on the Unix socket named by the input file
+    /// until interrupted.
+    int Serve();
+};
 
 #endif
\ No newline at end of file
@@ -0,0 +1,46 @@
+// ReadStrategy.h - Declares the ReadStrategy enum.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef READ_STRATEGY_H
+#define READ_STRATEGY_H
+
+#include <string>
+#include <memory>
+#include "ByteSource.h"
+
+/// @brief Represents the ways a media file's bytes can be read for analysis.
+enum class ReadStrategy
+{
+    /// @brief Reads through FileReader's buffer, which grows to 1 MB.
+    Buffered,
+
+    /// @brief Maps the file into memory.
+    MemoryMapped,
+
+    /// @brief Loads the whole file into memory before it is analyzed.
+    InMemory
+};
+
+/// @brief Opens a file for reading with the given strategy.
+/// @return The source, or nullptr if the file couldn't be opened.
+std::shared_ptr<ByteSource> OpenByteSource(
+    std::string fileName, 
+    ReadStrategy strategy);
+
+/// @brief The name of the strategy, as used on the command line.
+std::string ReadStrategyName(ReadStrategy strategy);
+
+#endif
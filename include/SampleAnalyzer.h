@@ -0,0 +1,56 @@
+// SampleAnalyzer.h - Declares the SampleAnalyzer class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SAMPLE_ANALYZER_H
+#define SAMPLE_ANALYZER_H
+
+#include "SampleBlock.h"
+
+/// @brief Something measured from the decoded samples of a file, which an
+/// AnalysisPipeline passes every block to as the file is decoded.
+class SampleAnalyzer
+{
+public:
+    virtual ~SampleAnalyzer() = default;
+
+    /// @brief Clears the last analysis and starts one of samples in format.
+    virtual void Begin(const SampleFormat& format) = 0;
+
+    /// @brief Adds a block of samples in the format given to Begin.
+    virtual void Process(const SampleBlock& block) = 0;
+
+    /// @brief Whether the result is settled, so no more samples can change
+    /// it and the analyzer needn't be given any.
+    virtual bool IsDone() const { return false; }
+
+    /// @brief Whether a file can be analyzed in consecutive parts, each by
+    /// an analyzer of its own, that are then joined with Append.
+    virtual bool CanAppend() const { return false; }
+
+    /// @brief Gives the samples just before the part of a file about to be
+    /// analyzed, so state carried from one sample to the next, such as a
+    /// filter's, starts as if the whole file were being analyzed. The
+    /// samples aren't counted. Called after Begin and before any Process,
+    /// possibly with several blocks in order.
+    virtual void Prime(const SampleBlock& block) { }
+
+    /// @brief Adds the analysis of the part of the file that follows this
+    /// one, made by an analyzer of the same type, so the result is that of
+    /// the whole. Only called if CanAppend.
+    virtual void Append(const SampleAnalyzer& next) { }
+};
+
+#endif
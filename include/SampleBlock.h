@@ -0,0 +1,74 @@
+// SampleBlock.h - Declares the SampleFormat and SampleBlock structs.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SAMPLE_BLOCK_H
+#define SAMPLE_BLOCK_H
+
+#include <cstdint>
+#include <cstddef>
+
+/// @brief The layout of the samples an analysis is given.
+struct SampleFormat
+{
+    int channels = 0;
+
+    /// @brief The size of each signed sample in bits. For PCM this is the
+    /// size of the container, which the samples are aligned to the top of.
+    int bitsPerSample = 0;
+
+    long sampleRate = 0;
+};
+
+/// @brief Whole frames of decoded, signed samples, with each channel in an
+/// array of its own or all of them interleaved in one.
+///
+/// A block doesn't own its samples; they belong to the decoder and only
+/// live as long as the call that is given the block.
+struct SampleBlock
+{
+    /// @brief The first sample of each channel.
+    const std::int32_t* const* channels = nullptr;
+
+    int channelCount = 0;
+
+    size_t frameCount = 0;
+
+    /// @brief The distance between consecutive samples of a channel: 1 when
+    /// each channel has its own array, or the channel count when they are
+    /// interleaved.
+    size_t stride = 1;
+
+    /// @brief The number of low bits the decoder knows to be zero in every
+    /// sample, such as from FLAC's wasted bits, so they needn't be checked.
+    int zeroLowBits = 0;
+
+    size_t SampleCount() const { return frameCount * channelCount; }
+
+    /// @brief The samples of every channel interleaved in one array, or
+    /// nullptr if each channel is in an array of its own.
+    const std::int32_t* Interleaved() const
+    {
+        return stride == static_cast<size_t>(channelCount) ? channels[0]
+                                                           : nullptr;
+    }
+
+    std::int32_t Sample(int channel, size_t frame) const
+    {
+        return channels[channel][frame * stride];
+    }
+};
+
+#endif
@@ -18,6 +18,7 @@
 #define SAMPLE_CONVERTER_H
 
 #include <memory>
+#include <iostream>
 #include "ConversionMethod.h"
 #include "BitDepth.h"
 
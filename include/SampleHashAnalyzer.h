@@ -0,0 +1,47 @@
+// SampleHashAnalyzer.h - Declares the SampleHashAnalyzer class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SAMPLE_HASH_ANALYZER_H
+#define SAMPLE_HASH_ANALYZER_H
+
+#include <cstdint>
+#include "SampleAnalyzer.h"
+
+/// @brief Hashes the decoded samples, so the same audio gives the same
+/// hash whatever container or compression holds it, such as a WAVE file
+/// and the FLAC encoded from it.
+///
+/// The hash is 64-bit FNV-1a taken a sample at a time, with each sample as
+/// a 32-bit word, in frame order. It identifies audio; it isn't meant to
+/// resist anyone forging a match.
+class SampleHashAnalyzer : public SampleAnalyzer
+{
+public:
+    SampleHashAnalyzer() = default;
+
+    void Begin(const SampleFormat& format) override { hash = OffsetBasis; }
+
+    void Process(const SampleBlock& block) override;
+
+    std::uint64_t Hash() const { return hash; }
+private:
+    static constexpr std::uint64_t OffsetBasis{ 0xCBF29CE484222325 };
+    static constexpr std::uint64_t Prime{ 0x100000001B3 };
+
+    std::uint64_t hash = OffsetBasis;
+};
+
+#endif
@@ -0,0 +1,145 @@
+// SampleRing.h - Declares the SampleRing class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include "SampleBlock.h"
+
+/// @brief How an AnalysisPipeline hands blocks from the decoder to its
+/// analysis threads.
+struct SampleRingSettings
+{
+    /// @brief The number of threads the analyzers are shared between, or 0
+    /// to analyze each block on the decoder's thread as it is decoded.
+    unsigned int analysisThreads = 0;
+
+    /// @brief The number of buffers in the ring, which is how far the
+    /// decoder may get ahead of the slowest analysis thread.
+    size_t bufferCount = 16;
+
+    /// @brief The number of frames each buffer holds. Larger blocks are
+    /// split across buffers.
+    size_t framesPerBuffer = 8192;
+};
+
+/// @brief How often each side of a SampleRing had to wait for the other.
+struct SampleRingStats
+{
+    /// @brief The number of buffers the decoder filled.
+    std::uint64_t blocks = 0;
+
+    /// @brief The number of times the decoder found every buffer still in
+    /// use, and the time it spent waiting for one, in seconds.
+    std::uint64_t producerStalls = 0;
+    double producerStallSeconds = 0;
+
+    /// @brief The number of times an analysis thread found no buffer ready,
+    /// and the time they spent waiting, summed over the threads.
+    std::uint64_t consumerStalls = 0;
+    double consumerStallSeconds = 0;
+};
+
+/// @brief A lock-free ring of reusable sample buffers that carries blocks
+/// from one decoding thread to one or more analysis threads.
+///
+/// The decoder copies each block into the next free buffer and publishes
+/// it by advancing its index. Each consumer reads every block in turn and
+/// advances an index of its own, and a buffer is free again once every
+/// consumer has moved past it. Each index is written by one thread only,
+/// so neither side takes a lock, and the indices sit on cache lines of
+/// their own so the two sides don't contend for them.
+///
+/// A side that has to wait spins briefly, then yields, then sleeps, so a
+/// ring whose other side is much slower doesn't keep a core busy.
+class SampleRing
+{
+public:
+    SampleRing(const SampleRingSettings& settings, int channels,
+               int consumers);
+
+    SampleRing(const SampleRing&) = delete;
+
+    SampleRing& operator=(const SampleRing&) = delete;
+
+    /// @brief Copies the block into the ring, waiting for free buffers.
+    /// @return False if every consumer has detached, so nobody reads it.
+    bool Push(const SampleBlock& block);
+
+    /// @brief Signals that no more blocks will be pushed.
+    void Close();
+
+    /// @brief Waits for the consumer's next block, which stays valid until
+    /// it is released.
+    /// @return The block, or nullptr once the ring is closed and empty.
+    const SampleBlock* Acquire(int consumer);
+
+    /// @brief Returns the consumer's current block to the ring.
+    void Release(int consumer);
+
+    /// @brief Stops the consumer holding up the decoder, as it wants no
+    /// more blocks.
+    void Detach(int consumer);
+
+    /// @brief The stall counts, which are only complete once the decoder
+    /// and every consumer are finished with the ring.
+    SampleRingStats Stats() const;
+private:
+    static constexpr size_t CacheLineSize{ 64 };
+
+    struct Buffer
+    {
+        std::vector<std::int32_t> samples;
+        std::vector<const std::int32_t*> channelSamples;
+        SampleBlock block;
+    };
+
+    struct alignas(CacheLineSize) Consumer
+    {
+        /// @brief The index of the next block the consumer reads.
+        std::atomic<std::uint64_t> position{ 0 };
+        std::atomic<bool> isDetached{ false };
+        std::uint64_t stalls = 0;
+        double stallSeconds = 0;
+    };
+
+    std::vector<Buffer> buffers;
+    std::vector<Consumer> consumers;
+    int channels;
+    size_t framesPerBuffer;
+
+    /// @brief The index of the next block the decoder writes.
+    alignas(CacheLineSize) std::atomic<std::uint64_t> position{ 0 };
+    std::atomic<bool> isClosed{ false };
+    std::uint64_t blocks = 0;
+    std::uint64_t producerStalls = 0;
+    double producerStallSeconds = 0;
+
+    /// @brief Whether the buffer at the decoder's position is free, or no
+    /// consumer is left to wait for.
+    bool HasFreeBuffer(std::uint64_t next, bool& anyAttached) const;
+
+    /// @brief Copies frameCount frames of the block, from frame first on,
+    /// into the buffer.
+    void Fill(Buffer& buffer, const SampleBlock& block, size_t first,
+              size_t frameCount);
+};
+
+#endif
@@ -0,0 +1,76 @@
+// StreamSource.h - Declares the StreamSource class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef STREAM_SOURCE_H
+#define STREAM_SOURCE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "ByteSource.h"
+
+/// @brief Reads a media file from a pipe, such as standard input, that can
+/// only be read forward.
+///
+/// The stream passes through a buffer of a fixed size, so a stream of any
+/// length is read in bounded memory. Seeking forward reads and discards
+/// what is skipped. Seeking back only works within what the buffer still
+/// holds; it fills from the start of the stream before it is reused, so the
+/// header can be read again once the type of the file has been told from
+/// its first bytes. The size is 0, as the length of a stream isn't known
+/// until it ends.
+///
+/// The source doesn't own the descriptor, so whoever opened it closes it.
+class StreamSource : public ByteSource
+{
+public:
+    static constexpr size_t DefaultBufferSize{ 1024 * 1024 };
+
+    StreamSource(int descriptor, size_t bufferSize = DefaultBufferSize);
+
+    StreamSource(const StreamSource&) = delete;
+
+    StreamSource& operator=(const StreamSource&) = delete;
+
+    size_t Read(void* data, size_t size) override;
+
+    /// @brief Moves the read position to the given offset from the start.
+    /// @return False if the position is behind what the buffer holds, or
+    /// the stream ends before it.
+    bool Seek(std::uint64_t position) override;
+
+    std::uint64_t Position() const override 
+    { 
+        return bufferStart + bufferPosition; 
+    }
+
+    std::uint64_t Size() const override { return 0; }
+private:
+    int descriptor;
+    std::vector<std::uint8_t> buffer;
+
+    /// @brief The offset in the stream of the first byte of the buffer.
+    std::uint64_t bufferStart;
+    size_t bufferPosition;
+    size_t bufferLength;
+
+    /// @brief Reads more of the stream into the buffer, after what it
+    /// already holds while there is room, or over it once it is full.
+    /// @return False at the end of the stream or on a read error.
+    bool FillBuffer();
+};
+
+#endif
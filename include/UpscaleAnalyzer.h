@@ -0,0 +1,51 @@
+// UpscaleAnalyzer.h - Declares the UpscaleAnalyzer class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef UPSCALE_ANALYZER_H
+#define UPSCALE_ANALYZER_H
+
+#include "SampleAnalyzer.h"
+
+/// @brief Tests whether every sample's least significant byte is zero, as
+/// it is when a lower bit depth was padded to a higher one.
+///
+/// The file is assumed to be an upscale until a sample with a non-zero low
+/// byte disproves it, which for a natural recording is within the first
+/// few samples, and after that the analyzer is done.
+class UpscaleAnalyzer : public SampleAnalyzer
+{
+public:
+    /// @brief The number of low bits that must be zero in every sample.
+    static constexpr int LowByteBits{ 8 };
+
+    UpscaleAnalyzer() = default;
+
+    void Begin(const SampleFormat& format) override { isUpscaled = true; }
+
+    void Process(const SampleBlock& block) override;
+
+    bool IsDone() const override { return !isUpscaled; }
+
+    bool CanAppend() const override { return true; }
+
+    void Append(const SampleAnalyzer& next) override;
+
+    bool IsUpscaled() const { return isUpscaled; }
+private:
+    bool isUpscaled = false;
+};
+
+#endif
@@ -22,28 +22,38 @@
 #include <iostream>
 #include <memory>
 #include <filesystem>
+#include <vector>
+#include <cstdint>
 #include "LibCppBinary.h"
 #include "WaveFormat.h"
 #include "BitDepth.h"
 #include "ConversionMethod.h"
-#include "SampleConverter.h"
-#include "MediaFile.h"
 #include "LibCppLogging.h"
-#include "SampleDumper.h"
+#include "ChunkIndex.h"
+#include "PcmFile.h"
 
-class WaveFile : public MediaFile
+class WaveFile : public PcmFile
 {
 public:
     static constexpr int WaveFormatPcm{ 0x1 };
     static constexpr int WaveFormatExtensible{ 0xFFFE };
 
+    /// @brief Whether a data chunk size is a placeholder left by a writer
+    /// that couldn't seek back to fill it in, so the data runs to the end.
+    /// 0 only counts when the input is a stream of unknown length or the
+    /// RIFF size ends at the data chunk, since a real empty data chunk may
+    /// be followed by others such as LIST.
+    static bool IsPlaceholderSize(std::uint32_t dataSize,
+        std::uint32_t riffSize, std::uint64_t dataOffset,
+        std::uint64_t fileSize);
+
     WaveFile(std::string fileName, std::shared_ptr<Logging::Logger> logger);
 
     int BitsPerSample() const override { return format.bitsPerSample.Value(); }
 
     long SampleRate() const override { return format.sampleRate.Value(); }
 
-    bool IsOpen() const override { return readStream->IsOpen(); }
+    int Channels() const override { return format.channels.Value(); }
 
     void Open() override;
 
@@ -53,94 +63,42 @@ public:
 
     WaveFormat Format() const { return format; }
 
-    std::string FileName() const override { return fileName; }
-
-    void Analyze(bool dumpSamples) override;
+    /// @brief Locates the chunks other than 'fmt ' and 'data', in file order.
+    const ChunkIndex& OtherChunks() const { return otherChunks; }
 
-    void Convert(
+    bool Convert(
         std::string outputFileName, 
         BitDepth depth, 
         ConversionMethod method) override;
-
-    bool IsUpscaled() const override { return isUpscaled; }
 private:
-    bool isUpscaled;
-    std::string fileName;
     Binary::ChunkHeader riffChunkHeader;
     Binary::StringField riffFileType{ 4 };
     Binary::ChunkHeader formatHeader;
     Binary::ChunkHeader dataHeader;
     WaveFormat format;
-    std::vector<std::shared_ptr<Binary::DataField>> otherFields;
-    std::shared_ptr<Binary::RawFileStream> readStream;
-    std::shared_ptr<Binary::RawFileStream> writeStream;
-    std::shared_ptr<Logging::Logger> logger;
-    std::shared_ptr<SampleDumper> sampleDumper;
-
-    /*
-    RiffChunkHeader ReadChunkHeader();
-
-    RiffSubChunkHeader ReadSubChunkHeader();
-    */
-
-    WaveFormat ReadWaveFormat();
-
-    /*
-    void WriteChunkHeader(RiffChunkHeader header);
-
-    void WriteSubChunkHeader(RiffSubChunkHeader header);
-    */
-
-    void WriteFormatInfo(WaveFormat format);
-
-    template <typename T>
-    bool ConvertNext(ConversionMethod method, BitDepth depth)
-    {
-        T sample { 0 };
-        readStream->Read(&sample);
-        auto converter = SampleConverter<T>(method, depth);
-        std::shared_ptr<Binary::DataField> newSample = converter.Convert(sample);
-
-        if (newSample != nullptr)
-        {
-            writeStream->Write(newSample.get());
-            return true;
-        }
-        else
-        {
-            return false;
-        }
-    }
+    ChunkIndex otherChunks;
+
+    /// @brief The offset of the 'fmt ' chunk data, just past its header.
+    std::uint64_t formatOffset{ 0 };
+
+    void ReadBytes(void* data, size_t size);
+
+    void ReadChunkHeader(Binary::ChunkHeader& header);
+
+    void ReadWaveFormat();
+
+    void WriteChunkHeader(std::string id, std::uint32_t dataSize);
+
+    void WriteFormatInfo(WaveFormat& format);
 
     //RiffChunkHeader GetNewChunkHeader(long sizeIncrease);
 
     WaveFormat GetNewWaveFormat(BitDepth depth);
 
-    long CalculateNumberOfSamples();
-
-    long CalculateNewDataSize(BitDepth depth, long numberOfSamples);
-
-    template <typename T>
-    void AnalyzeNextSample(bool dumpSamples)
-    {
-        T sample{ 0 };
-        readStream->Read(&sample);
-
-        if (dumpSamples)
-        {
-            if (sampleDumper == nullptr)
-                sampleDumper = std::make_shared<SampleDumper>(fileName);
-
-            sampleDumper->Dump(&sample);
-        }
-        
-        // Perform a bitwise and against the bitmask 0xFF to select the bits in
-        // the least significant byte. If even one is of the least significant
-        // bytes is non-zero, the file is not likely to be an upscale
-        // conversion.
-        if ((sample.Value() & 0xFF) != 0)
-            isUpscaled = false;
-    }
+    /// @brief Whether the file is laid out exactly as Convert would write
+    /// it at depth: a 16 byte 'fmt ' chunk first, the other chunks after it
+    /// with nothing between them, and the data chunk last.
+    bool HasConvertedLayout(BitDepth depth);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,95 @@
+// WorkQueue.h - Declares the WorkQueue class template.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef WORK_QUEUE_H
+#define WORK_QUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <type_traits>
+#include <cstddef>
+
+/// @brief A bounded queue that hands work from producers to worker threads.
+///
+/// Push blocks while the queue is full, so a producer that can find work
+/// much faster than it is done, such as a directory walk over millions of
+/// files, never holds more than capacity items in memory.
+///
+/// Items are taken in the order they were pushed, unless a Compare is
+/// given, in which case the queue is a heap and Pop takes the greatest of
+/// the items waiting, such as the largest file. Only the items in the
+/// queue are ordered, so with a producer that keeps it full the order
+/// holds over a window of capacity items.
+template <typename T, typename Compare = void>
+class WorkQueue
+{
+public:
+    WorkQueue(size_t capacity) : capacity{ capacity }, isClosed{ false } { }
+
+    /// @brief Adds an item, waiting for room if the queue is full.
+    void Push(T item)
+    {
+        std::unique_lock<std::mutex> lock{ mutex };
+        notFull.wait(lock, [this] { return items.size() < capacity; });
+        items.push_back(std::move(item));
+        if constexpr (!std::is_void_v<Compare>)
+            std::push_heap(items.begin(), items.end(), Compare{ });
+        notEmpty.notify_one();
+    }
+
+    /// @brief Removes the next item, waiting for one if the queue is empty.
+    /// @return False once the queue is closed and every item is taken.
+    bool Pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock{ mutex };
+        notEmpty.wait(lock, [this] { return !items.empty() || isClosed; });
+        if (items.empty())
+            return false;
+
+        if constexpr (std::is_void_v<Compare>)
+        {
+            item = std::move(items.front());
+            items.pop_front();
+        }
+        else
+        {
+            std::pop_heap(items.begin(), items.end(), Compare{ });
+            item = std::move(items.back());
+            items.pop_back();
+        }
+        notFull.notify_one();
+        return true;
+    }
+
+    /// @brief Signals that no more items will be pushed.
+    void Close()
+    {
+        std::lock_guard<std::mutex> lock{ mutex };
+        isClosed = true;
+        notEmpty.notify_all();
+    }
+private:
+    size_t capacity;
+    bool isClosed;
+    std::deque<T> items;
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+};
+
+#endif
@@ -0,0 +1,338 @@
+// AiffFile.cpp - Defines the AiffFile class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <cstring>
+#include "AiffFile.h"
+
+static int BitsPerSampleOf(BitDepth depth)
+{
+    switch (depth)
+    {
+        case BitDepth::UInt8:
+            return 8;
+        case BitDepth::Int24:
+            return 24;
+        case BitDepth::Int32:
+            return 32;
+        default:
+            return 16;
+    }
+}
+
+AiffFile::AiffFile(
+    std::string fileName,
+    std::shared_ptr<Logging::Logger> logger) : PcmFile{ fileName, logger }
+{
+    this->compressionType = "NONE";
+    this->channels = 0;
+    this->sampleFrames = 0;
+    this->sampleSize = 0;
+    this->sampleRate = 0;
+    this->formSize = 0;
+    this->soundBlockSize = 0;
+    std::memset(sampleRateBytes, 0, sizeof(sampleRateBytes));
+
+    // AIFF 8-bit samples are two's complement, unlike WAVE.
+    this->hasSigned8BitSamples = true;
+}
+
+long AiffFile::DecodeSampleRate(const std::uint8_t* data)
+{
+    // A sign bit and 15-bit exponent biased by 16383, then a 64-bit mantissa
+    // with an explicit integer bit, so the value is mantissa * 2^(e - 63).
+    int exponent = DecodeBigEndian(data, 2) & 0x7FFF;
+    std::uint64_t mantissa =
+        static_cast<std::uint64_t>(DecodeBigEndian(data + 2, 4)) << 32 |
+        DecodeBigEndian(data + 6, 4);
+    if (exponent == 0 || mantissa == 0)
+        return 0;
+
+    return std::lround(std::ldexp(static_cast<double>(mantissa),
+                                  exponent - 16383 - 63));
+}
+
+void AiffFile::Open()
+{
+    if (!Exists())
+        logger->Write("File does not exist!", Logging::LogLevel::Error);
+
+    if (!OpenInput())
+    {
+        logger->Write("Unable to open file", Logging::LogLevel::Error);
+        return;
+    }
+
+    input->Seek(0);
+    std::uint8_t header[12];
+    ReadBytes(header, sizeof(header));
+    formType = std::string(reinterpret_cast<char*>(header + 8), 4);
+    if (std::memcmp(header, "FORM", 4) != 0 ||
+        (formType != "AIFF" && formType != "AIFC"))
+    {
+        throw MediaFormatError{ "Not an AIFF file" };
+    }
+
+    // Unlike WAVE, AIFF doesn't require the sound data to come last, so
+    // every chunk in the FORM is visited. Only COMM is read into memory;
+    // the rest, including the sound data, are seeked past. A stream would
+    // have to be read to its end to do that, with no way back to the sound.
+    if (input->Size() == 0)
+        throw MediaFormatError{ "AIFF files can't be read as a stream" };
+
+    formSize = DecodeBigEndian(header + 4, 4);
+    std::uint64_t formEnd = std::min<std::uint64_t>(
+        8 + formSize, input->Size());
+    otherChunks.clear();
+    bool commonFound = false;
+    bool soundFound = false;
+
+    while (input->Position() + 8 <= formEnd)
+    {
+        std::uint8_t chunkHeader[8];
+        ReadBytes(chunkHeader, sizeof(chunkHeader));
+
+        ChunkIndexEntry chunk;
+        chunk.id = std::string(reinterpret_cast<char*>(chunkHeader), 4);
+        chunk.offset = input->Position();
+        chunk.size = DecodeBigEndian(chunkHeader + 4, 4);
+
+        if (chunk.id == "COMM")
+        {
+            commonChunk = chunk;
+            ReadCommon(chunk);
+            commonFound = true;
+        }
+        else if (chunk.id == "SSND")
+        {
+            soundChunk = chunk;
+            ReadSoundDataHeader(chunk);
+            soundFound = true;
+        }
+        else
+        {
+            otherChunks.push_back(chunk);
+        }
+
+        input->Seek(chunk.offset + chunk.PaddedSize());
+    }
+
+    if (!commonFound)
+        throw MediaFormatError{ "AIFF file has no COMM chunk" };
+    if (!soundFound)
+        throw MediaFormatError{ "AIFF file has no SSND chunk" };
+}
+
+void AiffFile::ReadBytes(void* data, size_t size)
+{
+    if (input->Read(data, size) != size)
+        throw MediaFormatError{ "Unexpected end of AIFF file" };
+}
+
+void AiffFile::ReadCommon(const ChunkIndexEntry& chunk)
+{
+    if (chunk.size < CommonSize)
+        throw MediaFormatError{ "AIFF COMM chunk is too small" };
+
+    std::uint8_t bytes[CommonSize];
+    ReadBytes(bytes, sizeof(bytes));
+    channels = DecodeBigEndian(bytes, 2);
+    sampleFrames = DecodeBigEndian(bytes + 2, 4);
+    sampleSize = DecodeBigEndian(bytes + 6, 2);
+    std::memcpy(sampleRateBytes, bytes + 8, SampleRateSize);
+    sampleRate = DecodeSampleRate(sampleRateBytes);
+
+    if (sampleSize < 1 || sampleSize > 32)
+        throw MediaFormatError{ "Unsupported AIFF sample size" };
+
+    compressionType = "NONE";
+    compressionInfo.clear();
+    sampleOrder = Endianness::Big;
+    if (formType != "AIFC")
+        return;
+
+    // AIFF-C adds the compression type and a Pascal string naming it.
+    if (chunk.size < CommonSize + 4)
+        throw MediaFormatError{ "AIFF-C COMM chunk is too small" };
+
+    compressionInfo.resize(chunk.size - CommonSize);
+    ReadBytes(compressionInfo.data(), compressionInfo.size());
+    compressionType = std::string(
+        reinterpret_cast<char*>(compressionInfo.data()), 4);
+
+    if (compressionType == "sowt")
+        sampleOrder = Endianness::Little;
+    else if (compressionType != "NONE" && compressionType != "twos")
+        throw MediaFormatError{ "Unsupported AIFF-C compression type" };
+}
+
+void AiffFile::ReadSoundDataHeader(const ChunkIndexEntry& chunk)
+{
+    // The samples follow an offset and block size used to align them, and
+    // start offset bytes later still.
+    constexpr std::uint32_t headerSize{ 8 };
+    std::uint8_t bytes[headerSize];
+    if (chunk.size < headerSize)
+        throw MediaFormatError{ "AIFF SSND chunk is too small" };
+
+    ReadBytes(bytes, sizeof(bytes));
+    std::uint32_t offset = DecodeBigEndian(bytes, 4);
+    soundBlockSize = DecodeBigEndian(bytes + 4, 4);
+    if (chunk.size - headerSize < offset)
+        throw MediaFormatError{ "AIFF SSND offset is past the chunk" };
+
+    dataOffset = chunk.offset + headerSize + offset;
+    dataSize = chunk.size - headerSize - offset;
+}
+
+void AiffFile::WriteChunkHeader(std::string id, std::uint32_t dataSize)
+{
+    std::uint8_t bytes[8];
+    id.copy(reinterpret_cast<char*>(bytes), 4);
+    EncodeBigEndian(dataSize, bytes + 4, 4);
+    writer->Write(bytes, sizeof(bytes));
+}
+
+void AiffFile::WriteCommon(BitDepth depth)
+{
+    std::uint8_t bytes[CommonSize];
+    EncodeBigEndian(channels, bytes, 2);
+    EncodeBigEndian(sampleFrames, bytes + 2, 4);
+    EncodeBigEndian(BitsPerSampleOf(depth), bytes + 6, 2);
+    std::memcpy(bytes + 8, sampleRateBytes, SampleRateSize);
+    writer->Write(bytes, sizeof(bytes));
+
+    if (!compressionInfo.empty())
+        writer->Write(compressionInfo.data(), compressionInfo.size());
+    if (compressionInfo.size() & 1)
+    {
+        std::uint8_t pad{ 0 };
+        writer->Write(&pad, 1);
+    }
+}
+
+bool AiffFile::HasConvertedLayout(BitDepth depth) const
+{
+    constexpr std::uint64_t chunkHeaderSize{ 8 };
+    constexpr std::uint64_t soundHeaderSize{ 8 };
+    std::uint64_t commonSize = CommonSize + compressionInfo.size();
+    if (commonChunk.offset != 12 + chunkHeaderSize ||
+        commonChunk.size != commonSize ||
+        sampleSize != BitsPerSampleOf(depth))
+        return false;
+
+    // Other chunks after SSND fail this too, as Convert moves them before.
+    std::uint64_t end = commonChunk.offset + commonChunk.PaddedSize();
+    for (const ChunkIndexEntry& chunk : otherChunks)
+    {
+        if (chunk.offset != end + chunkHeaderSize)
+            return false;
+        end = chunk.offset + chunk.PaddedSize();
+    }
+
+    std::uint64_t soundEnd = soundChunk.offset + soundChunk.PaddedSize();
+    return soundChunk.offset == end + chunkHeaderSize &&
+           dataOffset == soundChunk.offset + soundHeaderSize &&
+           soundBlockSize == 0 &&
+           formSize == soundEnd - chunkHeaderSize &&
+           reader->Size() == soundEnd;
+}
+
+bool AiffFile::Convert(
+    std::string outputFileName,
+    BitDepth depth,
+    ConversionMethod method)
+{
+    if (!OpenWriter(outputFileName))
+        return false;
+
+    long numberOfSamples = CalculateNumberOfSamples();
+    long newDataSize = CalculateNewDataSize(depth, numberOfSamples);
+
+    // As with WAVE, a direct copy to the same depth of a file already laid
+    // out as below is the input as-is.
+    if (method == ConversionMethod::DirectCopy &&
+        static_cast<std::uint64_t>(newDataSize) == dataSize &&
+        HasConvertedLayout(depth))
+    {
+        if (!writer->CloneFrom(*reader) || !writer->Close())
+        {
+            logger->Write("Unable to copy file", Logging::LogLevel::Error);
+            return false;
+        }
+        return true;
+    }
+
+    // The FORM size covers the form type, the COMM chunk, each copied chunk
+    // and the SSND chunk, whose samples we write without an offset.
+    constexpr std::uint64_t chunkHeaderSize{ 8 };
+    constexpr std::uint64_t soundHeaderSize{ 8 };
+    std::uint32_t commonSize = CommonSize + compressionInfo.size();
+    std::uint64_t newFormSize = 4 + chunkHeaderSize + commonSize +
+                                (commonSize & 1);
+    for (const ChunkIndexEntry& chunk : otherChunks)
+        newFormSize += chunkHeaderSize + chunk.PaddedSize();
+    newFormSize += chunkHeaderSize + soundHeaderSize + newDataSize +
+                   (newDataSize & 1);
+
+    WriteChunkHeader("FORM", newFormSize);
+    writer->Write(formType.data(), 4);
+    WriteChunkHeader("COMM", commonSize);
+    WriteCommon(depth);
+
+    for (const ChunkIndexEntry& chunk : otherChunks)
+    {
+        WriteChunkHeader(chunk.id, chunk.size);
+        if (!writer->WriteFrom(*reader, chunk.offset, chunk.PaddedSize()))
+        {
+            logger->Write("Unable to copy chunk", Logging::LogLevel::Error);
+            return false;
+        }
+    }
+
+    WriteChunkHeader("SSND", soundHeaderSize + newDataSize);
+    std::uint8_t soundHeader[soundHeaderSize]{ };
+    writer->Write(soundHeader, sizeof(soundHeader));
+
+    // As with WAVE, a direct copy keeps samples at their depth as they are.
+    if (method == ConversionMethod::DirectCopy &&
+        newDataSize == numberOfSamples * BytesPerSample())
+    {
+        if (!writer->WriteFrom(*reader, dataOffset, newDataSize))
+        {
+            logger->Write("Unable to copy samples", Logging::LogLevel::Error);
+            return false;
+        }
+    }
+    else if (!WriteConvertedSamples(method, depth))
+    {
+        logger->Write("Unable to convert samples", Logging::LogLevel::Error);
+        return false;
+    }
+
+    if (newDataSize & 1)
+    {
+        std::uint8_t pad{ 0 };
+        writer->Write(&pad, 1);
+    }
+
+    if (!writer->Close())
+    {
+        logger->Write("Unable to write output file", Logging::LogLevel::Error);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,74 @@
+// AnalysisControl.cpp - Defines the AnalysisControl and ControlledSource
+// class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "AnalysisControl.h"
+
+void AnalysisControl::Pause()
+{
+    std::lock_guard<std::mutex> lock{ mutex };
+    paused.store(true, std::memory_order_release);
+}
+
+void AnalysisControl::Resume()
+{
+    std::lock_guard<std::mutex> lock{ mutex };
+    paused.store(false, std::memory_order_release);
+    resumed.notify_all();
+}
+
+void AnalysisControl::Cancel()
+{
+    std::lock_guard<std::mutex> lock{ mutex };
+    cancelled.store(true, std::memory_order_release);
+    paused.store(false, std::memory_order_release);
+    resumed.notify_all();
+}
+
+bool AnalysisControl::WaitWhilePaused()
+{
+    // Reads check this for every block, so the lock is only taken when
+    // there is something to wait for.
+    if (IsPaused())
+    {
+        std::unique_lock<std::mutex> lock{ mutex };
+        resumed.wait(lock, [this] { return !IsPaused(); });
+    }
+
+    return !IsCancelled();
+}
+
+ControlledSource::ControlledSource(
+    std::shared_ptr<ByteSource> source, 
+    AnalysisControl* control, 
+    ReadHandler handler) :
+    source{ source },
+    control{ control },
+    handler{ handler }
+{ }
+
+size_t ControlledSource::Read(void* data, size_t size)
+{
+    if (control != nullptr && !control->WaitWhilePaused())
+        return 0;
+
+    size_t count = source->Read(data, size);
+    bytesRead += count;
+    if (handler)
+        handler(bytesRead);
+
+    return count;
+}
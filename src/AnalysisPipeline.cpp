@@ -0,0 +1,201 @@
+// AnalysisPipeline.cpp - Defines the AnalysisPipeline class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <typeinfo>
+#include "AnalysisPipeline.h"
+
+void AnalysisPipeline::Add(std::shared_ptr<SampleAnalyzer> analyzer)
+{
+    if (analyzer != nullptr)
+        analyzers.push_back(analyzer);
+}
+
+void AnalysisPipeline::Clear()
+{
+    End();
+    analyzers.clear();
+    active.clear();
+    hasBegun = false;
+}
+
+void AnalysisPipeline::Begin(const SampleFormat& format)
+{
+    End();
+    this->format = format;
+    hasBegun = true;
+
+    active.clear();
+    for (const std::shared_ptr<SampleAnalyzer>& analyzer : analyzers)
+    {
+        analyzer->Begin(format);
+        active.push_back(analyzer.get());
+    }
+    DropFinished(active);
+
+    if (ringSettings.analysisThreads > 0 && format.channels > 0 && 
+        !active.empty())
+    {
+        StartWorkers();
+    }
+}
+
+void AnalysisPipeline::Process(const SampleBlock& block)
+{
+    if (block.channelCount != format.channels || block.frameCount == 0)
+        return;
+
+    if (ring != nullptr)
+    {
+        if (!IsDone())
+            ring->Push(block);
+        return;
+    }
+
+    bool anyFinished{ false };
+    for (SampleAnalyzer* analyzer : active)
+    {
+        analyzer->Process(block);
+        anyFinished = anyFinished || analyzer->IsDone();
+    }
+
+    if (anyFinished)
+        DropFinished(active);
+}
+
+void AnalysisPipeline::End()
+{
+    if (ring == nullptr)
+        return;
+
+    ring->Close();
+    for (Worker& worker : workers)
+    {
+        if (worker.thread.joinable())
+            worker.thread.join();
+
+        // What the threads didn't finish is back on this thread, so IsDone
+        // still reflects it.
+        active.insert(active.end(), worker.analyzers.begin(), 
+                      worker.analyzers.end());
+    }
+
+    ringStats = ring->Stats();
+    workers.clear();
+    ring.reset();
+}
+
+bool AnalysisPipeline::IsDone() const
+{
+    if (ring != nullptr)
+        return finishedWorkers.load(std::memory_order_acquire) == 
+               workers.size();
+
+    return hasBegun && active.empty();
+}
+
+bool AnalysisPipeline::CanAppend() const
+{
+    return std::all_of(analyzers.begin(), analyzers.end(),
+                       [](const std::shared_ptr<SampleAnalyzer>& analyzer)
+                       { return analyzer->CanAppend(); });
+}
+
+void AnalysisPipeline::Prime(const SampleBlock& block)
+{
+    if (block.channelCount != format.channels || block.frameCount == 0)
+        return;
+
+    // Nothing has been pushed to the analysis threads yet, so the analyzers
+    // are still free to be primed from this one.
+    for (const std::shared_ptr<SampleAnalyzer>& analyzer : analyzers)
+        analyzer->Prime(block);
+}
+
+bool AnalysisPipeline::Append(const AnalysisPipeline& next)
+{
+    if (next.analyzers.size() != analyzers.size() || !CanAppend())
+        return false;
+
+    for (size_t i = 0; i < analyzers.size(); i++)
+    {
+        const SampleAnalyzer& first = *analyzers[i];
+        const SampleAnalyzer& second = *next.analyzers[i];
+        if (typeid(first) != typeid(second))
+            return false;
+    }
+
+    for (size_t i = 0; i < analyzers.size(); i++)
+        analyzers[i]->Append(*next.analyzers[i]);
+    return true;
+}
+
+void AnalysisPipeline::StartWorkers()
+{
+    size_t workerCount = std::min<size_t>(ringSettings.analysisThreads, 
+                                          active.size());
+    ring = std::make_unique<SampleRing>(ringSettings, format.channels, 
+                                        static_cast<int>(workerCount));
+    ringStats = SampleRingStats{ };
+    finishedWorkers.store(0, std::memory_order_relaxed);
+
+    // The analyzers are dealt out in turn, so each thread has a share.
+    workers = std::vector<Worker>(workerCount);
+    for (size_t i = 0; i < active.size(); i++)
+        workers[i % workerCount].analyzers.push_back(active[i]);
+    active.clear();
+
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        workers[i].thread = std::thread(&AnalysisPipeline::RunWorker, this, 
+                                        static_cast<int>(i));
+    }
+}
+
+void AnalysisPipeline::RunWorker(int index)
+{
+    std::vector<SampleAnalyzer*>& running = workers[index].analyzers;
+    while (!running.empty())
+    {
+        const SampleBlock* block = ring->Acquire(index);
+        if (block == nullptr)
+            break;
+
+        bool anyFinished{ false };
+        for (SampleAnalyzer* analyzer : running)
+        {
+            analyzer->Process(*block);
+            anyFinished = anyFinished || analyzer->IsDone();
+        }
+        ring->Release(index);
+
+        if (anyFinished)
+            DropFinished(running);
+    }
+
+    if (running.empty())
+        finishedWorkers.fetch_add(1, std::memory_order_release);
+    ring->Detach(index);
+}
+
+void AnalysisPipeline::DropFinished(std::vector<SampleAnalyzer*>& analyzers)
+{
+    analyzers.erase(
+        std::remove_if(analyzers.begin(), analyzers.end(),
+                       [](SampleAnalyzer* analyzer)
+                       { return analyzer->IsDone(); }),
+        analyzers.end());
+}
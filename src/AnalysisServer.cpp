@@ -0,0 +1,575 @@
+// AnalysisServer.cpp - Defines the AnalysisServer class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sstream>
+#include <filesystem>
+#include <cerrno>
+#include <cstring>
+#include "AnalysisServer.h"
+
+// The server listens on a Unix domain socket, so it is left out of builds
+// for Windows, where Program::Serve says it isn't supported.
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "InventoryWriter.h"
+#include "MediaFile.h"
+
+// Writing to a client that has gone away must fail rather than raise
+// SIGPIPE. macOS has no MSG_NOSIGNAL, so it sets SO_NOSIGPIPE on each
+// client socket instead.
+#ifdef MSG_NOSIGNAL
+static constexpr int SendFlags{ MSG_NOSIGNAL };
+#else
+static constexpr int SendFlags{ 0 };
+#endif
+
+/// @brief Finds the size and modification time of a file, which say
+/// whether a cached result still describes it.
+static bool StatFile(
+    const std::string& path, 
+    std::uint64_t& size, 
+    std::int64_t& modified)
+{
+    struct stat status;
+    if (::stat(path.c_str(), &status) != 0 || !S_ISREG(status.st_mode))
+        return false;
+
+    size = static_cast<std::uint64_t>(status.st_size);
+#ifdef __APPLE__
+    const timespec& time = status.st_mtimespec;
+#else
+    const timespec& time = status.st_mtim;
+#endif
+    modified = static_cast<std::int64_t>(time.tv_sec) * 1000000000 + 
+               time.tv_nsec;
+    return true;
+}
+
+/// @brief Keeps a socket from being inherited by programs the server
+/// starts. SOCK_CLOEXEC and accept4 would do it in one call, but aren't
+/// available everywhere.
+static int CloseOnExec(int descriptor)
+{
+    if (descriptor >= 0)
+        ::fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+    return descriptor;
+}
+
+static int OpenSocket()
+{
+    return CloseOnExec(::socket(AF_UNIX, SOCK_STREAM, 0));
+}
+
+static int AcceptClient(int listener)
+{
+    int client = CloseOnExec(::accept(listener, nullptr, nullptr));
+#ifdef SO_NOSIGPIPE
+    if (client >= 0)
+    {
+        int on{ 1 };
+        ::setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+    }
+#endif
+    return client;
+}
+
+static std::vector<std::string> SplitFields(const std::string& line)
+{
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (true)
+    {
+        size_t end = line.find('\t', start);
+        fields.push_back(line.substr(start, end - start));
+        if (end == std::string::npos)
+            return fields;
+        start = end + 1;
+    }
+}
+
+static std::string ErrorResponse(const std::string& message)
+{
+    return "{\"error\":" + QuoteJson(message) + "}";
+}
+
+/// @brief Sends a line, retrying until all of it is sent.
+static bool SendLine(int client, const std::string& text)
+{
+    std::string line = text + '\n';
+    size_t sent = 0;
+    while (sent < line.size())
+    {
+        ssize_t count = ::send(client, line.data() + sent, line.size() - sent,
+                               SendFlags);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            return false;
+        sent += static_cast<size_t>(count);
+    }
+    return true;
+}
+
+/// @brief The inventory row of a result, without its line break.
+template <typename Result>
+static std::string InventoryRow(const Result& result)
+{
+    std::stringstream row;
+    InventoryWriter writer{ row, InventoryFormat::Ndjson, true };
+    writer.Write(result);
+    std::string text = row.str();
+    if (!text.empty() && text.back() == '\n')
+        text.pop_back();
+    return text;
+}
+
+AnalysisServer::AnalysisServer(
+    ServerSettings settings, 
+    std::shared_ptr<Logging::Logger> logger) :
+    settings{ settings },
+    logger{ logger },
+    jobs{ std::max(1u, settings.workerCount) * 64 }
+{ }
+
+AnalysisServer::~AnalysisServer()
+{
+    if (listener >= 0 || !workers.empty())
+    {
+        Stop();
+        Shutdown();
+    }
+}
+
+bool AnalysisServer::Start()
+{
+    sockaddr_un address{ };
+    address.sun_family = AF_UNIX;
+    if (settings.socketPath.empty() || 
+        settings.socketPath.size() >= sizeof(address.sun_path))
+    {
+        logger->Write("Invalid socket path", Logging::LogLevel::Error);
+        return false;
+    }
+    std::strncpy(address.sun_path, settings.socketPath.c_str(), 
+                 sizeof(address.sun_path) - 1);
+
+    int descriptor = OpenSocket();
+    if (descriptor < 0)
+    {
+        logger->Write("Unable to create socket", Logging::LogLevel::Error);
+        return false;
+    }
+
+    // A socket left behind by a server that didn't shut down cleanly would
+    // make bind fail, but one that still answers belongs to a running
+    // server and is left alone.
+    std::error_code error;
+    if (std::filesystem::is_socket(settings.socketPath, error))
+    {
+        int probe = OpenSocket();
+        bool inUse = probe >= 0 && ::connect(
+            probe, reinterpret_cast<sockaddr*>(&address), 
+            sizeof(address)) == 0;
+        if (probe >= 0)
+            ::close(probe);
+
+        if (!inUse)
+            std::filesystem::remove(settings.socketPath, error);
+    }
+
+    if (::bind(descriptor, reinterpret_cast<sockaddr*>(&address), 
+               sizeof(address)) != 0 ||
+        ::listen(descriptor, SOMAXCONN) != 0)
+    {
+        std::stringstream message;
+        message << "Unable to listen on " << settings.socketPath << ": " 
+                << std::strerror(errno);
+        logger->Write(message.str(), Logging::LogLevel::Error);
+        ::close(descriptor);
+        return false;
+    }
+
+    listener.store(descriptor);
+
+    for (unsigned int i = 0; i < std::max(1u, settings.workerCount); i++)
+        workers.emplace_back(&AnalysisServer::RunWorker, this);
+
+    return true;
+}
+
+void AnalysisServer::Run()
+{
+    while (!stopping.load(std::memory_order_acquire))
+    {
+        int client = AcceptClient(listener.load());
+        if (client < 0)
+        {
+            // Interrupted by a signal, which may have been a Stop, or a
+            // client that gave up before it was accepted.
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{ clientsMutex };
+            clients.insert(client);
+        }
+        connections++;
+        std::thread{ &AnalysisServer::Serve, this, client }.detach();
+    }
+
+    Shutdown();
+}
+
+void AnalysisServer::Stop()
+{
+    // Both are safe in a signal handler; shutting down the listener wakes
+    // the accept in Run.
+    stopping.store(true, std::memory_order_release);
+    int descriptor = listener.load();
+    if (descriptor >= 0)
+        ::shutdown(descriptor, SHUT_RDWR);
+}
+
+ServerStats AnalysisServer::Stats() const
+{
+    ServerStats stats;
+    stats.connections = connections;
+    stats.requests = requests;
+    stats.cacheHits = cacheHits;
+    stats.filesAnalyzed = filesAnalyzed;
+    stats.filesConverted = filesConverted;
+    return stats;
+}
+
+void AnalysisServer::Serve(int client)
+{
+    std::string pending;
+    char buffer[4096];
+    bool open = true;
+    while (open)
+    {
+        ssize_t count = ::recv(client, buffer, sizeof(buffer), 0);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            break;
+
+        pending.append(buffer, static_cast<size_t>(count));
+        size_t start = 0;
+        size_t end;
+        while (open && (end = pending.find('\n', start)) != std::string::npos)
+        {
+            std::string line = pending.substr(start, end - start);
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            start = end + 1;
+            open = HandleRequest(client, line);
+        }
+        pending.erase(0, start);
+
+        if (pending.size() > MaxRequestSize)
+        {
+            SendLine(client, ErrorResponse("Request too long"));
+            break;
+        }
+    }
+
+    // Removed before closing, so Shutdown can't shut down a socket number
+    // that has since been reused. Nothing of the server is touched once the
+    // lock is released, as Shutdown may then return.
+    std::lock_guard<std::mutex> lock{ clientsMutex };
+    clients.erase(client);
+    ::close(client);
+    clientsClosed.notify_all();
+}
+
+bool AnalysisServer::HandleRequest(int client, const std::string& line)
+{
+    if (line.empty())
+        return true;
+
+    requests++;
+    std::vector<std::string> fields = SplitFields(line);
+    const std::string& command = fields[0];
+
+    if (command == "analyze" && fields.size() == 2)
+        return HandleAnalyze(client, fields[1]);
+
+    if (command == "convert" && (fields.size() == 4 || fields.size() == 5))
+    {
+        auto job = std::make_shared<Job>();
+        job->fields = fields;
+        if (!RunJob(client, job, 0))
+            return false;
+        return SendLine(client, job->response);
+    }
+
+    if (command == "probe" && fields.size() == 2)
+        return SendLine(client, InventoryRow(ProbeMediaFile(fields[1])));
+
+    if (command == "stats" && fields.size() == 1)
+        return SendLine(client, StatsResponse());
+
+    if (command == "ping" && fields.size() == 1)
+        return SendLine(client, "{\"pong\":true}");
+
+    return SendLine(client, ErrorResponse("Unknown request: " + command));
+}
+
+bool AnalysisServer::HandleAnalyze(int client, const std::string& path)
+{
+    std::uint64_t size{ 0 };
+    std::int64_t modified{ 0 };
+    bool exists = StatFile(path, size, modified);
+
+    std::string response;
+    if (exists && FindCached(path, size, modified, response))
+    {
+        cacheHits++;
+        return SendLine(client, response);
+    }
+
+    auto job = std::make_shared<Job>();
+    job->fields = { "analyze", path };
+    if (!RunJob(client, job, size))
+        return false;
+
+    // Cached under the size and time from before it was read, so a file
+    // changed during the analysis is analyzed again next time.
+    if (exists)
+        AddCached(path, size, modified, job->response);
+
+    return SendLine(client, job->response);
+}
+
+bool AnalysisServer::RunJob(
+    int client, 
+    std::shared_ptr<Job> job, 
+    std::uint64_t total)
+{
+    jobs.Push(job);
+
+    std::uint64_t reported{ 0 };
+    std::unique_lock<std::mutex> lock{ job->mutex };
+    while (!job->finished.wait_for(lock, ProgressInterval, 
+                                   [&job] { return job->done; }))
+    {
+        if (job->bytesRead == reported)
+            continue;
+
+        reported = job->bytesRead;
+        std::stringstream progress;
+        progress << "{\"progress\":{\"path\":" << QuoteJson(job->fields[1])
+                 << ",\"bytes_read\":" << reported 
+                 << ",\"file_size\":" << total << "}}";
+
+        // The job carries on without us if the client has gone; the
+        // worker holds its own reference to it.
+        lock.unlock();
+        if (!SendLine(client, progress.str()))
+            return false;
+        lock.lock();
+    }
+
+    return true;
+}
+
+void AnalysisServer::RunWorker()
+{
+    // Errors are reported through the responses, so the files themselves
+    // write to a logger with no channels.
+    auto fileLogger = std::make_shared<Logging::Logger>();
+
+    std::shared_ptr<Job> job;
+    while (jobs.Pop(job))
+    {
+        std::string response = job->fields[0] == "convert" 
+            ? Convert(*job, fileLogger) 
+            : Analyze(*job, fileLogger);
+
+        {
+            std::lock_guard<std::mutex> lock{ job->mutex };
+            job->response = response;
+            job->done = true;
+        }
+        job->finished.notify_all();
+        job = nullptr;
+    }
+}
+
+std::string AnalysisServer::Analyze(
+    Job& job, 
+    std::shared_ptr<Logging::Logger> logger)
+{
+    BatchResult result = AnalyzeMediaFile(
+        job.fields[1], settings.batch, logger, 
+        [&job](std::uint64_t bytesRead)
+        {
+            std::lock_guard<std::mutex> lock{ job.mutex };
+            job.bytesRead = bytesRead;
+        });
+
+    filesAnalyzed++;
+    return InventoryRow(result);
+}
+
+std::string AnalysisServer::Convert(
+    Job& job, 
+    std::shared_ptr<Logging::Logger> logger)
+{
+    const std::string& input = job.fields[1];
+    const std::string& output = job.fields[2];
+    const std::string& bits = job.fields[3];
+
+    BitDepth depth;
+    if (bits == "8")
+        depth = BitDepth::UInt8;
+    else if (bits == "16")
+        depth = BitDepth::Int16;
+    else if (bits == "24")
+        depth = BitDepth::Int24;
+    else if (bits == "32")
+        depth = BitDepth::Int32;
+    else
+        return ErrorResponse("Unsupported bit depth: " + bits);
+
+    ConversionMethod method = ConversionMethod::LinearScaling;
+    if (job.fields.size() == 5)
+    {
+        if (job.fields[4] == "directcopy")
+            method = ConversionMethod::DirectCopy;
+        else if (job.fields[4] != "linearscale")
+            return ErrorResponse("Unknown method: " + job.fields[4]);
+    }
+
+    std::shared_ptr<MediaFile> file = CreateMediaFile(input, logger);
+    if (file == nullptr)
+        return ErrorResponse("Unsupported file type");
+
+    try
+    {
+        file->Open();
+        if (!file->IsOpen())
+            return ErrorResponse("Unable to open file");
+
+        if (!file->Convert(output, depth, method))
+            return ErrorResponse("Unable to convert file");
+    }
+    catch (const MediaFormatError& error)
+    {
+        return ErrorResponse(error.what());
+    }
+
+    filesConverted++;
+    return "{\"converted\":" + QuoteJson(output) + "}";
+}
+
+std::string AnalysisServer::StatsResponse() const
+{
+    ServerStats stats = Stats();
+    std::stringstream response;
+    response << "{\"connections\":" << stats.connections
+             << ",\"requests\":" << stats.requests
+             << ",\"cache_hits\":" << stats.cacheHits
+             << ",\"files_analyzed\":" << stats.filesAnalyzed
+             << ",\"files_converted\":" << stats.filesConverted << "}";
+    return response.str();
+}
+
+bool AnalysisServer::FindCached(
+    const std::string& path, 
+    std::uint64_t size, 
+    std::int64_t modified, 
+    std::string& response)
+{
+    std::lock_guard<std::mutex> lock{ cacheMutex };
+    auto entry = cache.find(path);
+    if (entry == cache.end() || entry->second.size != size || 
+        entry->second.modified != modified)
+    {
+        return false;
+    }
+
+    cacheAges.splice(cacheAges.begin(), cacheAges, entry->second.age);
+    response = entry->second.response;
+    return true;
+}
+
+void AnalysisServer::AddCached(
+    const std::string& path, 
+    std::uint64_t size, 
+    std::int64_t modified, 
+    const std::string& response)
+{
+    if (settings.cacheCapacity == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock{ cacheMutex };
+    auto entry = cache.find(path);
+    if (entry != cache.end())
+    {
+        cacheAges.splice(cacheAges.begin(), cacheAges, entry->second.age);
+    }
+    else
+    {
+        if (cache.size() >= settings.cacheCapacity)
+        {
+            cache.erase(cacheAges.back());
+            cacheAges.pop_back();
+        }
+
+        cacheAges.push_front(path);
+        entry = cache.emplace(path, CachedResult{ }).first;
+        entry->second.age = cacheAges.begin();
+    }
+
+    entry->second.size = size;
+    entry->second.modified = modified;
+    entry->second.response = response;
+}
+
+void AnalysisServer::Shutdown()
+{
+    // Ending the connections' reads lets them answer the request they are
+    // on, if any, and close.
+    {
+        std::unique_lock<std::mutex> lock{ clientsMutex };
+        for (int client : clients)
+            ::shutdown(client, SHUT_RD);
+        clientsClosed.wait(lock, [this] { return clients.empty(); });
+    }
+
+    jobs.Close();
+    for (std::thread& worker : workers)
+        worker.join();
+    workers.clear();
+
+    int descriptor = listener.exchange(-1);
+    if (descriptor >= 0)
+    {
+        ::close(descriptor);
+        std::error_code error;
+        std::filesystem::remove(settings.socketPath, error);
+    }
+}
+
+#endif
@@ -18,33 +18,140 @@
 
 wxThread::ExitCode AnalysisThread::Entry()
 {
-    int fileIndex{ 0 };
-    for (std::shared_ptr<MediaFile> file : fileList)
+    // Sizing the files only takes a stat each, where opening them to find
+    // their sample data would take a descriptor and a header read.
+    totalBytes = 0;
+    fileSizes.assign(paths.size(), 0);
+    for (size_t row = 0; row < paths.size(); row++)
     {
-        int percentage = ((float)fileIndex / (float)fileList.size()) * 100.0;
-        std::filesystem::path filePath{ file->FileName() };
-        std::stringstream status;
-        status << "Analyzing " << filePath.filename().string() 
-               << " (" << fileIndex + 1 << " of " << fileList.size() << ", "
-               << percentage << "%)";
-
-        wxCommandEvent statusUpdateEvent
-        {
-             wxEVT_COMMAND_TEXT_UPDATED, StatusUpdateID 
-        };
-        statusUpdateEvent.SetInt(percentage);
-        statusUpdateEvent.SetString(status.str());
-        parent->GetEventHandler()->AddPendingEvent(statusUpdateEvent);
+        std::error_code error;
+        std::uint64_t size = std::filesystem::file_size(paths[row], error);
+        if (!error)
+            fileSizes[row] = size;
+        totalBytes += fileSizes[row];
+    }
 
-        file->Analyze(false);
-        fileIndex++;
+    lastStatus = Clock::time_point{ };
+    lastResults = Clock::now();
+    std::uint64_t bytesDone{ 0 };
+    for (size_t row = 0; row < paths.size(); row++)
+    {
+        if (!control->WaitWhilePaused())
+            break;
+
+        PostStatus(row, bytesDone, false);
+        FileResult result = AnalyzeFile(row, bytesDone);
+
+        // The file's results are incomplete if it was cancelled part way.
+        if (control->IsCancelled())
+            break;
+
+        bytesDone += fileSizes[row];
+        results.push_back(result);
+        PostResults(false);
     }
 
+    PostResults(true);
+
     wxCommandEvent statusCompleteEvent
     {
             wxEVT_COMMAND_TEXT_UPDATED, StatusCompleteID 
     };
+    statusCompleteEvent.SetInt(control->IsCancelled() ? 1 : 0);
     parent->GetEventHandler()->AddPendingEvent(statusCompleteEvent);
 
     return 0;
-}
\ No newline at end of file
+}
+
+FileResult AnalysisThread::AnalyzeFile(size_t row, std::uint64_t bytesBefore)
+{
+    FileResult result;
+    result.row = row;
+    result.verdict = FileVerdict::Failed;
+
+    std::shared_ptr<MediaFile> file = CreateMediaFile(paths[row], logger);
+    if (file == nullptr)
+        return result;
+
+    try
+    {
+        file->Open();
+        if (!file->IsOpen())
+            return result;
+
+        ByteRange range = file->AnalysisRange();
+        auto reader = std::make_shared<FileReader>(paths[row]);
+        reader->Open();
+        if (!reader->IsOpen() || !reader->Seek(range.offset))
+            return result;
+
+        // Counted from the start of the file, as the total is of whole
+        // files.
+        std::uint64_t fileSize = fileSizes[row];
+        auto source = std::make_shared<ControlledSource>(
+            reader, control.get(), [&](std::uint64_t bytesRead)
+            {
+                std::uint64_t position = range.offset + bytesRead;
+                PostStatus(row, bytesBefore + std::min(position, fileSize), 
+                           false);
+            });
+
+        file->SetAnalysisSource(source);
+        file->Analyze(false);
+        result.bitsPerSample = file->BitsPerSample();
+        result.sampleRate = file->SampleRate();
+        result.verdict = ClassifyFile(*file);
+    }
+    catch (const MediaFormatError&)
+    {
+        result.verdict = FileVerdict::Failed;
+    }
+
+    return result;
+}
+
+void AnalysisThread::PostStatus(
+    size_t row, 
+    std::uint64_t bytesDone, 
+    bool force)
+{
+    Clock::time_point now = Clock::now();
+    if (!force && now - lastStatus < PostInterval)
+        return;
+
+    lastStatus = now;
+    int percentage = totalBytes > 0 
+        ? static_cast<int>(bytesDone * 100 / totalBytes) : 0;
+    std::filesystem::path filePath{ paths[row] };
+    std::stringstream status;
+    status << "Analyzing " << filePath.filename().string() 
+           << " (" << row + 1 << " of " << paths.size() << ", "
+           << percentage << "%)";
+
+    wxCommandEvent statusUpdateEvent
+    {
+         wxEVT_COMMAND_TEXT_UPDATED, StatusUpdateID 
+    };
+    statusUpdateEvent.SetInt(percentage);
+    statusUpdateEvent.SetString(status.str());
+    parent->GetEventHandler()->AddPendingEvent(statusUpdateEvent);
+}
+
+void AnalysisThread::PostResults(bool force)
+{
+    if (results.empty())
+        return;
+
+    Clock::time_point now = Clock::now();
+    if (!force && results.size() < ResultBatchSize && 
+        now - lastResults < PostInterval)
+    {
+        return;
+    }
+
+    lastResults = now;
+    wxThreadEvent resultsEvent{ wxEVT_THREAD, StatusResultsID };
+    resultsEvent.SetPayload(results);
+    parent->GetEventHandler()->QueueEvent(resultsEvent.Clone());
+    results.clear();
+}
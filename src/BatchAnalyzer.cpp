@@ -0,0 +1,612 @@
+// BatchAnalyzer.cpp - Defines the BatchAnalyzer class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <mutex>
+#include <filesystem>
+#include "BatchAnalyzer.h"
+#include "BlockPrefetcher.h"
+#include "FileEnumerator.h"
+#include "MediaFile.h"
+#include "FlacFile.h"
+#include "FileReader.h"
+#include "MemorySource.h"
+#include "DescriptorSource.h"
+#include "StreamSource.h"
+#include "WorkQueue.h"
+
+/// @brief A large file that is analyzed in parts by whichever workers are
+/// free, and put back together as the parts finish.
+struct SplitFile
+{
+    ProbeResult probe;
+    size_t partCount = 0;
+
+    /// @brief The frames in each part but the last, which takes the rest.
+    std::uint64_t partFrames = 0;
+
+    /// @brief The frames before each part that prime its analyzers.
+    std::uint64_t leadInFrames = 0;
+
+    std::mutex mutex;
+
+    /// @brief The analyzed parts. The first gathers the results of the
+    /// others, in order, as soon as each can be joined to it, after which
+    /// that part is released.
+    std::vector<std::shared_ptr<MediaFile>> parts;
+    std::vector<bool> finished;
+    size_t joinedCount = 0;
+    size_t remaining = 0;
+
+    /// @brief The first error any part had, which becomes the file's.
+    std::string error;
+};
+
+/// @brief A file, or a part of one, waiting for a worker.
+struct BatchTask
+{
+    std::string fileName;
+
+    /// @brief The bytes the task reads, which the queue takes largest first.
+    std::uint64_t size = 0;
+
+    /// @brief The order the task was queued in, which breaks ties in size,
+    /// so a file's parts are taken in order and can be joined as they go.
+    std::uint64_t sequence = 0;
+
+    /// @brief The file the task is a part of, or nullptr for a whole file.
+    std::shared_ptr<SplitFile> split;
+    size_t part = 0;
+};
+
+/// @brief Orders the work queue, whose greatest task is taken first.
+struct TaskPriority
+{
+    bool operator()(const BatchTask& a, const BatchTask& b) const
+    {
+        if (a.size != b.size)
+            return a.size < b.size;
+        return a.sequence > b.sequence;
+    }
+};
+
+/// @brief A file a worker has opened and, with io_uring, started reading.
+struct PendingFile
+{
+    BatchResult result;
+    std::shared_ptr<MediaFile> file;
+    std::shared_ptr<ByteSource> source;
+
+    /// @brief The file this is a part of, or nullptr for a whole file.
+    std::shared_ptr<SplitFile> split;
+    size_t part = 0;
+};
+
+/// @brief Opens the file of a pending file that probed successfully,
+/// setting its result's error if it can't be opened.
+static void OpenProbedFile(PendingFile& pending, const BatchSettings& settings)
+{
+    pending.file->SetCachePolicy(settings.cachePolicy);
+
+    FlacFile* flacFile = dynamic_cast<FlacFile*>(pending.file.get());
+    if (flacFile != nullptr)
+        flacFile->SetVerify(settings.verify);
+    try
+    {
+        pending.file->Open();
+        if (!pending.file->IsOpen())
+            pending.result.probe.error = "Unable to open file";
+    }
+    catch (const MediaFormatError& error)
+    {
+        pending.result.probe.error = error.what();
+    }
+}
+
+/// @brief Opens a file for analysis, queueing reads of the range Analyze
+/// will read if there is a prefetcher.
+static PendingFile OpenPendingFile(
+    std::string fileName, 
+    std::shared_ptr<Logging::Logger> logger,
+    BlockPrefetcher* prefetcher,
+    const BatchSettings& settings)
+{
+    PendingFile pending;
+    pending.result.probe = ProbeMediaFile(fileName);
+    if (!pending.result.probe.error.empty())
+        return pending;
+
+    pending.file = CreateMediaFile(fileName, logger);
+    OpenProbedFile(pending, settings);
+
+    if (pending.result.probe.error.empty() && prefetcher != nullptr)
+    {
+        pending.source = prefetcher->Add(
+            fileName, pending.file->AnalysisRange());
+        if (pending.source != nullptr)
+            pending.file->SetAnalysisSource(pending.source);
+    }
+
+    return pending;
+}
+
+/// @brief The number of bytes Analyze read, which is less than the range it
+/// asked for when a header overstates the data, as streamed WAVs do.
+static std::uint64_t AnalyzedSize(const PendingFile& pending)
+{
+    // Between them, the parts of a split file read all of its samples,
+    // which for FLAC is the whole file as it is for one analyzed whole.
+    const ProbeResult& probe = pending.result.probe;
+    if (pending.split != nullptr)
+    {
+        if (probe.type == MediaFileType::Flac)
+            return probe.fileSize;
+
+        std::uint64_t frameSize = static_cast<std::uint64_t>(
+            std::max(probe.channels, 1) * ((probe.bitsPerSample + 7) / 8));
+        return std::min(probe.totalSamples * frameSize, probe.fileSize);
+    }
+
+    ByteRange range = pending.file->AnalysisRange();
+    std::uint64_t fileSize = pending.result.probe.fileSize;
+    if (range.offset >= fileSize)
+        return 0;
+
+    return std::min(range.size, fileSize - range.offset);
+}
+
+/// @brief The results of verifying a file that has been analyzed, or
+/// nullptr if it wasn't verified.
+static const FlacVerifyResult* VerifyResultOf(const PendingFile& pending)
+{
+    FlacFile* flacFile = dynamic_cast<FlacFile*>(pending.file.get());
+    if (flacFile == nullptr || !flacFile->IsVerifying())
+        return nullptr;
+
+    return &flacFile->VerifyResult();
+}
+
+/// @brief Fills in a pending file's result from its analyzers.
+static void TakeResults(PendingFile& pending)
+{
+    pending.result.isUpscaled = pending.file->IsUpscaled();
+    pending.result.ditherScore = pending.file->LowBits().score;
+    pending.result.distinctValues = pending.file->DistinctValues();
+    pending.result.loudness = pending.file->Loudness();
+
+    const FlacVerifyResult* verifyResult = VerifyResultOf(pending);
+    if (verifyResult != nullptr)
+        pending.result.integrity = verifyResult->Verdict();
+}
+
+/// @brief Analyzes a file OpenPendingFile opened, filling in its result.
+/// Leaves the result as it is if the file couldn't be opened.
+static void AnalyzePendingFile(PendingFile& pending)
+{
+    if (!pending.result.probe.error.empty())
+        return;
+
+    try
+    {
+        // A part's results only mean anything once it is joined to the
+        // rest of its file.
+        pending.file->Analyze(false);
+
+        // A read error looks like the end of the data to the analysis, so
+        // the results it left are only for the part that could be read.
+        if (pending.source != nullptr && pending.source->HasFailed())
+            pending.result.probe.error = "Unable to read file";
+        else if (pending.split == nullptr)
+            TakeResults(pending);
+    }
+    catch (const MediaFormatError& error)
+    {
+        pending.result.probe.error = error.what();
+    }
+}
+
+/// @brief Plans the parts of a file that is large enough to be worth
+/// sharing between workers.
+/// @return The file to split, or nullptr if it is better analyzed whole:
+/// it is too small, can't be probed, or is a FLAC file being verified,
+/// whose MD5 covers the whole stream.
+static std::shared_ptr<SplitFile> PlanParts(
+    const std::string& fileName,
+    std::uint64_t fileSize,
+    const BatchSettings& settings)
+{
+    if (settings.partSize == 0 || settings.workerCount < 2 || 
+        fileSize <= settings.partSize)
+        return nullptr;
+
+    ProbeResult probe = ProbeMediaFile(fileName);
+    if (!probe.error.empty() || probe.totalSamples == 0 || 
+        probe.sampleRate <= 0 || probe.type == MediaFileType::Unsupported ||
+        (probe.type == MediaFileType::Flac && settings.verify))
+        return nullptr;
+
+    // Parts start on whole 100 ms, so the loudness gating blocks of each
+    // line up with those of the whole file.
+    std::uint64_t alignment = std::max<std::uint64_t>(
+        LoudnessAnalyzer::SubBlockLength(probe.sampleRate), 1);
+    std::uint64_t partCount = 
+        (fileSize + settings.partSize - 1) / settings.partSize;
+    std::uint64_t partFrames = 
+        (probe.totalSamples + partCount - 1) / partCount;
+    partFrames = (partFrames + alignment - 1) / alignment * alignment;
+    partCount = (probe.totalSamples + partFrames - 1) / partFrames;
+    if (partCount < 2)
+        return nullptr;
+
+    auto split = std::make_shared<SplitFile>();
+    split->probe = probe;
+    split->partCount = static_cast<size_t>(partCount);
+    split->partFrames = partFrames;
+
+    // The loudness filter settles within tens of milliseconds, so a second
+    // of lead-in is ample and costs little next to a part.
+    split->leadInFrames = static_cast<std::uint64_t>(probe.sampleRate);
+    split->parts.resize(split->partCount);
+    split->finished.assign(split->partCount, false);
+    split->remaining = split->partCount;
+    return split;
+}
+
+/// @brief Opens the file of a task, limited to its part if it has one.
+///
+/// Parts are read with blocking reads rather than prefetched, as a FLAC
+/// part is only found by seeking as it is decoded.
+static PendingFile OpenPendingTask(
+    const BatchTask& task,
+    std::shared_ptr<Logging::Logger> logger,
+    BlockPrefetcher* prefetcher,
+    const BatchSettings& settings)
+{
+    if (task.split == nullptr)
+        return OpenPendingFile(task.fileName, logger, prefetcher, settings);
+
+    // How the file is split is settled before any part is queued.
+    const SplitFile& split = *task.split;
+    PendingFile pending;
+    pending.split = task.split;
+    pending.part = task.part;
+    pending.result.probe = split.probe;
+    pending.file = CreateMediaFile(split.probe.type, task.fileName, logger);
+    OpenProbedFile(pending, settings);
+    if (!pending.result.probe.error.empty())
+        return pending;
+
+    // The last part takes whatever follows, in case the header understated
+    // the length.
+    std::uint64_t firstFrame = task.part * split.partFrames;
+    std::uint64_t frameCount = task.part + 1 < split.partCount 
+        ? split.partFrames 
+        : UINT64_MAX;
+    if (!pending.file->SetAnalysisPart(
+            firstFrame, frameCount, split.leadInFrames))
+        pending.result.probe.error = "Unable to analyze the file in parts";
+
+    return pending;
+}
+
+/// @brief Adds an analyzed part to its file, releasing the part.
+/// @return True if it was the last part to finish, in which case pending
+/// now holds the whole file and its result.
+static bool FinishPart(PendingFile& pending)
+{
+    SplitFile& split = *pending.split;
+    std::lock_guard<std::mutex> lock{ split.mutex };
+
+    if (pending.result.probe.error.empty())
+        split.parts[pending.part] = pending.file;
+    else if (split.error.empty())
+        split.error = pending.result.probe.error;
+    split.finished[pending.part] = true;
+    pending.file = nullptr;
+    pending.source = nullptr;
+
+    // Each part is joined as soon as every part before it has been, so its
+    // analyzers are only held while an earlier part is still running.
+    while (split.joinedCount < split.partCount && 
+           split.finished[split.joinedCount])
+    {
+        size_t next = split.joinedCount++;
+        if (next == 0)
+            continue;
+
+        if (split.error.empty() && 
+            !split.parts[0]->Analyzers().Append(
+                split.parts[next]->Analyzers()))
+            split.error = "Unable to join the parts of the file";
+        split.parts[next] = nullptr;
+    }
+
+    if (--split.remaining > 0)
+        return false;
+
+    pending.result.probe = split.probe;
+    if (split.error.empty())
+    {
+        pending.file = split.parts[0];
+        TakeResults(pending);
+    }
+    else
+    {
+        pending.result.probe.error = split.error;
+    }
+    split.parts.clear();
+    return true;
+}
+
+/// @brief Analyzes a whole file read from input, telling its type from its
+/// first bytes.
+static BatchResult AnalyzeMediaInput(
+    std::shared_ptr<ByteSource> input,
+    const std::string& name,
+    const BatchSettings& settings,
+    std::shared_ptr<Logging::Logger> logger)
+{
+    PendingFile pending;
+    pending.result.probe = ProbeMediaSource(*input, name);
+    if (!pending.result.probe.error.empty())
+        return pending.result;
+
+    if (logger == nullptr)
+        logger = std::make_shared<Logging::Logger>();
+
+    pending.file = CreateMediaFile(pending.result.probe.type, name, logger);
+    pending.file->SetInput(input);
+    OpenProbedFile(pending, settings);
+    AnalyzePendingFile(pending);
+
+    // A stream's probe only found its type.
+    if (pending.result.probe.fileSize == 0 && 
+        pending.result.probe.error.empty())
+        DescribeMediaFile(*pending.file, pending.result.probe);
+
+    return pending.result;
+}
+
+BatchResult AnalyzeMediaFile(
+    const std::string& fileName, 
+    const BatchSettings& settings,
+    std::shared_ptr<Logging::Logger> logger,
+    ControlledSource::ReadHandler progress)
+{
+    if (logger == nullptr)
+        logger = std::make_shared<Logging::Logger>();
+
+    PendingFile pending = OpenPendingFile(
+        fileName, logger, nullptr, settings);
+
+    // The reads are counted through a reader of our own, positioned where
+    // the file's own would be.
+    if (progress && pending.result.probe.error.empty())
+    {
+        auto reader = std::make_shared<FileReader>(fileName);
+        reader->SetCachePolicy(settings.cachePolicy);
+        reader->Open();
+        if (reader->IsOpen() && 
+            reader->Seek(pending.file->AnalysisRange().offset))
+        {
+            pending.source = std::make_shared<ControlledSource>(
+                reader, nullptr, progress);
+            pending.file->SetAnalysisSource(pending.source);
+        }
+    }
+
+    AnalyzePendingFile(pending);
+    return pending.result;
+}
+
+BatchResult AnalyzeMediaDescriptor(
+    int descriptor,
+    const std::string& name,
+    const BatchSettings& settings,
+    std::shared_ptr<Logging::Logger> logger)
+{
+    // A pipe or socket, such as a download being received, is analyzed as
+    // it arrives.
+    std::shared_ptr<ByteSource> input;
+    if (IsSeekable(descriptor))
+        input = std::make_shared<DescriptorSource>(descriptor);
+    else
+        input = std::make_shared<StreamSource>(descriptor);
+
+    return AnalyzeMediaInput(input, name, settings, logger);
+}
+
+BatchResult AnalyzeMediaBuffer(
+    const void* data,
+    std::uint64_t size,
+    const std::string& name,
+    const BatchSettings& settings,
+    std::shared_ptr<Logging::Logger> logger)
+{
+    return AnalyzeMediaInput(
+        std::make_shared<MemorySource>(data, size), name, settings, logger);
+}
+
+BatchAnalyzer::BatchAnalyzer(BatchSettings settings) : settings{ settings }
+{ }
+
+BatchStats BatchAnalyzer::Run(
+    std::string path, 
+    ResultHandler handler, 
+    FileFilter filter)
+{
+    // Errors are reported per file through the results, so the files
+    // themselves write to a logger with no channels.
+    auto logger = std::make_shared<Logging::Logger>();
+
+    unsigned int workerCount = std::max(1u, settings.workerCount);
+    WorkQueue<BatchTask, TaskPriority> queue{ workerCount * 64 };
+    std::atomic<unsigned long> fileCount{ 0 };
+    std::atomic<unsigned long> errorCount{ 0 };
+    std::atomic<std::uint64_t> bytesAnalyzed{ 0 };
+    std::atomic<unsigned long> verifyFailureCount{ 0 };
+    std::atomic<bool> usedIoUring{ false };
+    CacheResidency cacheResidency;
+    std::mutex cacheResidencyMutex;
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < workerCount; i++)
+    {
+        workers.emplace_back([&]()
+        {
+            std::unique_ptr<BlockPrefetcher> prefetcher;
+            if (settings.useIoUring)
+            {
+                prefetcher = std::make_unique<BlockPrefetcher>(
+                    settings.queueDepth);
+                prefetcher->SetCachePolicy(settings.cachePolicy);
+                if (!prefetcher->IsAsync())
+                    prefetcher = nullptr;
+                else
+                    usedIoUring = true;
+            }
+
+            // Without io_uring nothing is read until Analyze asks for it, so
+            // opening files early would only hold descriptors for longer.
+            size_t lookahead = prefetcher != nullptr ? 2 : 1;
+            std::deque<PendingFile> pending;
+            bool queueIsEmpty = false;
+
+            while (true)
+            {
+                BatchTask task;
+                while (pending.size() < lookahead && !queueIsEmpty)
+                {
+                    if (!queue.Pop(task))
+                    {
+                        queueIsEmpty = true;
+                        break;
+                    }
+
+                    PendingFile next = OpenPendingTask(
+                        task, 
+                        logger, 
+                        prefetcher.get(), 
+                        settings);
+                    pending.push_back(std::move(next));
+                }
+
+                if (pending.empty())
+                    break;
+
+                PendingFile current = std::move(pending.front());
+                pending.pop_front();
+
+                AnalyzePendingFile(current);
+                if (current.split != nullptr && !FinishPart(current))
+                    continue;
+
+                if (current.result.probe.error.empty())
+                {
+                    const FlacVerifyResult* verifyResult = 
+                        VerifyResultOf(current);
+                    if (verifyResult != nullptr && !verifyResult->IsIntact())
+                        verifyFailureCount++;
+
+                    bytesAnalyzed += AnalyzedSize(current);
+                }
+                else
+                {
+                    errorCount++;
+                }
+
+                fileCount++;
+                handler(current.result);
+
+                // Measure once the file is closed, so whatever it drops from
+                // the cache on close has been dropped.
+                current.source = nullptr;
+                current.file = nullptr;
+                CacheResidency residency = 
+                    MeasureCacheResidency(current.result.probe.fileName);
+
+                std::lock_guard<std::mutex> lock{ cacheResidencyMutex };
+                cacheResidency += residency;
+            }
+        });
+    }
+
+    std::uint64_t sequence{ 0 };
+    std::vector<std::string> walkErrors;
+    EnumerateMediaFiles(path, [&](const std::string& fileName)
+    {
+        if (filter && !filter(fileName))
+            return;
+
+        // The size on disk stands in for the work in a file, as probing
+        // every header here would hold up the walk that feeds the workers.
+        // Only the files large enough to split are probed.
+        std::error_code error;
+        std::uint64_t size = std::filesystem::file_size(fileName, error);
+        if (error)
+            size = 0;
+
+        BatchTask task;
+        task.fileName = fileName;
+        task.size = size;
+        task.split = PlanParts(fileName, size, settings);
+        if (task.split == nullptr)
+        {
+            task.sequence = sequence++;
+            queue.Push(task);
+            return;
+        }
+
+        task.size = size / task.split->partCount;
+        for (size_t part = 0; part < task.split->partCount; part++)
+        {
+            task.part = part;
+            task.sequence = sequence++;
+            queue.Push(task);
+        }
+    }, 
+    nullptr, 
+    [&](const std::string& folder, const std::error_code& error)
+    {
+        walkErrors.push_back(folder + ": " + error.message());
+    });
+    queue.Close();
+
+    for (std::thread& worker : workers)
+        worker.join();
+
+    std::chrono::duration<double> elapsed = 
+        std::chrono::steady_clock::now() - start;
+
+    BatchStats stats;
+    stats.fileCount = fileCount;
+    stats.errorCount = errorCount;
+    stats.bytesAnalyzed = bytesAnalyzed;
+    stats.verifyFailureCount = verifyFailureCount;
+    stats.seconds = elapsed.count();
+    stats.usedIoUring = usedIoUring;
+    stats.cacheResidency = cacheResidency;
+    stats.walkErrors = std::move(walkErrors);
+    return stats;
+}
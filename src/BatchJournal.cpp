@@ -0,0 +1,217 @@
+// BatchJournal.cpp - Defines the BatchJournal class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include "BatchJournal.h"
+#include "FileDescriptor.h"
+
+/// @brief Starts the first line, so a file that isn't a journal is never
+/// mistaken for one and appended to.
+static const std::string JournalSignature{ "analyzeaudio-journal 1" };
+
+/// @brief Escapes the characters that separate fields and records, so any
+/// path or text fits on one line.
+static std::string Escape(const std::string& text)
+{
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text)
+    {
+        switch (c)
+        {
+            case '\\':
+                escaped += "\\\\";
+                break;
+            case '\t':
+                escaped += "\\t";
+                break;
+            case '\n':
+                escaped += "\\n";
+                break;
+            case '\r':
+                escaped += "\\r";
+                break;
+            default:
+                escaped += c;
+        }
+    }
+    return escaped;
+}
+
+static std::string Unescape(const std::string& text)
+{
+    std::string unescaped;
+    unescaped.reserve(text.size());
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        if (text[i] != '\\' || i + 1 == text.size())
+        {
+            unescaped += text[i];
+            continue;
+        }
+
+        char c = text[++i];
+        if (c == 't')
+            unescaped += '\t';
+        else if (c == 'n')
+            unescaped += '\n';
+        else if (c == 'r')
+            unescaped += '\r';
+        else
+            unescaped += c;
+    }
+    return unescaped;
+}
+
+BatchJournal::BatchJournal(std::string fileName, std::string kind) : 
+    fileName{ fileName }, 
+    kind{ kind }, 
+    descriptor{ -1 }, 
+    pendingCount{ 0 }, 
+    hasFailed{ false }
+{ }
+
+BatchJournal::~BatchJournal()
+{
+    if (descriptor < 0)
+        return;
+
+    Flush();
+    CloseDescriptor(descriptor);
+}
+
+std::string BatchJournal::Open(const RecordHandler& handler)
+{
+    std::string header = JournalSignature + '\t' + Escape(kind) + '\n';
+    std::string contents;
+    {
+        std::ifstream input{ fileName, std::ios::binary };
+        if (input)
+        {
+            std::stringstream buffer;
+            buffer << input.rdbuf();
+            contents = buffer.str();
+        }
+    }
+
+    // Only whole lines were ever flushed, so anything after the last line
+    // break is a record a crash cut short. It is dropped, and its file done
+    // again, rather than leaving the next record appended to it.
+    size_t end = contents.rfind('\n');
+    end = end == std::string::npos ? 0 : end + 1;
+    if (end < contents.size())
+    {
+        std::error_code error;
+        std::filesystem::resize_file(fileName, end, error);
+        if (error)
+            return "Unable to repair the journal " + fileName;
+        contents.resize(end);
+    }
+
+    if (!contents.empty() && contents.compare(0, header.size(), header) != 0)
+    {
+        if (contents.compare(0, JournalSignature.size(), 
+                             JournalSignature) != 0)
+            return fileName + " is not a journal";
+        return fileName + " is the journal of a different kind of batch";
+    }
+
+    size_t start = header.size();
+    while (start < contents.size())
+    {
+        size_t lineEnd = contents.find('\n', start);
+        size_t separator = contents.find('\t', start);
+
+        // A line without a separator can't have been written by Record, so
+        // it is passed over and its file done again.
+        if (separator < lineEnd)
+        {
+            std::string path = Unescape(
+                contents.substr(start, separator - start));
+            std::string text = Unescape(
+                contents.substr(separator + 1, lineEnd - separator - 1));
+            if (handler)
+                handler(path, text);
+            finished.insert(std::move(path));
+        }
+
+        start = lineEnd + 1;
+    }
+
+    descriptor = OpenDescriptor(fileName, AppendFlags);
+    if (descriptor < 0)
+        return "Unable to open the journal " + fileName;
+
+    if (contents.empty())
+    {
+        if (!WriteDescriptor(descriptor, header.data(), header.size()) || 
+            !SyncDescriptor(descriptor))
+            return "Unable to write the journal " + fileName;
+    }
+
+    lastFlush = std::chrono::steady_clock::now();
+    return "";
+}
+
+bool BatchJournal::Contains(const std::string& path) const
+{
+    return finished.count(path) > 0;
+}
+
+void BatchJournal::Record(const std::string& path, const std::string& text)
+{
+    std::string line = Escape(path) + '\t' + Escape(text) + '\n';
+
+    std::lock_guard<std::mutex> lock{ mutex };
+    pending += line;
+    pendingCount++;
+
+    if (pendingCount >= FlushCount || 
+        std::chrono::steady_clock::now() - lastFlush >= FlushInterval)
+        FlushPending();
+}
+
+bool BatchJournal::Flush()
+{
+    std::lock_guard<std::mutex> lock{ mutex };
+    return FlushPending();
+}
+
+bool BatchJournal::FlushPending()
+{
+    lastFlush = std::chrono::steady_clock::now();
+    if (descriptor < 0 || hasFailed)
+        return false;
+
+    if (pending.empty())
+        return true;
+
+    // A failed write may have left part of a line, which the next Open
+    // drops; writing more after it would bury the damage mid-file.
+    if (!WriteDescriptor(descriptor, pending.data(), pending.size()) || 
+        !SyncDescriptor(descriptor))
+    {
+        hasFailed = true;
+        return false;
+    }
+
+    pending.clear();
+    pendingCount = 0;
+    return true;
+}
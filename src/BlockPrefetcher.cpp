@@ -0,0 +1,335 @@
+// BlockPrefetcher.cpp - Defines the BlockPrefetcher class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstring>
+#include "BlockPrefetcher.h"
+#include "FileDescriptor.h"
+
+/// @brief The ByteSource handed out for each range added to the prefetcher.
+class PrefetchedRange : public ByteSource
+{
+public:
+    PrefetchedRange(
+        BlockPrefetcher* prefetcher, 
+        std::shared_ptr<BlockPrefetcher::RangeState> range) :
+        prefetcher{ prefetcher }, range{ range } { }
+
+    ~PrefetchedRange() { prefetcher->Close(*range); }
+
+    size_t Read(void* data, size_t size) override
+    {
+        return prefetcher->Read(*range, data, size);
+    }
+
+    /// @brief Ranges are read strictly in order, so the only position a
+    /// prefetched range can seek to is the one it is already at.
+    bool Seek(std::uint64_t position) override
+    {
+        return position == range->position;
+    }
+
+    std::uint64_t Position() const override { return range->position; }
+
+    std::uint64_t Size() const override { return range->size; }
+
+    bool HasFailed() const override { return range->hasFailed; }
+private:
+    BlockPrefetcher* prefetcher;
+    std::shared_ptr<BlockPrefetcher::RangeState> range;
+};
+
+BlockPrefetcher::BlockPrefetcher(unsigned int queueDepth, size_t blockSize) :
+    ring{ queueDepth },
+    blockSize{ blockSize },
+    blocks(queueDepth),
+    bytesRead{ 0 },
+    cachePolicy{ CachePolicy::Normal }
+{
+    for (Block& block : blocks)
+        block.data.resize(blockSize);
+}
+
+BlockPrefetcher::~BlockPrefetcher()
+{
+    // The kernel may still be writing into blocks for ranges nobody reads
+    // any more, so wait for those reads before the buffers are freed.
+    while (std::any_of(blocks.begin(), blocks.end(), [](const Block& block)
+           { return block.state == BlockState::Reading; }))
+    {
+        if (!WaitForBlock())
+            break;
+    }
+
+    for (std::shared_ptr<RangeState>& range : ranges)
+        CloseRangeFile(*range);
+}
+
+std::shared_ptr<ByteSource> BlockPrefetcher::Add(
+    std::string fileName, 
+    ByteRange range)
+{
+    int descriptor = OpenDescriptor(fileName, ReadOnlyFlags);
+    if (descriptor < 0)
+        return nullptr;
+
+    auto state = std::make_shared<RangeState>();
+    state->descriptor = descriptor;
+    state->end = range.offset + range.size;
+    state->nextRequest = range.offset;
+    state->position = range.offset;
+    state->size = DescriptorSize(descriptor);
+    state->cachePolicy = cachePolicy;
+    ranges.push_back(state);
+
+    if (cachePolicy == CachePolicy::Streaming)
+        AdviseSequential(descriptor);
+
+    RequestBlocks();
+    return std::make_shared<PrefetchedRange>(this, state);
+}
+
+size_t BlockPrefetcher::Read(RangeState& range, void* data, size_t size)
+{
+    std::uint8_t* destination = static_cast<std::uint8_t*>(data);
+    size_t bytesCopied{ 0 };
+
+    while (bytesCopied < size && range.position < range.end)
+    {
+        Block* block = FindBlock(range);
+        if (block == nullptr)
+        {
+            // Nothing has been requested for this position, either because
+            // we read without io_uring or because every block is holding
+            // data for other ranges, so read straight into the caller's
+            // memory instead.
+            size_t count = ReadDirect(
+                range, destination + bytesCopied, size - bytesCopied);
+            if (count == 0)
+                break;
+
+            bytesCopied += count;
+            continue;
+        }
+
+        if (block->state == BlockState::Reading)
+        {
+            if (!WaitForBlock())
+                break;
+            continue;
+        }
+
+        size_t blockPosition = range.position - block->offset;
+        size_t count = std::min(size - bytesCopied, 
+                                block->length - blockPosition);
+        std::memcpy(destination + bytesCopied, 
+                    block->data.data() + blockPosition, 
+                    count);
+        bytesCopied += count;
+        range.position += count;
+
+        if (range.position >= block->offset + block->length)
+        {
+            Release(*block);
+            RequestBlocks();
+        }
+    }
+
+    return bytesCopied;
+}
+
+void BlockPrefetcher::Close(RangeState& range)
+{
+    range.isClosed = true;
+
+    for (Block& block : blocks)
+    {
+        if (block.range.get() == &range && block.state == BlockState::Ready)
+            Release(block);
+    }
+
+    RemoveClosedRanges();
+    RequestBlocks();
+}
+
+void BlockPrefetcher::RequestBlocks()
+{
+    if (!IsAsync())
+        return;
+
+    bool requested = false;
+    for (std::shared_ptr<RangeState>& range : ranges)
+    {
+        while (!range->isClosed && range->nextRequest < range->end)
+        {
+            Block* block = FindFreeBlock();
+            if (block == nullptr)
+                break;
+
+            size_t length = static_cast<size_t>(std::min<std::uint64_t>(
+                blockSize, range->end - range->nextRequest));
+            std::uint64_t tag = block - blocks.data();
+            if (!ring.PrepareRead(range->descriptor, block->data.data(), 
+                                  length, range->nextRequest, tag))
+                break;
+
+            block->state = BlockState::Reading;
+            block->range = range;
+            block->offset = range->nextRequest;
+            block->length = length;
+            range->nextRequest += length;
+            range->blocksInUse++;
+            requested = true;
+        }
+    }
+
+    if (requested)
+        ring.Submit();
+}
+
+size_t BlockPrefetcher::ReadDirect(RangeState& range, void* data, size_t size)
+{
+    size_t count = static_cast<size_t>(
+        std::min<std::uint64_t>(size, range.end - range.position));
+    long long result = ReadDescriptorAt(
+        range.descriptor, data, count, range.position);
+    if (result <= 0)
+    {
+        range.hasFailed = range.hasFailed || result < 0;
+        range.end = range.position;
+        return 0;
+    }
+
+    range.position += result;
+    range.nextRequest = range.position;
+    bytesRead += result;
+    return static_cast<size_t>(result);
+}
+
+bool BlockPrefetcher::WaitForBlock()
+{
+    std::uint64_t tag;
+    int result;
+    if (!ring.WaitCompletion(tag, result) || tag >= blocks.size())
+        return false;
+
+    Block& block = blocks[tag];
+    RangeState& range = *block.range;
+    block.state = BlockState::Ready;
+
+    // A failed request may be transient (-EAGAIN, -EIO on a flaky share), so
+    // the block gets one blocking read before the range is marked failed.
+    if (result < 0 && !range.isClosed)
+    {
+        long long retry = ReadDescriptorAt(
+            range.descriptor, block.data.data(), block.length, block.offset);
+        if (retry < 0)
+            range.hasFailed = true;
+        else
+            result = static_cast<int>(retry);
+    }
+
+    // A short read means the file ended early, and a failed one means it
+    // can't be read, so the range ends where its data does either way.
+    if (result < static_cast<int>(block.length))
+    {
+        block.length = result > 0 ? result : 0;
+        range.end = std::min(range.end, block.offset + block.length);
+    }
+
+    if (result > 0)
+        bytesRead += result;
+
+    if (range.isClosed || block.length == 0)
+    {
+        Release(block);
+        RemoveClosedRanges();
+    }
+
+    return true;
+}
+
+void BlockPrefetcher::Release(Block& block)
+{
+    if (block.range != nullptr)
+        block.range->blocksInUse--;
+
+    block.state = BlockState::Free;
+    block.range = nullptr;
+}
+
+BlockPrefetcher::Block* BlockPrefetcher::FindBlock(RangeState& range)
+{
+    for (Block& block : blocks)
+    {
+        if (block.state != BlockState::Free && 
+            block.range.get() == &range &&
+            range.position >= block.offset && 
+            range.position < block.offset + block.length)
+            return &block;
+    }
+
+    // A block still being read has no length we can trust yet, so match it
+    // on its starting offset alone.
+    for (Block& block : blocks)
+    {
+        if (block.state == BlockState::Reading && 
+            block.range.get() == &range &&
+            block.offset == range.position)
+            return &block;
+    }
+
+    return nullptr;
+}
+
+BlockPrefetcher::Block* BlockPrefetcher::FindFreeBlock()
+{
+    for (Block& block : blocks)
+    {
+        if (block.state == BlockState::Free)
+            return &block;
+    }
+    return nullptr;
+}
+
+void BlockPrefetcher::RemoveClosedRanges()
+{
+    auto isFinished = [](const std::shared_ptr<RangeState>& range)
+    {
+        return range->isClosed && range->blocksInUse == 0;
+    };
+
+    for (std::shared_ptr<RangeState>& range : ranges)
+    {
+        if (isFinished(range))
+            CloseRangeFile(*range);
+    }
+
+    ranges.erase(std::remove_if(ranges.begin(), ranges.end(), isFinished),
+                 ranges.end());
+}
+
+void BlockPrefetcher::CloseRangeFile(RangeState& range)
+{
+    if (range.descriptor < 0)
+        return;
+
+    if (range.cachePolicy == CachePolicy::Streaming)
+        DropFromCache(range.descriptor, 0, 0);
+
+    CloseDescriptor(range.descriptor);
+    range.descriptor = -1;
+}
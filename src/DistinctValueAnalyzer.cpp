@@ -0,0 +1,183 @@
+// DistinctValueAnalyzer.cpp - Defines the DistinctValueAnalyzer class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <bitset>
+#include <cstdlib>
+#include <numeric>
+#include <algorithm>
+#include "DistinctValueAnalyzer.h"
+
+/// @brief How many times over, at least, a scaled 16-bit source is expected
+/// to have used each of its values, and how sparse its lattice must be.
+static constexpr std::uint64_t RepeatFactor{ 8 };
+
+bool DistinctValueResult::IsLikelyScaledUpscale() const
+{
+    if (!analyzed || distinctValues == 0 || distinctValues > SourceValues)
+        return false;
+
+    // Too few samples to use more than 16 bits' worth of values could be
+    // from any recording, so the values must also repeat.
+    if (sampleCount < distinctValues * RepeatFactor)
+        return false;
+
+    if (quantizationStep > 1)
+        return true;
+
+    // Gain other than a power of two spreads the source's values unevenly
+    // over the range, leaving most of the levels between them unused.
+    std::uint64_t levels = static_cast<std::uint64_t>(
+        static_cast<std::int64_t>(maximum) - minimum + 1);
+    return distinctValues * RepeatFactor < levels;
+}
+
+/// @brief Sign-extends the low 24 bits of a bitmap index to a sample value.
+static std::int32_t ValueOfIndex(std::uint32_t index)
+{
+    return static_cast<std::int32_t>(index << 8) >> 8;
+}
+
+void DistinctValueAnalyzer::Reset(int bitsPerSample)
+{
+    sampleCount = 0;
+    origin = 0;
+    step = 0;
+
+    if (bitsPerSample > 16 && bitsPerSample <= MaxBitsPerSample)
+        bitmap.assign(BitmapWords, 0);
+    else
+        std::vector<std::uint64_t>{ }.swap(bitmap);
+}
+
+void DistinctValueAnalyzer::Add(
+    const std::int32_t* samples,
+    size_t count,
+    size_t stride)
+{
+    if (bitmap.empty() || count == 0)
+        return;
+
+    if (sampleCount == 0)
+        origin = samples[0];
+    sampleCount += count;
+
+    std::uint64_t* words = bitmap.data();
+    for (size_t i = 0; i < count; i++)
+    {
+        std::uint32_t index =
+            static_cast<std::uint32_t>(samples[i * stride]) & ValueMask;
+        words[index >> 6] |= std::uint64_t{ 1 } << (index & 63);
+    }
+
+    // Once the step is 1 no sample can change it, which for a natural
+    // recording is within the first few samples. Padding makes the step a
+    // power of two, so that case is checked with a mask, not a division;
+    // a step of 0 takes it too, as the whole difference is the remainder.
+    for (size_t i = 0; i < count && step != 1; i++)
+    {
+        std::uint32_t difference = static_cast<std::uint32_t>(
+            std::abs(static_cast<std::int64_t>(samples[i * stride]) - origin));
+        std::uint32_t mask = step - 1;
+        std::uint32_t remainder = (step & mask) == 0 
+            ? difference & mask 
+            : difference % step;
+        if (remainder != 0)
+            step = std::gcd(step, difference);
+    }
+}
+
+void DistinctValueAnalyzer::Merge(const DistinctValueAnalyzer& other)
+{
+    if (bitmap.empty() || other.bitmap.empty() || other.sampleCount == 0)
+        return;
+
+    for (size_t i = 0; i < BitmapWords; i++)
+        bitmap[i] |= other.bitmap[i];
+
+    // Both lattices must fit, as must the offset between their origins.
+    if (sampleCount == 0)
+    {
+        origin = other.origin;
+        step = other.step;
+    }
+    else
+    {
+        std::uint32_t offset = static_cast<std::uint32_t>(
+            std::abs(static_cast<std::int64_t>(other.origin) - origin));
+        step = std::gcd(std::gcd(step, other.step), offset);
+    }
+    sampleCount += other.sampleCount;
+}
+
+void DistinctValueAnalyzer::Begin(const SampleFormat& format)
+{
+    Reset(format.bitsPerSample);
+}
+
+void DistinctValueAnalyzer::Process(const SampleBlock& block)
+{
+    // The values are counted across all channels, so an interleaved block
+    // is taken in one go.
+    const std::int32_t* interleaved = block.Interleaved();
+    if (interleaved != nullptr)
+    {
+        Add(interleaved, block.SampleCount());
+        return;
+    }
+
+    for (int channel = 0; channel < block.channelCount; channel++)
+        Add(block.channels[channel], block.frameCount, block.stride);
+}
+
+DistinctValueResult DistinctValueAnalyzer::Result() const
+{
+    DistinctValueResult result;
+    if (bitmap.empty())
+        return result;
+
+    result.analyzed = true;
+    result.sampleCount = sampleCount;
+    result.quantizationStep = step;
+
+    bool found{ false };
+    for (size_t word = 0; word < BitmapWords; word++)
+    {
+        std::uint64_t bits = bitmap[word];
+        if (bits == 0)
+            continue;
+
+        result.distinctValues += std::bitset<64>(bits).count();
+
+        // Only the lowest and highest bits of a word can be the extremes,
+        // though negative values sort after positive ones in the bitmap.
+        std::uint32_t base = static_cast<std::uint32_t>(word * 64);
+        int low{ 0 };
+        while (((bits >> low) & 1) == 0)
+            low++;
+        int high{ 63 };
+        while (((bits >> high) & 1) == 0)
+            high--;
+
+        std::int32_t lowValue = ValueOfIndex(base + low);
+        std::int32_t highValue = ValueOfIndex(base + high);
+        result.minimum = found ? std::min(result.minimum, lowValue) : lowValue;
+        result.maximum = found ? std::max(result.maximum, highValue)
+                               : highValue;
+        found = true;
+    }
+
+    return result;
+}
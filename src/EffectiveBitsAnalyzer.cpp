@@ -0,0 +1,65 @@
+// EffectiveBitsAnalyzer.cpp - Defines the EffectiveBitsAnalyzer class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include "EffectiveBitsAnalyzer.h"
+
+void EffectiveBitsAnalyzer::Begin(const SampleFormat& format)
+{
+    bitsPerSample = std::clamp(format.bitsPerSample, 0, 32);
+    usedBits = 0;
+}
+
+void EffectiveBitsAnalyzer::Process(const SampleBlock& block)
+{
+    // A block can't clear bits that are already set, so one whose decoder
+    // knows it has at least as many zero low bits needs no look.
+    if (block.zeroLowBits >= ZeroLowBits())
+        return;
+
+    for (int channel = 0; channel < block.channelCount; channel++)
+    {
+        const std::int32_t* samples = block.channels[channel];
+        std::uint32_t bits{ 0 };
+        for (size_t i = 0; i < block.frameCount; i++)
+            bits |= static_cast<std::uint32_t>(samples[i * block.stride]);
+
+        usedBits |= bits;
+        if (IsDone())
+            return;
+    }
+}
+
+void EffectiveBitsAnalyzer::Append(const SampleAnalyzer& next)
+{
+    usedBits |= static_cast<const EffectiveBitsAnalyzer&>(next).usedBits;
+}
+
+int EffectiveBitsAnalyzer::EffectiveBits() const
+{
+    return std::max(bitsPerSample - ZeroLowBits(), 0);
+}
+
+int EffectiveBitsAnalyzer::ZeroLowBits() const
+{
+    if (usedBits == 0)
+        return 32;
+
+    int zeroBits{ 0 };
+    while (((usedBits >> zeroBits) & 1) == 0)
+        zeroBits++;
+    return zeroBits;
+}
@@ -0,0 +1,80 @@
+// FileEnumerator.cpp - Defines the media file enumeration functions.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <filesystem>
+#include <system_error>
+#include "FileEnumerator.h"
+#include "MediaFileType.h"
+
+/// @brief Walks the directory at path and those beneath it.
+/// @return False if stop ended the walk.
+static bool EnumerateDirectory(
+    const std::filesystem::path& path, 
+    const std::function<void(const std::string&)>& found,
+    const std::function<bool()>& stop,
+    const EnumerationErrorHandler& failed)
+{
+    // Each directory is walked with its own iterator, because a recursive
+    // one ends the whole walk at the first error it can't skip.
+    std::error_code error;
+    auto options = std::filesystem::directory_options::skip_permission_denied;
+    std::filesystem::directory_iterator entry{ path, options, error };
+    std::filesystem::directory_iterator end;
+
+    for (; !error && entry != end; entry.increment(error))
+    {
+        if (stop && stop())
+            return false;
+
+        // Links to directories aren't followed, so a link back up the tree
+        // can't send the walk round in circles.
+        std::error_code typeError;
+        if (entry->is_directory(typeError) && !entry->is_symlink(typeError))
+        {
+            if (!EnumerateDirectory(entry->path(), found, stop, failed))
+                return false;
+            continue;
+        }
+
+        if (!entry->is_regular_file(typeError))
+            continue;
+
+        std::string fileName = entry->path().string();
+        if (GetType(fileName) != MediaFileType::Unsupported)
+            found(fileName);
+    }
+
+    if (error && failed)
+        failed(path.string(), error);
+
+    return true;
+}
+
+void EnumerateMediaFiles(
+    const std::string& path, 
+    const std::function<void(const std::string&)>& found,
+    const std::function<bool()>& stop,
+    const EnumerationErrorHandler& failed)
+{
+    std::error_code error;
+    if (!std::filesystem::is_directory(path, error))
+    {
+        found(path);
+        return;
+    }
+
+    EnumerateDirectory(path, found, stop, failed);
+}
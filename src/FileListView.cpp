@@ -0,0 +1,46 @@
+// FileListView.cpp - Defines the FileListView class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "FileListView.h"
+
+FileListView::FileListView(
+    wxWindow* parent,
+    const FileTable& table,
+    wxSize size) :
+    wxListView{ parent, wxID_ANY, wxDefaultPosition, size,
+                wxLC_REPORT | wxLC_VIRTUAL },
+    table{ table }
+{
+    AppendColumn("File Name", wxLIST_FORMAT_LEFT, 300);
+    AppendColumn("Bit Depth");
+    AppendColumn("Sample Rate");
+    AppendColumn("Is Upscaled");
+}
+
+void FileListView::RefreshView()
+{
+    SetItemCount(static_cast<long>(table.ViewCount()));
+    Refresh();
+}
+
+wxString FileListView::OnGetItemText(long item, long column) const
+{
+    if (item < 0 || static_cast<size_t>(item) >= table.ViewCount())
+        return wxEmptyString;
+
+    size_t row = table.RowAt(static_cast<size_t>(item));
+    return table.CellText(row, static_cast<FileTable::Column>(column));
+}
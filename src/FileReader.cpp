@@ -0,0 +1,169 @@
+// FileReader.cpp - Defines the FileReader class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstring>
+#include "FileReader.h"
+#include "FileDescriptor.h"
+
+FileReader::FileReader(std::string fileName, size_t bufferSize) :
+    fileName{ fileName },
+    descriptor{ -1 },
+    buffer(bufferSize),
+    bufferStart{ 0 },
+    bufferPosition{ 0 },
+    bufferLength{ 0 },
+    readSize{ InitialReadSize },
+    cachePolicy{ CachePolicy::Normal },
+    droppedUpTo{ 0 }
+{ }
+
+FileReader::~FileReader()
+{
+    Close();
+}
+
+void FileReader::SetCachePolicy(CachePolicy policy)
+{
+    cachePolicy = policy;
+    if (IsOpen() && cachePolicy == CachePolicy::Streaming)
+        AdviseSequential(descriptor);
+}
+
+void FileReader::Open()
+{
+    if (IsOpen())
+        return;
+
+    descriptor = OpenDescriptor(fileName, ReadOnlyFlags);
+    bufferStart = 0;
+    bufferPosition = 0;
+    bufferLength = 0;
+    readSize = InitialReadSize;
+    droppedUpTo = 0;
+
+    if (IsOpen() && cachePolicy == CachePolicy::Streaming)
+        AdviseSequential(descriptor);
+}
+
+void FileReader::Close()
+{
+    if (!IsOpen())
+        return;
+
+    // Read-ahead and kernel copies leave pages cached that the reader never
+    // went past, so drop the whole file rather than what's behind the reader.
+    if (cachePolicy == CachePolicy::Streaming)
+        DropFromCache(descriptor, 0, 0);
+
+    CloseDescriptor(descriptor);
+    descriptor = -1;
+}
+
+size_t FileReader::Read(void* data, size_t size)
+{
+    std::uint8_t* destination = static_cast<std::uint8_t*>(data);
+    size_t bytesRead{ 0 };
+
+    while (bytesRead < size)
+    {
+        if (bufferPosition < bufferLength)
+        {
+            size_t count = std::min(size - bytesRead,
+                                    bufferLength - bufferPosition);
+            std::memcpy(destination + bytesRead,
+                        buffer.data() + bufferPosition,
+                        count);
+            bufferPosition += count;
+            bytesRead += count;
+        }
+        else if (size - bytesRead >= std::min(readSize, buffer.size()))
+        {
+            // Reads at least as large as the next buffer fill go straight
+            // into the caller's memory rather than being copied through the
+            // buffer.
+            bufferStart += bufferLength;
+            bufferPosition = 0;
+            bufferLength = 0;
+            DropBehind();
+
+            long long result = ReadDescriptor(
+                descriptor, destination + bytesRead, size - bytesRead);
+            if (result <= 0)
+                break;
+
+            bufferStart += result;
+            bytesRead += result;
+        }
+        else if (FillBuffer() == 0)
+        {
+            break;
+        }
+    }
+
+    return bytesRead;
+}
+
+bool FileReader::Seek(std::uint64_t position)
+{
+    // Stay within the buffer when we can so small forward skips, such as
+    // over a chunk's pad byte, don't discard data we've already read.
+    if (position >= bufferStart && position <= bufferStart + bufferLength)
+    {
+        bufferPosition = position - bufferStart;
+        return true;
+    }
+
+    // A seek breaks the run of in-order reads, so go back to small reads
+    // until the caller shows it is streaming again.
+    bufferStart = position;
+    bufferPosition = 0;
+    bufferLength = 0;
+    readSize = InitialReadSize;
+    droppedUpTo = std::min(droppedUpTo, position);
+    return SeekDescriptor(descriptor, position);
+}
+
+std::uint64_t FileReader::Size() const
+{
+    return DescriptorSize(descriptor);
+}
+
+size_t FileReader::FillBuffer()
+{
+    bufferStart += bufferLength;
+    bufferPosition = 0;
+    bufferLength = 0;
+    DropBehind();
+
+    size_t count = std::min(readSize, buffer.size());
+    long long result = ReadDescriptor(descriptor, buffer.data(), count);
+    if (result > 0)
+        bufferLength = result;
+
+    readSize = std::min(readSize * 2, buffer.size());
+    return bufferLength;
+}
+
+void FileReader::DropBehind()
+{
+    if (cachePolicy != CachePolicy::Streaming || 
+        bufferStart < droppedUpTo + DropInterval)
+        return;
+
+    DropFromCache(descriptor, droppedUpTo, bufferStart - droppedUpTo);
+    droppedUpTo = bufferStart;
+}
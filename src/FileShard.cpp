@@ -0,0 +1,86 @@
+// FileShard.cpp - Defines the FileShard class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <system_error>
+#include "FileShard.h"
+#include "FileEnumerator.h"
+
+FileShard::FileShard(
+    const std::string& path, 
+    unsigned int index, 
+    unsigned int count) : 
+    size{ 0 }
+{
+    struct Entry
+    {
+        std::string fileName;
+        std::string key;
+        std::uint64_t size;
+    };
+
+    std::filesystem::path root{ path };
+    std::vector<Entry> entries;
+    EnumerateMediaFiles(path, [&](const std::string& fileName)
+    {
+        std::error_code error;
+        std::uint64_t fileSize = std::filesystem::file_size(fileName, error);
+        std::string key = std::filesystem::path{ fileName }
+            .lexically_relative(root).generic_string();
+        entries.push_back({ fileName, key, error ? 0 : fileSize });
+    });
+
+    // The walk's order depends on the filesystem, so the files are put in
+    // an order every process agrees on before they are dealt out.
+    std::sort(entries.begin(), entries.end(), 
+              [](const Entry& a, const Entry& b)
+              {
+                  if (a.size != b.size)
+                      return a.size > b.size;
+                  return a.key < b.key;
+              });
+
+    // The shards are kept in a heap by the bytes given to them so far, with
+    // the lower index first among equals.
+    using Load = std::pair<std::uint64_t, unsigned int>;
+    std::priority_queue<Load, std::vector<Load>, std::greater<Load>> loads;
+    for (unsigned int shard = 0; shard < std::max(1u, count); shard++)
+        loads.push({ 0, shard });
+
+    for (Entry& entry : entries)
+    {
+        Load lightest = loads.top();
+        loads.pop();
+        if (lightest.second == index)
+        {
+            files.insert(std::move(entry.fileName));
+            size += entry.size;
+        }
+
+        lightest.first += entry.size + FileCost;
+        loads.push(lightest);
+    }
+}
+
+bool FileShard::Contains(const std::string& fileName) const
+{
+    return files.count(fileName) > 0;
+}
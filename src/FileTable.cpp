@@ -0,0 +1,259 @@
+// FileTable.cpp - Defines the FileTable class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include "FileTable.h"
+
+std::string VerdictText(FileVerdict verdict)
+{
+    switch (verdict)
+    {
+        case FileVerdict::Natural:
+            return "No";
+        case FileVerdict::Scaled:
+            return "Scaled";
+        case FileVerdict::Dithered:
+            return "Dithered";
+        case FileVerdict::Upscaled:
+            return "Yes";
+        case FileVerdict::Failed:
+            return "Error";
+        default:
+            return "";
+    }
+}
+
+FileVerdict ClassifyFile(const MediaFile& file)
+{
+    if (file.IsUpscaled())
+        return FileVerdict::Upscaled;
+    else if (file.LowBits().IsLikelyDitheredUpscale())
+        return FileVerdict::Dithered;
+    else if (file.DistinctValues().IsLikelyScaledUpscale())
+        return FileVerdict::Scaled;
+    else
+        return FileVerdict::Natural;
+}
+
+/// @brief The lower case of each byte, looked up rather than asking the
+/// locale each time, as sorting a large table compares millions of them.
+static const std::array<char, 256> LowerCaseTable = []
+{
+    std::array<char, 256> table{ };
+    for (int c = 0; c < 256; c++)
+        table[c] = static_cast<char>(std::tolower(c));
+    return table;
+}();
+
+static char LowerCase(char c)
+{
+    return LowerCaseTable[static_cast<unsigned char>(c)];
+}
+
+FileTable::FileTable() : 
+    index{ 0, PathHash{ this }, PathEqual{ this } }
+{ }
+
+size_t FileTable::Add(const std::string& path)
+{
+    size_t separator = path.find_last_of("/\\");
+    size_t nameStart = separator == std::string::npos ? 0 : separator + 1;
+
+    Row row;
+    row.pathOffset = paths.size();
+    row.pathLength = static_cast<std::uint32_t>(path.size());
+    row.nameLength = static_cast<std::uint32_t>(path.size() - nameStart);
+    paths += path;
+    rows.push_back(row);
+
+    // The row is added first so the index can hash its path in place, and
+    // taken back out if the path was already there.
+    std::uint32_t rowIndex = static_cast<std::uint32_t>(rows.size() - 1);
+    if (!index.insert(rowIndex).second)
+    {
+        rows.pop_back();
+        paths.resize(row.pathOffset);
+        return NoRow;
+    }
+
+    return rowIndex;
+}
+
+void FileTable::Clear()
+{
+    index.clear();
+    paths.clear();
+    rows.clear();
+    view.clear();
+}
+
+std::string FileTable::Path(size_t row) const
+{
+    return std::string{ PathView(row) };
+}
+
+std::string_view FileTable::FileName(size_t row) const
+{
+    const Row& entry = rows[row];
+    return PathView(row).substr(entry.pathLength - entry.nameLength);
+}
+
+void FileTable::SetFormat(size_t row, int bitsPerSample, long sampleRate)
+{
+    rows[row].bitsPerSample = static_cast<std::uint8_t>(
+        std::clamp(bitsPerSample, 0, 255));
+    rows[row].sampleRate = static_cast<std::uint32_t>(
+        std::max(sampleRate, 0L));
+}
+
+void FileTable::SetVerdict(size_t row, FileVerdict verdict)
+{
+    rows[row].verdict = verdict;
+}
+
+std::string FileTable::CellText(size_t row, Column column) const
+{
+    const Row& entry = rows[row];
+    switch (column)
+    {
+        case Column::FileName:
+            return std::string{ FileName(row) };
+        case Column::BitDepth:
+            return entry.bitsPerSample > 0
+                ? std::to_string(entry.bitsPerSample) : "";
+        case Column::SampleRate:
+            return entry.sampleRate > 0
+                ? std::to_string(entry.sampleRate) : "";
+        case Column::Verdict:
+            return VerdictText(entry.verdict);
+        default:
+            return "";
+    }
+}
+
+void FileTable::SetFilter(const std::string& text, bool upscaledOnly)
+{
+    filterText.clear();
+    for (char c : text)
+        filterText += LowerCase(c);
+    this->upscaledOnly = upscaledOnly;
+}
+
+void FileTable::SetSort(Column column, bool ascending)
+{
+    sortColumn = column;
+    sortAscending = ascending;
+}
+
+void FileTable::UpdateView()
+{
+    view.clear();
+    view.reserve(rows.size());
+    for (size_t row = 0; row < rows.size(); row++)
+    {
+        if (PassesFilter(row))
+            view.push_back(static_cast<std::uint32_t>(row));
+    }
+
+    // Stable, so rows that tie keep the order they were added in either
+    // direction.
+    std::stable_sort(view.begin(), view.end(),
+                     [this](std::uint32_t a, std::uint32_t b)
+                     { return SortsBefore(a, b); });
+}
+
+void FileTable::ExtendView(size_t firstRow)
+{
+    size_t oldCount = view.size();
+    for (size_t row = firstRow; row < rows.size(); row++)
+    {
+        if (PassesFilter(row))
+            view.push_back(static_cast<std::uint32_t>(row));
+    }
+
+    // Sorting just the new rows and merging them in is linear in the size
+    // of the view, where sorting it all again isn't. Both steps are stable
+    // and the new rows come after the old, so ties end up in the order
+    // UpdateView would give them.
+    auto compare = [this](std::uint32_t a, std::uint32_t b)
+                   { return SortsBefore(a, b); };
+    auto middle = view.begin() + static_cast<std::ptrdiff_t>(oldCount);
+    std::stable_sort(middle, view.end(), compare);
+    std::inplace_merge(view.begin(), middle, view.end(), compare);
+}
+
+std::string_view FileTable::PathView(size_t row) const
+{
+    return std::string_view{ paths.data() + rows[row].pathOffset, 
+                             rows[row].pathLength };
+}
+
+size_t FileTable::PathHash::operator()(std::uint32_t row) const
+{
+    return std::hash<std::string_view>{ }(table->PathView(row));
+}
+
+bool FileTable::PathEqual::operator()(std::uint32_t a, std::uint32_t b) const
+{
+    return table->PathView(a) == table->PathView(b);
+}
+
+bool FileTable::PassesFilter(size_t row) const
+{
+    if (upscaledOnly)
+    {
+        FileVerdict verdict = rows[row].verdict;
+        if (verdict != FileVerdict::Upscaled &&
+            verdict != FileVerdict::Dithered &&
+            verdict != FileVerdict::Scaled)
+            return false;
+    }
+
+    if (filterText.empty())
+        return true;
+
+    std::string_view name = FileName(row);
+    auto match = std::search(name.begin(), name.end(),
+                             filterText.begin(), filterText.end(),
+                             [](char a, char b) { return LowerCase(a) == b; });
+    return match != name.end();
+}
+
+bool FileTable::Precedes(size_t a, size_t b) const
+{
+    const Row& first = rows[a];
+    const Row& second = rows[b];
+    switch (sortColumn)
+    {
+        case Column::BitDepth:
+            return first.bitsPerSample < second.bitsPerSample;
+        case Column::SampleRate:
+            return first.sampleRate < second.sampleRate;
+        case Column::Verdict:
+            return first.verdict < second.verdict;
+        default:
+        {
+            std::string_view firstName = FileName(a);
+            std::string_view secondName = FileName(b);
+            return std::lexicographical_compare(
+                firstName.begin(), firstName.end(),
+                secondName.begin(), secondName.end(),
+                [](char x, char y) { return LowerCase(x) < LowerCase(y); });
+        }
+    }
+}
@@ -0,0 +1,219 @@
+// FileWriter.cpp - Defines the FileWriter class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstring>
+#include "FileWriter.h"
+#include "FileDescriptor.h"
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+#endif
+
+/// @brief Copies a range between descriptors without it passing through
+/// user space.
+/// @return The number of bytes copied, which is less than size if the
+/// kernel can't copy between these files or the source is too short.
+static std::uint64_t CopyInKernel(
+    int source, 
+    int destination, 
+    std::uint64_t offset, 
+    std::uint64_t size)
+{
+    std::uint64_t bytesCopied{ 0 };
+#ifdef __linux__
+    // copy_file_range lets the filesystem share extents or copy on the
+    // server, but older kernels refuse some pairs of files that sendfile
+    // still handles, so fall back to it before giving up.
+    constexpr size_t maxCopySize{ 1 << 30 };
+    bool useSendfile = false;
+
+    while (bytesCopied < size)
+    {
+        off_t sourceOffset = static_cast<off_t>(offset + bytesCopied);
+        size_t count = static_cast<size_t>(
+            std::min<std::uint64_t>(size - bytesCopied, maxCopySize));
+
+        ssize_t result;
+        if (useSendfile)
+        {
+            result = sendfile(destination, source, &sourceOffset, count);
+        }
+        else
+        {
+            result = copy_file_range(
+                source, &sourceOffset, destination, nullptr, count, 0);
+            if (result < 0 && errno != EINTR && errno != EIO)
+            {
+                useSendfile = true;
+                continue;
+            }
+        }
+
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result <= 0)
+            break;
+
+        bytesCopied += result;
+    }
+#endif
+    return bytesCopied;
+}
+
+FileWriter::FileWriter(std::string fileName, size_t bufferSize) :
+    fileName{ fileName },
+    descriptor{ -1 },
+    buffer(bufferSize),
+    bufferLength{ 0 },
+    cachePolicy{ CachePolicy::Normal },
+    droppedUpTo{ 0 },
+    hasFailed{ false }
+{ }
+
+FileWriter::~FileWriter()
+{
+    Close();
+}
+
+void FileWriter::Open()
+{
+    if (IsOpen())
+        return;
+
+    descriptor = OpenDescriptor(fileName, WriteOnlyFlags);
+    bufferLength = 0;
+    droppedUpTo = 0;
+    hasFailed = false;
+}
+
+bool FileWriter::Close()
+{
+    if (!IsOpen())
+        return false;
+
+    bool success = Flush() && !hasFailed;
+    DropWritten(true);
+    success = SyncDescriptor(descriptor) && success;
+    CloseDescriptor(descriptor);
+    descriptor = -1;
+    return success;
+}
+
+bool FileWriter::Write(const void* data, size_t size)
+{
+    const std::uint8_t* source = static_cast<const std::uint8_t*>(data);
+
+    // Writes larger than the buffer skip it, as copying them first would
+    // only add a memcpy without saving any system calls.
+    if (size >= buffer.size())
+    {
+        if (Flush() && WriteDescriptor(descriptor, source, size))
+            return true;
+
+        hasFailed = true;
+        return false;
+    }
+
+    if (bufferLength + size > buffer.size() && !Flush())
+        return false;
+
+    std::memcpy(buffer.data() + bufferLength, source, size);
+    bufferLength += size;
+    return true;
+}
+
+bool FileWriter::WriteFrom(
+    FileReader& source,
+    std::uint64_t offset,
+    std::uint64_t size)
+{
+    // Anything buffered has to reach the file first, as the kernel copy
+    // appends at the descriptor's current position.
+    if (!Flush())
+        return false;
+
+    std::uint64_t bytesCopied = CopyInKernel(
+        source.Descriptor(), descriptor, offset, size);
+    DropWritten(false);
+    offset += bytesCopied;
+    size -= bytesCopied;
+
+    // Copy whatever the kernel couldn't through a bounded block so the range
+    // never has to fit in memory.
+    constexpr size_t blockSize{ 64 * 1024 };
+    std::uint8_t block[blockSize];
+
+    source.Seek(offset);
+    while (size > 0)
+    {
+        size_t count = static_cast<size_t>(
+            std::min<std::uint64_t>(size, blockSize));
+        if (source.Read(block, count) != count || !Write(block, count))
+        {
+            hasFailed = true;
+            return false;
+        }
+
+        size -= count;
+    }
+    return true;
+}
+
+bool FileWriter::CloneFrom(FileReader& source)
+{
+    if (!Flush())
+        return false;
+
+#ifdef __linux__
+    if (ioctl(descriptor, FICLONE, source.Descriptor()) == 0)
+        return true;
+#endif
+
+    return WriteFrom(source, 0, source.Size());
+}
+
+bool FileWriter::Flush()
+{
+    if (bufferLength == 0)
+        return true;
+
+    bool success = WriteDescriptor(descriptor, buffer.data(), bufferLength);
+    bufferLength = 0;
+    DropWritten(false);
+    hasFailed = hasFailed || !success;
+    return success;
+}
+
+void FileWriter::DropWritten(bool isClosing)
+{
+    if (cachePolicy != CachePolicy::Streaming)
+        return;
+
+    // The file is ours, so everything in it can go on close; along the way
+    // only whole intervals are dropped, as each drop waits for writeback.
+    std::uint64_t position = DescriptorPosition(descriptor);
+    if (!isClosing && position < droppedUpTo + DropInterval)
+        return;
+
+    DropWrittenFromCache(
+        descriptor, 
+        isClosing ? 0 : droppedUpTo, 
+        isClosing ? 0 : position - droppedUpTo);
+    droppedUpTo = position;
+}
@@ -14,45 +14,72 @@
 // See the License for the specific language governing permissionsand
 // limitations under the License.
 
+#include <algorithm>
 #include "FlacFile.h"
 
-FlacFile::~FlacFile()
-{
-    if (file != nullptr)
-        fclose(file);
-}
-
 void FlacFile::Open()
 {
-    file = fopen(fileName.c_str(), "rb");
+    if (input == reader)
+        reader->Open();
 }
 
 void FlacFile::Analyze(bool dumpSamples)
 {
-    // Start by assuming the file is an upscale conversion; the analysis will
-    // disprove it if it finds any non-zero least significant bytes.
-    isUpscaled = true;
-
+    // The analyzers are started on the first frame, as only then is the
+    // sample size known for sure.
     this->dumpSamples = dumpSamples;
+    stoppedEarly = false;
+    wastedBits.clear();
+    analyzers.Begin(SampleFormat{ });
+    frameCount = 0;
+    framesSettledByHeaders = 0;
+    verifyResult = FlacVerifyResult{};
+
+    // MD5 checking has to be set before init. libFLAC hashes each frame as
+    // it is decoded, so verifying costs no second pass over the file.
+    set_md5_checking(verify);
 
-    // Calls the init method from FLAC::Decoder::File, which opens the file
-    // for reading and decoding.
-    FLAC__StreamDecoderInitStatus initStatus = init(file);
+    // Calls the init method from FLAC::Decoder::Stream, which reads the
+    // stream through our read, seek, tell, length and eof callbacks.
+    source->Seek(0);
+    FLAC__StreamDecoderInitStatus initStatus = init();
 
     if (initStatus == FLAC__STREAM_DECODER_INIT_STATUS_OK) 
     {
-        // Calling this method from FLAC::Decoder::Stream, base of 
-        // FLAC::Decoder::File, starts decoding the FLAC until the end of the
-        // stream. Each decoded frame can be retrieved using the callback
-        // methods. NOTE: We use the write_callback method to retrieve and
-        // analyze the frame buffers even though it's really meant for writing.
-		if (!process_until_end_of_stream())
+        if (hasPart && !SeekToPart())
+        {
+            finish();
+            analyzers.End();
+            throw MediaFormatError{ 
+                "Unable to seek to the part of the FLAC stream to analyze" };
+        }
+
+        // Calling this method from FLAC::Decoder::Stream starts decoding the
+        // FLAC until the end of the stream. Each decoded frame can be
+        // retrieved using the callback methods. NOTE: We use the 
+        // write_callback method to retrieve and analyze the frame buffers
+        // even though it's really meant for writing.
+		if (process_until_end_of_stream())
+        {
+            verifyResult.decodedToEnd = true;
+        }
+        else if (!stoppedEarly)
         {
             std::stringstream streamerror;
             streamerror << "FLAC stream error: ";
             streamerror << get_state().resolved_as_cstring(*this);
             logger->Write(streamerror.str(), Logging::LogLevel::Error);
         }
+
+        // finish only reports a mismatch when there was a signature to
+        // compare against and the whole stream was decoded.
+        verifyResult.md5Matches = finish();
+        if (verify && verifyResult.hasMd5 && !verifyResult.md5Matches)
+        {
+            logger->Write(
+                "FLAC MD5 signature does not match the decoded audio", 
+                Logging::LogLevel::Error);
+        }
 	}
     else
     {
@@ -60,9 +87,70 @@ void FlacFile::Analyze(bool dumpSamples)
             "Unable to initialize FLAC decoder", 
             Logging::LogLevel::Error);
     }
+
+    // With analysis threads, the last frames may still be being analyzed.
+    analyzers.End();
+}
+
+bool FlacFile::SetAnalysisPart(
+    std::uint64_t firstSample, 
+    std::uint64_t sampleCount, 
+    std::uint64_t leadIn)
+{
+    if (verify || input->Size() == 0 || !analyzers.CanAppend())
+        return false;
+
+    hasPart = true;
+    partStart = firstSample;
+    leadInStart = firstSample - std::min(leadIn, firstSample);
+    partEnd = firstSample + std::min(sampleCount, UINT64_MAX - firstSample);
+    return true;
+}
+
+bool FlacFile::SeekToPart()
+{
+    // libFLAC finds the sample by bisecting the frames when the stream has
+    // no seek table, and passes its frame on trimmed to start there. That
+    // frame may already be the last of a short part.
+    if (!process_until_end_of_metadata())
+        return false;
+    return seek_absolute(leadInStart) || stoppedEarly;
+}
+
+bool FlacFile::AnalyzePartOf(
+    const ::FLAC__Frame *frame, 
+    const SampleBlock& block)
+{
+    // Every frame libFLAC passes on is numbered by its first sample.
+    std::uint64_t first = frame->header.number.sample_number;
+    std::uint64_t end = first + block.frameCount;
+    std::uint64_t primeEnd = std::clamp(partStart, first, end);
+    std::uint64_t processEnd = std::clamp(partEnd, first, end);
+
+    if (primeEnd > first)
+    {
+        SampleBlock leadIn = block;
+        leadIn.frameCount = static_cast<size_t>(primeEnd - first);
+        analyzers.Prime(leadIn);
+    }
+
+    if (processEnd > primeEnd)
+    {
+        size_t offset = static_cast<size_t>(primeEnd - first);
+        partChannels.resize(block.channelCount);
+        for (int channel = 0; channel < block.channelCount; channel++)
+            partChannels[channel] = block.channels[channel] + offset;
+
+        SampleBlock inside = block;
+        inside.channels = partChannels.data();
+        inside.frameCount = static_cast<size_t>(processEnd - primeEnd);
+        analyzers.Process(inside);
+    }
+
+    return end < partEnd;
 }
 
-void FlacFile::Convert(
+bool FlacFile::Convert(
     std::string outputFileName, 
     BitDepth depth, 
     ConversionMethod method)
@@ -70,28 +158,157 @@ void FlacFile::Convert(
     logger->Write(
         "Conversion not yet implemented for FLAC", 
         Logging::LogLevel::Error);
+    return false;
+}
+
+::FLAC__StreamDecoderReadStatus FlacFile::read_callback(
+    FLAC__byte buffer[], 
+    size_t *bytes)
+{
+    if (*bytes == 0)
+        return FLAC__STREAM_DECODER_READ_STATUS_ABORT;
+
+    *bytes = source->Read(buffer, *bytes);
+    if (*bytes == 0)
+        return FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
+
+    return FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
+}
+
+::FLAC__StreamDecoderSeekStatus FlacFile::seek_callback(
+    FLAC__uint64 absolute_byte_offset)
+{
+    if (!source->Seek(absolute_byte_offset))
+        return FLAC__STREAM_DECODER_SEEK_STATUS_ERROR;
+
+    return FLAC__STREAM_DECODER_SEEK_STATUS_OK;
+}
+
+::FLAC__StreamDecoderTellStatus FlacFile::tell_callback(
+    FLAC__uint64 *absolute_byte_offset)
+{
+    *absolute_byte_offset = source->Position();
+    return FLAC__STREAM_DECODER_TELL_STATUS_OK;
+}
+
+::FLAC__StreamDecoderLengthStatus FlacFile::length_callback(
+    FLAC__uint64 *stream_length)
+{
+    *stream_length = source->Size();
+    if (*stream_length == 0)
+        return FLAC__STREAM_DECODER_LENGTH_STATUS_UNSUPPORTED;
+
+    return FLAC__STREAM_DECODER_LENGTH_STATUS_OK;
+}
+
+bool FlacFile::eof_callback()
+{
+    return source->Size() != 0 && source->Position() >= source->Size();
 }
 
 ::FLAC__StreamDecoderWriteStatus FlacFile::write_callback(
     const ::FLAC__Frame *frame, 
     const FLAC__int32 * const buffer[])
 {
-    const FLAC__uint32 total_size = 
-        (FLAC__uint32)
-        (format.totalSamples * format.channels * (format.bitsPerSample / 8));
-
+    // STREAMINFO's total samples may be 0 in a stream whose encoder didn't
+    // know the length up front, so decoding just carries on to the end.
 	format.channels = FlacFile::get_channels();
 	format.bitsPerSample = FlacFile::get_bits_per_sample();
 
-	if (format.totalSamples == 0) 
+    format.blockSize = frame->header.blocksize;
+    frameCount++;
+    verifyResult.samplesDecoded += frame->header.blocksize;
+    CountWastedBits(frame);
+
+    // The sample size is only known for sure once decoding has started.
+    unsigned int channels = frame->header.channels;
+    if (frameCount == 1)
     {
-        logger->Write(
-            "Flac STREAMINFO must include total samples", 
-            Logging::LogLevel::Error);
-		return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
-	}
+        SampleFormat sampleFormat;
+        sampleFormat.channels = static_cast<int>(channels);
+        sampleFormat.bitsPerSample = static_cast<int>(format.bitsPerSample);
+        sampleFormat.sampleRate = format.sampleRate;
+        analyzers.Begin(sampleFormat);
+    }
 
-    format.blockSize = frame->header.blocksize;
+    SampleBlock block;
+    block.channels = buffer;
+    block.channelCount = static_cast<int>(channels);
+    block.frameCount = frame->header.blocksize;
+    if (useWastedBits)
+        block.zeroLowBits = ZeroLowBits(frame);
+    if (block.zeroLowBits >= UpscaleAnalyzer::LowByteBits)
+        framesSettledByHeaders++;
+
+    if (hasPart)
+    {
+        if (!AnalyzePartOf(frame, block))
+        {
+            stoppedEarly = true;
+            return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+        }
+    }
+    else
+    {
+        analyzers.Process(block);
+    }
+
+    if (dumpSamples)
+        ProcessSamples(buffer);
+
+    // Once every analyzer has its result the rest of the stream can't
+    // change it, unless it is being dumped or its MD5 checked.
+    if (analyzers.IsDone() && !dumpSamples && !verify)
+    {
+        stoppedEarly = true;
+        return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+    }
+
+	return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+void FlacFile::CountWastedBits(const ::FLAC__Frame *frame)
+{
+    if (wastedBits.size() < frame->header.channels)
+        wastedBits.resize(frame->header.channels);
+
+    for (unsigned int channel = 0; channel < frame->header.channels; channel++)
+    {
+        WastedBitsStats& stats = wastedBits[channel];
+        unsigned int bits = frame->subframes[channel].wasted_bits;
+
+        if (stats.subframeCount == 0 || bits < stats.minimumWastedBits)
+            stats.minimumWastedBits = bits;
+
+        stats.subframeCount++;
+        stats.totalWastedBits += bits;
+        if (bits >= 8)
+            stats.byteWastedCount++;
+    }
+}
+
+int FlacFile::ZeroLowBits(const ::FLAC__Frame *frame) const
+{
+    // Left and right are sums and differences of the coded channels in every
+    // assignment but mid/side, so low bits that are zero in each coded
+    // channel stay zero in them. Mid/side restores left as mid + side / 2,
+    // which shifts the side channel's zero bits down by one.
+    bool isMidSide = 
+        frame->header.channel_assignment == FLAC__CHANNEL_ASSIGNMENT_MID_SIDE;
+
+    int zeroBits{ 32 };
+    for (unsigned int channel = 0; channel < frame->header.channels; channel++)
+    {
+        int bits = static_cast<int>(frame->subframes[channel].wasted_bits);
+        if (isMidSide && channel == 1)
+            bits = std::max(bits - 1, 0);
+        zeroBits = std::min(zeroBits, bits);
+    }
+    return frame->header.channels > 0 ? zeroBits : 0;
+}
+
+void FlacFile::ProcessSamples(const FLAC__int32 * const buffer[])
+{
 	for (size_t frameIndex = 0; frameIndex < format.blockSize; frameIndex++)
     {
         for (
@@ -121,8 +338,6 @@ void FlacFile::Convert(
             }
         }
 	}
-
-	return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
 }
 
 void FlacFile::metadata_callback(const ::FLAC__StreamMetadata *metadata)
@@ -132,10 +347,26 @@ void FlacFile::metadata_callback(const ::FLAC__StreamMetadata *metadata)
 		format.sampleRate = metadata->data.stream_info.sample_rate;
 		format.channels = metadata->data.stream_info.channels;
 		format.bitsPerSample = metadata->data.stream_info.bits_per_sample;
+
+        // An encoder that didn't compute the signature leaves it all zero.
+        const FLAC__byte* md5 = metadata->data.stream_info.md5sum;
+        verifyResult.hasMd5 = std::any_of(md5, md5 + 16, [](FLAC__byte b) 
+                                          { return b != 0; });
+        verifyResult.totalSamples = format.totalSamples;
 	}
 }
 	
 void FlacFile::error_callback(::FLAC__StreamDecoderErrorStatus status)
 {
-    logger->Write("Flac decode error encountered!", Logging::LogLevel::Error);
+    // libFLAC skips a frame with a bad CRC and carries on at the next one,
+    // so count each error rather than treating the first as fatal.
+    if (status == FLAC__STREAM_DECODER_ERROR_STATUS_FRAME_CRC_MISMATCH)
+        verifyResult.crcErrors++;
+    else
+        verifyResult.otherErrors++;
+
+    std::stringstream error;
+    error << "FLAC decode error after " << verifyResult.samplesDecoded 
+          << " samples: " << FLAC__StreamDecoderErrorStatusString[status];
+    logger->Write(error.str(), Logging::LogLevel::Error);
 }
\ No newline at end of file
@@ -0,0 +1,78 @@
+// ImportThread.cpp - Defines the ImportThread class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ImportThread.h"
+
+wxThread::ExitCode ImportThread::Entry()
+{
+    lastResults = Clock::now();
+    for (const std::string& root : roots)
+    {
+        // The same file reached through different spellings of a path
+        // should look the same to the window, which skips duplicates.
+        std::error_code error;
+        std::filesystem::path path = std::filesystem::absolute(root, error);
+        if (error)
+            path = root;
+
+        EnumerateMediaFiles(path.lexically_normal().string(), 
+                            [this](const std::string& fileName)
+                            { Import(fileName); },
+                            [this] { return control->IsCancelled(); });
+
+        if (control->IsCancelled())
+            return 0;
+    }
+
+    PostResults(true);
+
+    wxThreadEvent completeEvent{ wxEVT_THREAD, ImportCompleteID };
+    completeEvent.SetInt(session);
+    parent->GetEventHandler()->QueueEvent(completeEvent.Clone());
+    return 0;
+}
+
+void ImportThread::Import(const std::string& path)
+{
+    ProbeResult probe = ProbeMediaFile(path);
+    ImportedFile file;
+    file.path = path;
+    file.bitsPerSample = probe.bitsPerSample;
+    file.sampleRate = probe.sampleRate;
+    file.failed = !probe.error.empty();
+    results.push_back(std::move(file));
+    PostResults(false);
+}
+
+void ImportThread::PostResults(bool force)
+{
+    if (results.empty())
+        return;
+
+    Clock::time_point now = Clock::now();
+    if (!force && results.size() < ImportBatchSize && 
+        now - lastResults < AnalysisThread::PostInterval)
+    {
+        return;
+    }
+
+    lastResults = now;
+    wxThreadEvent resultsEvent{ wxEVT_THREAD, ImportResultsID };
+    resultsEvent.SetInt(session);
+    resultsEvent.SetPayload(results);
+    parent->GetEventHandler()->QueueEvent(resultsEvent.Clone());
+    results.clear();
+}
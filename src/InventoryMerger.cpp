@@ -0,0 +1,167 @@
+// InventoryMerger.cpp - Defines the InventoryMerger class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include "InventoryMerger.h"
+
+/// @brief Reads a CSV record, which runs over several lines when a quoted
+/// field holds a line break.
+static bool ReadCsvRecord(std::istream& input, std::string& record)
+{
+    if (!std::getline(input, record))
+        return false;
+
+    // Quotes inside a field are doubled, so an odd count means the record
+    // is still inside one.
+    std::string line;
+    while (std::count(record.begin(), record.end(), '"') % 2 != 0 && 
+           std::getline(input, line))
+    {
+        record += '\n';
+        record += line;
+    }
+    return true;
+}
+
+/// @brief The first field of a CSV record, without its quotes.
+static std::string CsvPath(const std::string& record)
+{
+    if (record.empty() || record[0] != '"')
+        return record.substr(0, record.find(','));
+
+    std::string path;
+    for (size_t i = 1; i < record.size(); i++)
+    {
+        if (record[i] == '"')
+        {
+            if (i + 1 == record.size() || record[i + 1] != '"')
+                break;
+            i++;
+        }
+        path += record[i];
+    }
+    return path;
+}
+
+/// @brief The path of an NDJSON row, which InventoryWriter always writes
+/// first, undoing the escapes QuoteJson adds.
+static std::string JsonPath(const std::string& record, size_t start)
+{
+    std::string path;
+    for (size_t i = start + 1; i < record.size() && record[i] != '"'; i++)
+    {
+        if (record[i] != '\\' || i + 1 == record.size())
+        {
+            path += record[i];
+            continue;
+        }
+
+        char c = record[++i];
+        if (c == 'u' && i + 4 < record.size())
+        {
+            path += static_cast<char>(
+                std::strtol(record.substr(i + 1, 4).c_str(), nullptr, 16));
+            i += 4;
+        }
+        else
+        {
+            path += c;
+        }
+    }
+    return path;
+}
+
+InventoryMerger::InventoryMerger(InventoryFormat format) : 
+    format{ format }, 
+    duplicateCount{ 0 }
+{ }
+
+std::string InventoryMerger::Add(const std::string& fileName)
+{
+    std::ifstream input{ fileName, std::ios::binary };
+    if (!input)
+        return "Unable to open " + fileName;
+
+    static const std::string csvStart{ "path," };
+    static const std::string jsonStart{ "{\"path\":\"" };
+
+    std::string record;
+    bool isFirst{ true };
+    while (format == InventoryFormat::Csv 
+           ? ReadCsvRecord(input, record) 
+           : static_cast<bool>(std::getline(input, record)))
+    {
+        if (record.empty())
+            continue;
+
+        std::string path;
+        if (format == InventoryFormat::Csv)
+        {
+            if (isFirst)
+            {
+                isFirst = false;
+                if (record.compare(0, csvStart.size(), csvStart) != 0)
+                    return fileName + " is not a CSV inventory";
+
+                // Probe and analysis inventories have different columns,
+                // so mixing them would leave rows under the wrong headings.
+                if (header.empty())
+                    header = record;
+                else if (record != header)
+                    return fileName + " has different columns";
+                continue;
+            }
+
+            path = CsvPath(record);
+        }
+        else
+        {
+            if (record.compare(0, jsonStart.size(), jsonStart) != 0)
+                return fileName + " is not an NDJSON inventory";
+
+            path = JsonPath(record, jsonStart.size() - 1);
+        }
+
+        if (!rows.emplace(std::move(path), record).second)
+            duplicateCount++;
+    }
+
+    return "";
+}
+
+void InventoryMerger::Write(std::ostream& output) const
+{
+    if (format == InventoryFormat::Csv && !header.empty())
+        output << header << '\n';
+
+    for (const auto& row : rows)
+        output << row.second << '\n';
+}
+
+bool IsInventoryFile(const std::string& fileName, InventoryFormat format)
+{
+    std::string ext = std::filesystem::path{ fileName }.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+    if (format == InventoryFormat::Csv)
+        return ext == ".csv";
+    return ext == ".json" || ext == ".jsonl" || ext == ".ndjson";
+}
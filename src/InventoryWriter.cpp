@@ -0,0 +1,250 @@
+// InventoryWriter.cpp - Defines the InventoryWriter class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include "InventoryWriter.h"
+
+static std::string QuoteCsv(const std::string& text)
+{
+    if (text.find_first_of(",\"\r\n") == std::string::npos)
+        return text;
+
+    std::string quoted{ "\"" };
+    for (char c : text)
+    {
+        if (c == '"')
+            quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+std::string QuoteJson(const std::string& text)
+{
+    std::stringstream quoted;
+    quoted << '"';
+    for (unsigned char c : text)
+    {
+        if (c == '"' || c == '\\')
+            quoted << '\\' << c;
+        else if (c < 0x20)
+            quoted << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                   << static_cast<int>(c) << std::dec;
+        else
+            quoted << c;
+    }
+    quoted << '"';
+    return quoted.str();
+}
+
+/// @brief Formats a level in decibels to two places, or "-inf" for silence.
+static std::string FormatDecibels(double decibels)
+{
+    if (std::isinf(decibels))
+        return decibels < 0 ? "-inf" : "inf";
+
+    std::stringstream text;
+    text << std::fixed << std::setprecision(2) << decibels;
+    return text.str();
+}
+
+/// @brief Formats a level in decibels as a JSON number, or null for silence
+/// since JSON has no infinity.
+static std::string FormatJsonDecibels(double decibels)
+{
+    return std::isinf(decibels) ? "null" : FormatDecibels(decibels);
+}
+
+InventoryWriter::InventoryWriter(
+    std::ostream& output, 
+    InventoryFormat format, 
+    bool includesAnalysis) : 
+    output{ output }, 
+    format{ format }, 
+    includesAnalysis{ includesAnalysis }
+{ }
+
+void InventoryWriter::WriteHeader()
+{
+    if (format != InventoryFormat::Csv)
+        return;
+
+    std::lock_guard<std::mutex> lock{ mutex };
+    output << "path,format,bits_per_sample,sample_rate,channels,"
+           << "total_samples,duration_seconds,file_size,error";
+
+    if (includesAnalysis)
+        output << ",upscaled,dither_score,distinct_values,"
+               << "quantization_step,integrated_lufs,loudness_range,"
+               << "true_peak_dbtp,integrity";
+
+    output << '\n';
+}
+
+void InventoryWriter::Write(const ProbeResult& result)
+{
+    WriteRow(result, nullptr);
+}
+
+void InventoryWriter::Write(const BatchResult& result)
+{
+    WriteFormatted(Format(result));
+}
+
+std::string InventoryWriter::Format(const BatchResult& result)
+{
+    const BatchResult* analysis = result.probe.error.empty() 
+        ? &result : nullptr;
+    return format == InventoryFormat::Csv 
+        ? FormatCsv(result.probe, analysis) 
+        : FormatNdjson(result.probe, analysis);
+}
+
+void InventoryWriter::WriteFormatted(const std::string& row)
+{
+    std::lock_guard<std::mutex> lock{ mutex };
+    output << row << '\n';
+}
+
+void InventoryWriter::WriteRow(
+    const ProbeResult& result, 
+    const BatchResult* analysis)
+{
+    // Format outside the lock so workers only serialize on the write itself.
+    std::string row = format == InventoryFormat::Csv 
+        ? FormatCsv(result, analysis) 
+        : FormatNdjson(result, analysis);
+
+    WriteFormatted(row);
+}
+
+std::string InventoryWriter::FormatCsv(
+    const ProbeResult& result, 
+    const BatchResult* analysis)
+{
+    std::stringstream row;
+    row << QuoteCsv(result.fileName) << ',' 
+        << QuoteCsv(result.format) << ','
+        << result.bitsPerSample << ',' 
+        << result.sampleRate << ','
+        << result.channels << ',' 
+        << result.totalSamples << ','
+        << std::fixed << std::setprecision(3) << result.Duration() << ','
+        << result.fileSize << ','
+        << QuoteCsv(result.error);
+
+    if (includesAnalysis)
+    {
+        row << ',';
+        if (analysis != nullptr)
+            row << (analysis->isUpscaled ? "yes" : "no");
+
+        row << ',';
+        if (analysis != nullptr)
+            row << std::setprecision(3) << analysis->ditherScore;
+
+        row << ',';
+        if (analysis != nullptr && analysis->distinctValues.analyzed)
+            row << analysis->distinctValues.distinctValues;
+
+        row << ',';
+        if (analysis != nullptr && analysis->distinctValues.analyzed)
+            row << analysis->distinctValues.quantizationStep;
+
+        const LoudnessResult* loudness = 
+            analysis != nullptr && analysis->loudness.measured 
+            ? &analysis->loudness 
+            : nullptr;
+        row << ',';
+        if (loudness != nullptr)
+            row << FormatDecibels(loudness->integratedLoudness);
+        row << ',';
+        if (loudness != nullptr)
+            row << FormatDecibels(loudness->loudnessRange);
+        row << ',';
+        if (loudness != nullptr)
+            row << FormatDecibels(loudness->TruePeakDbtp());
+
+        row << ',';
+        if (analysis != nullptr)
+            row << analysis->integrity;
+    }
+
+    return row.str();
+}
+
+std::string InventoryWriter::FormatNdjson(
+    const ProbeResult& result, 
+    const BatchResult* analysis)
+{
+    std::stringstream row;
+    row << "{\"path\":" << QuoteJson(result.fileName) 
+        << ",\"format\":" << QuoteJson(result.format)
+        << ",\"bits_per_sample\":" << result.bitsPerSample
+        << ",\"sample_rate\":" << result.sampleRate
+        << ",\"channels\":" << result.channels
+        << ",\"total_samples\":" << result.totalSamples
+        << ",\"duration_seconds\":" << std::fixed << std::setprecision(3) 
+        << result.Duration()
+        << ",\"file_size\":" << result.fileSize;
+
+    if (!result.error.empty())
+        row << ",\"error\":" << QuoteJson(result.error);
+
+    if (includesAnalysis && analysis != nullptr)
+    {
+        row << ",\"upscaled\":" << (analysis->isUpscaled ? "true" : "false")
+            << ",\"dither_score\":" << std::setprecision(3) 
+            << analysis->ditherScore;
+        if (analysis->distinctValues.analyzed)
+        {
+            row << ",\"distinct_values\":" 
+                << analysis->distinctValues.distinctValues
+                << ",\"quantization_step\":" 
+                << analysis->distinctValues.quantizationStep;
+        }
+        if (analysis->loudness.measured)
+        {
+            const LoudnessResult& loudness = analysis->loudness;
+            row << ",\"integrated_lufs\":" 
+                << FormatJsonDecibels(loudness.integratedLoudness)
+                << ",\"loudness_range\":" 
+                << FormatJsonDecibels(loudness.loudnessRange)
+                << ",\"true_peak_dbtp\":" 
+                << FormatJsonDecibels(loudness.TruePeakDbtp());
+        }
+        if (!analysis->integrity.empty())
+            row << ",\"integrity\":" << QuoteJson(analysis->integrity);
+    }
+
+    row << '}';
+    return row.str();
+}
+
+InventoryFormat GetInventoryFormat(std::string fileName)
+{
+    std::string ext = std::filesystem::path{ fileName }.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+    if (ext == ".json" || ext == ".jsonl" || ext == ".ndjson")
+        return InventoryFormat::Ndjson;
+    return InventoryFormat::Csv;
+}
@@ -0,0 +1,274 @@
+// IoRing.cpp - Defines the IoRing class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <cerrno>
+#include <vector>
+#include "IoRing.h"
+
+#ifdef HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static int SetupRing(unsigned int entries, io_uring_params* params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int EnterRing(
+    int ringDescriptor, 
+    unsigned int toSubmit, 
+    unsigned int minComplete, 
+    unsigned int flags)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, ringDescriptor, 
+        toSubmit, minComplete, flags, nullptr, 0));
+}
+
+/// @brief Whether the kernel supports IORING_OP_READ. Kernels 5.1 to 5.5
+/// have io_uring but fail plain reads with -EINVAL, and predate the probe
+/// too, so a failed probe also means no support.
+static bool SupportsRead(int ringDescriptor)
+{
+    constexpr unsigned int operationCount{ 256 };
+    std::vector<unsigned char> buffer(sizeof(io_uring_probe) + 
+                                      operationCount * 
+                                      sizeof(io_uring_probe_op));
+    auto* probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+    if (syscall(__NR_io_uring_register, ringDescriptor, 
+                IORING_REGISTER_PROBE, probe, operationCount) < 0)
+        return false;
+
+    return IORING_OP_READ <= probe->last_op &&
+           (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+}
+
+template <typename T>
+static T* RingField(void* ring, std::uint32_t offset)
+{
+    return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+#endif
+
+IoRing::IoRing(unsigned int entries) :
+    ringDescriptor{ -1 },
+    pendingSubmissions{ 0 },
+    submissionRing{ nullptr },
+    submissionRingSize{ 0 },
+    completionRing{ nullptr },
+    completionRingSize{ 0 },
+    submissionEntries{ nullptr },
+    submissionEntriesSize{ 0 }
+{
+#ifdef HAVE_IO_URING
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int descriptor = SetupRing(entries, &params);
+    if (descriptor < 0)
+        return;
+
+    // Without plain reads every request would fail, so callers are better
+    // off seeing no ring and reading with blocking calls instead.
+    if (!SupportsRead(descriptor))
+    {
+        close(descriptor);
+        return;
+    }
+
+    // The kernel shares three regions with us: the submission ring, the
+    // completion ring and the submission entries the rings index into.
+    // Newer kernels map both rings with a single mmap.
+    submissionRingSize = params.sq_off.array + 
+                         params.sq_entries * sizeof(unsigned int);
+    completionRingSize = params.cq_off.cqes + 
+                         params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMap && completionRingSize > submissionRingSize)
+        submissionRingSize = completionRingSize;
+
+    submissionRing = mmap(nullptr, submissionRingSize, 
+                          PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          descriptor, IORING_OFF_SQ_RING);
+    if (submissionRing == MAP_FAILED)
+    {
+        submissionRing = nullptr;
+        close(descriptor);
+        return;
+    }
+
+    if (singleMap)
+    {
+        completionRing = submissionRing;
+    }
+    else
+    {
+        completionRing = mmap(nullptr, completionRingSize,
+                              PROT_READ | PROT_WRITE, 
+                              MAP_SHARED | MAP_POPULATE,
+                              descriptor, IORING_OFF_CQ_RING);
+        if (completionRing == MAP_FAILED)
+        {
+            completionRing = nullptr;
+            munmap(submissionRing, submissionRingSize);
+            submissionRing = nullptr;
+            close(descriptor);
+            return;
+        }
+    }
+
+    submissionEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+    submissionEntries = mmap(nullptr, submissionEntriesSize,
+                             PROT_READ | PROT_WRITE, 
+                             MAP_SHARED | MAP_POPULATE,
+                             descriptor, IORING_OFF_SQES);
+    if (submissionEntries == MAP_FAILED)
+    {
+        submissionEntries = nullptr;
+        if (completionRing != submissionRing)
+            munmap(completionRing, completionRingSize);
+        munmap(submissionRing, submissionRingSize);
+        completionRing = nullptr;
+        submissionRing = nullptr;
+        close(descriptor);
+        return;
+    }
+
+    submissionHead = RingField<unsigned int>(
+        submissionRing, params.sq_off.head);
+    submissionTail = RingField<unsigned int>(
+        submissionRing, params.sq_off.tail);
+    submissionMask = *RingField<unsigned int>(
+        submissionRing, params.sq_off.ring_mask);
+    submissionArray = RingField<unsigned int>(
+        submissionRing, params.sq_off.array);
+    completionHead = RingField<unsigned int>(
+        completionRing, params.cq_off.head);
+    completionTail = RingField<unsigned int>(
+        completionRing, params.cq_off.tail);
+    completionMask = *RingField<unsigned int>(
+        completionRing, params.cq_off.ring_mask);
+    completionEntries = RingField<io_uring_cqe>(
+        completionRing, params.cq_off.cqes);
+
+    ringDescriptor = descriptor;
+#endif
+}
+
+IoRing::~IoRing()
+{
+#ifdef HAVE_IO_URING
+    if (!IsAvailable())
+        return;
+
+    munmap(submissionEntries, submissionEntriesSize);
+    if (completionRing != submissionRing)
+        munmap(completionRing, completionRingSize);
+    munmap(submissionRing, submissionRingSize);
+    close(ringDescriptor);
+#endif
+}
+
+bool IoRing::PrepareRead(
+    int descriptor, 
+    void* data, 
+    unsigned int size,
+    std::uint64_t offset, 
+    std::uint64_t tag)
+{
+#ifdef HAVE_IO_URING
+    if (!IsAvailable())
+        return false;
+
+    unsigned int head = __atomic_load_n(submissionHead, __ATOMIC_ACQUIRE);
+    unsigned int tail = *submissionTail;
+    if (tail - head > submissionMask)
+        return false;
+
+    unsigned int index = tail & submissionMask;
+    io_uring_sqe* entry = static_cast<io_uring_sqe*>(submissionEntries) + index;
+    std::memset(entry, 0, sizeof(io_uring_sqe));
+    entry->opcode = IORING_OP_READ;
+    entry->fd = descriptor;
+    entry->addr = reinterpret_cast<std::uint64_t>(data);
+    entry->len = size;
+    entry->off = offset;
+    entry->user_data = tag;
+    submissionArray[index] = index;
+
+    // The entry must be fully written before the kernel can see the new
+    // tail, hence the release store.
+    __atomic_store_n(submissionTail, tail + 1, __ATOMIC_RELEASE);
+    pendingSubmissions++;
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool IoRing::Submit()
+{
+#ifdef HAVE_IO_URING
+    while (pendingSubmissions > 0)
+    {
+        int result = EnterRing(ringDescriptor, pendingSubmissions, 0, 0);
+        if (result < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+                continue;
+            return false;
+        }
+
+        pendingSubmissions -= result;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool IoRing::WaitCompletion(std::uint64_t& tag, int& result)
+{
+#ifdef HAVE_IO_URING
+    if (!IsAvailable())
+        return false;
+
+    while (true)
+    {
+        unsigned int head = *completionHead;
+        unsigned int tail = __atomic_load_n(completionTail, __ATOMIC_ACQUIRE);
+        if (head != tail)
+        {
+            io_uring_cqe* entry = static_cast<io_uring_cqe*>(
+                completionEntries) + (head & completionMask);
+            tag = entry->user_data;
+            result = entry->res;
+            __atomic_store_n(completionHead, head + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+
+        int entered = EnterRing(ringDescriptor, pendingSubmissions, 1, 
+                                IORING_ENTER_GETEVENTS);
+        if (entered < 0 && errno != EINTR)
+            return false;
+        if (entered > 0)
+            pendingSubmissions -= entered;
+    }
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,301 @@
+// LevelAnalyzer.cpp - Defines the LevelAnalyzer class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "LevelAnalyzer.h"
+
+void LevelAnalyzer::Scan(
+    const std::int32_t* samples,
+    size_t count,
+    ScanTotals (&totals)[ScanLanes])
+{
+    // Kept as separate arrays, rather than in the totals, so the compiler
+    // can hold each one in a vector register.
+    std::int32_t minimum[ScanLanes];
+    std::int32_t maximum[ScanLanes];
+    std::int64_t sum[ScanLanes];
+    double sumOfSquares[ScanLanes];
+    for (int lane = 0; lane < ScanLanes; lane++)
+    {
+        minimum[lane] = std::numeric_limits<std::int32_t>::max();
+        maximum[lane] = std::numeric_limits<std::int32_t>::min();
+        sum[lane] = 0;
+        sumOfSquares[lane] = 0;
+    }
+
+    size_t i{ 0 };
+    for (; i + ScanLanes <= count; i += ScanLanes)
+    {
+        for (int lane = 0; lane < ScanLanes; lane++)
+        {
+            std::int32_t sample = samples[i + lane];
+            minimum[lane] = std::min(minimum[lane], sample);
+            maximum[lane] = std::max(maximum[lane], sample);
+            sum[lane] += sample;
+            sumOfSquares[lane] += static_cast<double>(sample) * sample;
+        }
+    }
+    for (int lane = 0; i < count; i++, lane++)
+    {
+        minimum[lane] = std::min(minimum[lane], samples[i]);
+        maximum[lane] = std::max(maximum[lane], samples[i]);
+        sum[lane] += samples[i];
+        sumOfSquares[lane] += static_cast<double>(samples[i]) * samples[i];
+    }
+
+    for (int lane = 0; lane < ScanLanes; lane++)
+    {
+        totals[lane].minimum = minimum[lane];
+        totals[lane].maximum = maximum[lane];
+        totals[lane].sum = sum[lane];
+        totals[lane].sumOfSquares = sumOfSquares[lane];
+    }
+}
+
+void LevelAnalyzer::ScanTotals::Merge(const ScanTotals& other)
+{
+    minimum = std::min(minimum, other.minimum);
+    maximum = std::max(maximum, other.maximum);
+    sum += other.sum;
+    sumOfSquares += other.sumOfSquares;
+}
+
+double LevelChannelStats::ToDecibels(double level)
+{
+    if (level <= 0)
+        return -std::numeric_limits<double>::infinity();
+    return 20.0 * std::log10(level);
+}
+
+void LevelAnalyzer::Reset(int channelCount, int bitsPerSample)
+{
+    this->bitsPerSample = std::clamp(bitsPerSample, 0, 32);
+    accumulators.assign(std::max(channelCount, 0), ChannelAccumulator{ });
+
+    if (this->bitsPerSample > 0)
+    {
+        std::int64_t fullScale = std::int64_t{ 1 } << (this->bitsPerSample - 1);
+        clipLow = static_cast<std::int32_t>(-fullScale);
+        clipHigh = static_cast<std::int32_t>(fullScale - 1);
+    }
+}
+
+void LevelAnalyzer::Add(int channel, const std::int32_t* samples, size_t count)
+{
+    if (count == 0)
+        return;
+
+    ScanTotals lanes[ScanLanes];
+    Scan(samples, count, lanes);
+    for (int lane = 1; lane < ScanLanes; lane++)
+        lanes[0].Merge(lanes[lane]);
+
+    AddTotals(channel, lanes[0], samples, count, 1);
+}
+
+void LevelAnalyzer::AddInterleaved(const std::int32_t* samples, size_t count)
+{
+    size_t channels = accumulators.size();
+    if (channels == 0 || count == 0)
+        return;
+
+    // When the channels divide the lanes, each lane holds one channel's
+    // samples, so the block is scanned where it is.
+    if (ScanLanes % channels == 0)
+    {
+        ScanTotals lanes[ScanLanes];
+        Scan(samples, count, lanes);
+        for (size_t lane = channels; lane < ScanLanes; lane++)
+            lanes[lane % channels].Merge(lanes[lane]);
+
+        for (size_t channel = 0; channel < channels && channel < count; 
+             channel++)
+        {
+            size_t channelCount = (count - channel + channels - 1) / channels;
+            AddTotals(static_cast<int>(channel), lanes[channel], 
+                      samples + channel, channelCount, channels);
+        }
+        return;
+    }
+
+    for (size_t channel = 0; channel < channels && channel < count; channel++)
+    {
+        size_t channelCount = (count - channel + channels - 1) / channels;
+        channelSamples.resize(channelCount);
+        for (size_t i = 0; i < channelCount; i++)
+            channelSamples[i] = samples[channel + i * channels];
+        Add(static_cast<int>(channel), channelSamples.data(), channelCount);
+    }
+}
+
+void LevelAnalyzer::AddTotals(
+    int channel,
+    const ScanTotals& totals,
+    const std::int32_t* samples,
+    size_t count,
+    size_t stride)
+{
+    ChannelAccumulator& accumulator = accumulators[channel];
+    if (accumulator.sampleCount == 0)
+    {
+        accumulator.minimum = totals.minimum;
+        accumulator.maximum = totals.maximum;
+    }
+    else
+    {
+        accumulator.minimum = std::min(accumulator.minimum, totals.minimum);
+        accumulator.maximum = std::max(accumulator.maximum, totals.maximum);
+    }
+    accumulator.sum += totals.sum;
+    accumulator.sumOfSquares += totals.sumOfSquares;
+    accumulator.sampleCount += count;
+
+    // Most blocks never reach full scale, which also ends any run that the
+    // block before was clipped at.
+    if (totals.minimum <= clipLow || totals.maximum >= clipHigh)
+        CountClipping(accumulator, samples, count, stride);
+    else
+        accumulator.currentRun = 0;
+}
+
+void LevelAnalyzer::CountClipping(
+    ChannelAccumulator& accumulator,
+    const std::int32_t* samples,
+    size_t count,
+    size_t stride)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        std::int32_t sample = samples[i * stride];
+        if (sample <= clipLow || sample >= clipHigh)
+        {
+            accumulator.clippedSamples++;
+            accumulator.currentRun++;
+
+            // Counted once, as the run reaches the minimum length.
+            if (accumulator.currentRun == MinClipRun)
+                accumulator.clippedRuns++;
+        }
+        else
+        {
+            accumulator.currentRun = 0;
+        }
+    }
+}
+
+void LevelAnalyzer::Begin(const SampleFormat& format)
+{
+    Reset(format.channels, format.bitsPerSample);
+}
+
+void LevelAnalyzer::Process(const SampleBlock& block)
+{
+    const std::int32_t* interleaved = block.Interleaved();
+    if (interleaved != nullptr)
+    {
+        AddInterleaved(interleaved, block.SampleCount());
+        return;
+    }
+
+    for (int channel = 0; channel < ChannelCount(); channel++)
+        Add(channel, block.channels[channel], block.frameCount);
+}
+
+void LevelAnalyzer::Prime(const SampleBlock& block)
+{
+    for (int channel = 0; channel < ChannelCount(); channel++)
+    {
+        ChannelAccumulator& accumulator = accumulators[channel];
+        for (size_t i = 0; i < block.frameCount; i++)
+        {
+            std::int32_t sample = block.Sample(channel, i);
+            if (sample <= clipLow || sample >= clipHigh)
+                accumulator.currentRun++;
+            else
+                accumulator.currentRun = 0;
+        }
+    }
+}
+
+void LevelAnalyzer::Append(const SampleAnalyzer& next)
+{
+    const auto& other = static_cast<const LevelAnalyzer&>(next);
+    if (other.accumulators.size() != accumulators.size())
+        return;
+
+    for (size_t channel = 0; channel < accumulators.size(); channel++)
+    {
+        ChannelAccumulator& accumulator = accumulators[channel];
+        const ChannelAccumulator& part = other.accumulators[channel];
+        if (part.sampleCount == 0)
+            continue;
+
+        if (accumulator.sampleCount == 0)
+        {
+            accumulator.minimum = part.minimum;
+            accumulator.maximum = part.maximum;
+        }
+        else
+        {
+            accumulator.minimum = std::min(accumulator.minimum, part.minimum);
+            accumulator.maximum = std::max(accumulator.maximum, part.maximum);
+        }
+        accumulator.sampleCount += part.sampleCount;
+        accumulator.sum += part.sum;
+        accumulator.sumOfSquares += part.sumOfSquares;
+
+        // A clip across the boundary was counted by the part it reached the
+        // minimum length in, as the part was primed with this one's end.
+        accumulator.clippedSamples += part.clippedSamples;
+        accumulator.clippedRuns += part.clippedRuns;
+        accumulator.currentRun = part.currentRun;
+    }
+}
+
+LevelResult LevelAnalyzer::Result() const
+{
+    LevelResult result;
+    double fullScale = bitsPerSample > 0
+        ? std::ldexp(1.0, bitsPerSample - 1)
+        : 1.0;
+
+    for (const ChannelAccumulator& accumulator : accumulators)
+    {
+        LevelChannelStats stats;
+        stats.sampleCount = accumulator.sampleCount;
+        stats.minimum = accumulator.minimum;
+        stats.maximum = accumulator.maximum;
+        stats.clippedSamples = accumulator.clippedSamples;
+        stats.clippedRuns = accumulator.clippedRuns;
+
+        if (accumulator.sampleCount > 0)
+        {
+            double count = static_cast<double>(accumulator.sampleCount);
+            double peak = std::max(
+                std::fabs(static_cast<double>(accumulator.minimum)),
+                std::fabs(static_cast<double>(accumulator.maximum)));
+            stats.peak = std::min(peak / fullScale, 1.0);
+            stats.rms = std::sqrt(accumulator.sumOfSquares / count) / fullScale;
+            stats.dcOffset = accumulator.sum / count / fullScale;
+        }
+
+        result.channels.push_back(stats);
+    }
+
+    return result;
+}
@@ -0,0 +1,545 @@
+// LoudnessAnalyzer.cpp - Defines the LoudnessAnalyzer class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <limits>
+#include <iterator>
+#include <algorithm>
+#include "LoudnessAnalyzer.h"
+
+/// @brief The 4x oversampling interpolator from ITU-R BS.1770-4 Annex 2,
+/// one row of taps per phase.
+static constexpr double TruePeakFilter[4][12]
+{
+    {
+         0.0017089843750,  0.0109863281250, -0.0196533203125,
+         0.0332031250000, -0.0594482421875,  0.1373291015625,
+         0.9721679687500, -0.1022949218750,  0.0476074218750,
+        -0.0266113281250,  0.0148925781250, -0.0083007812500
+    },
+    {
+        -0.0291748046875,  0.0292968750000, -0.0517578125000,
+         0.0891113281250, -0.1665039062500,  0.4650878906250,
+         0.7797851562500, -0.2003173828125,  0.1015625000000,
+        -0.0582275390625,  0.0330810546875, -0.0189208984375
+    },
+    {
+        -0.0189208984375,  0.0330810546875, -0.0582275390625,
+         0.1015625000000, -0.2003173828125,  0.7797851562500,
+         0.4650878906250, -0.1665039062500,  0.0891113281250,
+        -0.0517578125000,  0.0292968750000, -0.0291748046875
+    },
+    {
+        -0.0083007812500,  0.0148925781250, -0.0266113281250,
+         0.0476074218750, -0.1022949218750,  0.9721679687500,
+         0.1373291015625, -0.0594482421875,  0.0332031250000,
+        -0.0196533203125,  0.0109863281250,  0.0017089843750
+    }
+};
+
+/// @brief The largest sum of the magnitudes of one phase's taps, so no
+/// output of the filter exceeds its largest input by more than this.
+static constexpr float TruePeakGainBound{ 2.03f };
+
+static constexpr double Pi{ 3.14159265358979323846 };
+
+/// @brief The gates and block lengths of BS.1770-4 and EBU Tech 3342.
+static constexpr double AbsoluteGate{ -70.0 };
+static constexpr double IntegratedRelativeGate{ -10.0 };
+static constexpr double RangeRelativeGate{ -20.0 };
+static constexpr size_t MomentarySubBlocks{ 4 };
+static constexpr size_t ShortTermSubBlocks{ 30 };
+static constexpr double RangeLowPercentile{ 0.10 };
+static constexpr double RangeHighPercentile{ 0.95 };
+
+/// @brief Converts a channel weighted mean square to LUFS.
+static double ToLoudness(double power)
+{
+    if (power <= 0)
+        return -std::numeric_limits<double>::infinity();
+    return -0.691 + 10.0 * std::log10(power);
+}
+
+/// @brief The mean power of each window of windowLength consecutive
+/// 100 ms powers, one window per 100 ms step.
+static std::vector<double> WindowPowers(
+    const std::vector<double>& subBlockPowers,
+    size_t windowLength)
+{
+    std::vector<double> windows;
+    if (subBlockPowers.size() < windowLength)
+        return windows;
+
+    windows.reserve(subBlockPowers.size() - windowLength + 1);
+    double sum{ 0 };
+    for (size_t i = 0; i < subBlockPowers.size(); i++)
+    {
+        sum += subBlockPowers[i];
+        if (i >= windowLength)
+            sum -= subBlockPowers[i - windowLength];
+        if (i + 1 >= windowLength)
+            windows.push_back(std::max(sum, 0.0) / windowLength);
+    }
+    return windows;
+}
+
+/// @brief Removes the windows below the absolute gate and then those more
+/// than relativeGate LU below the loudness of the ones that are left.
+static std::vector<double> GateWindows(
+    const std::vector<double>& windows,
+    double relativeGate)
+{
+    std::vector<double> gated;
+    double sum{ 0 };
+    for (double power : windows)
+    {
+        if (ToLoudness(power) > AbsoluteGate)
+        {
+            gated.push_back(power);
+            sum += power;
+        }
+    }
+    if (gated.empty())
+        return gated;
+
+    double threshold = ToLoudness(sum / gated.size()) + relativeGate;
+    gated.erase(std::remove_if(gated.begin(), gated.end(), [&](double power)
+    {
+        return ToLoudness(power) <= threshold;
+    }), gated.end());
+    return gated;
+}
+
+/// @brief The largest magnitude of the 4x oversampled signal for count
+/// samples, each of which has the filter's taps less one before it in x,
+/// or peak if that is larger.
+///
+/// Worked in tiles that fit the L1 cache, and only for the tiles whose
+/// samples are loud enough for the filter to beat the peak so far. Each
+/// phase is computed with the taps as the outer loop, so the inner loop is
+/// a multiply-add over consecutive samples that the compiler vectorizes.
+/// Single precision is ample for a peak, and fits twice the samples in a
+/// vector register.
+static float OversampledPeak(const float* x, size_t count, float peak)
+{
+    constexpr size_t TileLength{ 64 };
+    constexpr size_t Lanes{ 8 };
+    constexpr size_t TapCount{ std::size(TruePeakFilter[0]) };
+    float output[TileLength];
+
+    for (size_t start = 0; start < count; start += TileLength)
+    {
+        size_t length = std::min(TileLength, count - start);
+        const float* tile = x + start;
+
+        // The samples the tile's outputs are made from, in lanes as for the
+        // outputs below, as a single running maximum wouldn't vectorize.
+        float peaks[Lanes]{ };
+        size_t inputLength = length + TapCount - 1;
+        size_t i{ 0 };
+        for (; i + Lanes <= inputLength; i += Lanes)
+        {
+            for (size_t lane = 0; lane < Lanes; lane++)
+                peaks[lane] = std::max(peaks[lane], std::fabs(tile[i + lane]));
+        }
+        for (; i < inputLength; i++)
+            peaks[0] = std::max(peaks[0], std::fabs(tile[i]));
+
+        float tilePeak = *std::max_element(peaks, peaks + Lanes);
+        if (tilePeak * TruePeakGainBound <= peak)
+            continue;
+
+        std::fill(peaks, peaks + Lanes, 0.0f);
+        for (const auto& taps : TruePeakFilter)
+        {
+            std::fill(output, output + TileLength, 0.0f);
+            for (size_t tap = 0; tap < TapCount; tap++)
+            {
+                float coefficient = static_cast<float>(taps[tap]);
+                for (size_t i = 0; i < length; i++)
+                    output[i] += coefficient * tile[i + tap];
+            }
+
+            // Whole lanes are taken even for a short tile, whose unused
+            // outputs were cleared so they can't be the peak.
+            for (size_t i = 0; i < TileLength; i += Lanes)
+            {
+                for (size_t lane = 0; lane < Lanes; lane++)
+                {
+                    peaks[lane] = std::max(peaks[lane], 
+                                           std::fabs(output[i + lane]));
+                }
+            }
+        }
+        peak = std::max(peak, *std::max_element(peaks, peaks + Lanes));
+    }
+
+    return peak;
+}
+
+double LoudnessResult::TruePeakDbtp() const
+{
+    double peak{ 0 };
+    for (double channelPeak : channelTruePeaks)
+        peak = std::max(peak, channelPeak);
+
+    if (peak <= 0)
+        return -std::numeric_limits<double>::infinity();
+    return 20.0 * std::log10(peak);
+}
+
+size_t LoudnessAnalyzer::SubBlockLength(long sampleRate)
+{
+    return static_cast<size_t>(std::lround(sampleRate / 10.0));
+}
+
+void LoudnessAnalyzer::Reset(
+    int channelCount,
+    long sampleRate,
+    int bitsPerSample)
+{
+    channels = sampleRate > 0 && bitsPerSample > 0
+        ? std::max(channelCount, 0)
+        : 0;
+    sampleScale = bitsPerSample > 0 ? std::ldexp(1.0, 1 - bitsPerSample) : 0;
+    subBlockLength = SubBlockLength(sampleRate);
+    subBlockFill = 0;
+
+    shelfState.assign(channels * 2, 0);
+    highPassState.assign(channels * 2, 0);
+    subBlockSums.assign(channels, 0);
+    subBlockPowers.clear();
+    truePeaks.assign(channels, 0);
+    truePeakHistory.assign(channels * (TruePeakTaps - 1), 0);
+
+    channelWeights.assign(channels, 1.0);
+    if (channels == 5 || channels == 6)
+    {
+        channelWeights[channels - 2] = 1.41;
+        channelWeights[channels - 1] = 1.41;
+        if (channels == 6)
+            channelWeights[3] = 0;
+    }
+
+    if (channels == 0)
+        return;
+
+    // The K-weighting filter is specified at 48 kHz; the analog prototypes
+    // of its two stages are matched at any other rate.
+    double rate = static_cast<double>(sampleRate);
+    double k = std::tan(Pi * 1681.974450955533 / rate);
+    double q = 0.7071752369554196;
+    double vh = std::pow(10.0, 3.999843853973347 / 20.0);
+    double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    shelf.b0 = (vh + vb * k / q + k * k) / a0;
+    shelf.b1 = 2.0 * (k * k - vh) / a0;
+    shelf.b2 = (vh - vb * k / q + k * k) / a0;
+    shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+    shelf.a2 = (1.0 - k / q + k * k) / a0;
+
+    k = std::tan(Pi * 38.13547087602444 / rate);
+    q = 0.5003270373238773;
+    a0 = 1.0 + k / q + k * k;
+    highPass.b0 = 1.0;
+    highPass.b1 = -2.0;
+    highPass.b2 = 1.0;
+    highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+    highPass.a2 = (1.0 - k / q + k * k) / a0;
+}
+
+void LoudnessAnalyzer::AddInterleaved(const std::int32_t* samples, size_t count)
+{
+    if (channels == 0)
+        return;
+
+    size_t frameCount = count / channels;
+    frames.resize(frameCount * channels);
+    for (size_t i = 0; i < frames.size(); i++)
+        frames[i] = samples[i] * sampleScale;
+    AddFrames(frameCount);
+}
+
+void LoudnessAnalyzer::AddPlanar(
+    const std::int32_t* const* samples,
+    size_t frameCount)
+{
+    if (channels == 0)
+        return;
+
+    frames.resize(frameCount * channels);
+    for (int channel = 0; channel < channels; channel++)
+    {
+        const std::int32_t* channelSamples = samples[channel];
+        for (size_t i = 0; i < frameCount; i++)
+            frames[i * channels + channel] = channelSamples[i] * sampleScale;
+    }
+    AddFrames(frameCount);
+}
+
+void LoudnessAnalyzer::AddFrames(size_t frameCount)
+{
+    // Filtered up to each 100 ms boundary in turn, so the sums are taken
+    // there rather than checked for on every frame.
+    const double* input = frames.data();
+    size_t remaining = frameCount;
+    while (remaining > 0)
+    {
+        size_t count = std::min(remaining, subBlockLength - subBlockFill);
+        FilterFrames(input, count);
+        input += count * channels;
+        remaining -= count;
+        subBlockFill += count;
+
+        if (subBlockFill == subBlockLength)
+        {
+            double power{ 0 };
+            for (int channel = 0; channel < channels; channel++)
+            {
+                power += channelWeights[channel] * subBlockSums[channel];
+                subBlockSums[channel] = 0;
+            }
+            subBlockPowers.push_back(power / subBlockLength);
+            subBlockFill = 0;
+        }
+    }
+
+    MeasureTruePeaks(frameCount);
+}
+
+void LoudnessAnalyzer::FilterFrames(const double* input, size_t frameCount)
+{
+    switch (channels)
+    {
+        case 1:
+            Filter<1>(input, frameCount);
+            break;
+        case 2:
+            Filter<2>(input, frameCount);
+            break;
+        default:
+            Filter<0>(input, frameCount);
+            break;
+    }
+}
+
+template <int Channels>
+void LoudnessAnalyzer::Filter(const double* input, size_t frameCount)
+{
+    // A channel count of 0 stands for any count, taken at run time. The
+    // fixed counts get their state in local arrays the compiler can keep
+    // in registers across the loop.
+    constexpr int MaxLocal = Channels > 0 ? Channels : 1;
+    const int count = Channels > 0 ? Channels : channels;
+    double* shelfDelays = shelfState.data();
+    double* highPassDelays = highPassState.data();
+    double* sums = subBlockSums.data();
+
+    double shelf1[MaxLocal];
+    double shelf2[MaxLocal];
+    double highPass1[MaxLocal];
+    double highPass2[MaxLocal];
+    double sum[MaxLocal];
+    if constexpr (Channels > 0)
+    {
+        for (int channel = 0; channel < Channels; channel++)
+        {
+            shelf1[channel] = shelfDelays[channel * 2];
+            shelf2[channel] = shelfDelays[channel * 2 + 1];
+            highPass1[channel] = highPassDelays[channel * 2];
+            highPass2[channel] = highPassDelays[channel * 2 + 1];
+            sum[channel] = sums[channel];
+        }
+    }
+
+    const Biquad s = shelf;
+    const Biquad h = highPass;
+    for (size_t frame = 0; frame < frameCount; frame++)
+    {
+        const double* sample = input + frame * count;
+        for (int channel = 0; channel < count; channel++)
+        {
+            double& z1 = Channels > 0 ? shelf1[channel]
+                                      : shelfDelays[channel * 2];
+            double& z2 = Channels > 0 ? shelf2[channel]
+                                      : shelfDelays[channel * 2 + 1];
+            double& w1 = Channels > 0 ? highPass1[channel]
+                                      : highPassDelays[channel * 2];
+            double& w2 = Channels > 0 ? highPass2[channel]
+                                      : highPassDelays[channel * 2 + 1];
+            double& total = Channels > 0 ? sum[channel] : sums[channel];
+
+            double x = sample[channel];
+            double y = s.b0 * x + z1;
+            z1 = s.b1 * x - s.a1 * y + z2;
+            z2 = s.b2 * x - s.a2 * y;
+
+            double weighted = h.b0 * y + w1;
+            w1 = h.b1 * y - h.a1 * weighted + w2;
+            w2 = h.b2 * y - h.a2 * weighted;
+            total += weighted * weighted;
+        }
+    }
+
+    if constexpr (Channels > 0)
+    {
+        for (int channel = 0; channel < Channels; channel++)
+        {
+            shelfDelays[channel * 2] = shelf1[channel];
+            shelfDelays[channel * 2 + 1] = shelf2[channel];
+            highPassDelays[channel * 2] = highPass1[channel];
+            highPassDelays[channel * 2 + 1] = highPass2[channel];
+            sums[channel] = sum[channel];
+        }
+    }
+}
+
+void LoudnessAnalyzer::MeasureTruePeaks(size_t frameCount)
+{
+    constexpr size_t HistoryLength{ TruePeakTaps - 1 };
+    channelSamples.resize(HistoryLength + frameCount);
+
+    for (int channel = 0; channel < channels; channel++)
+    {
+        float* history = &truePeakHistory[channel * HistoryLength];
+        std::copy(history, history + HistoryLength, channelSamples.begin());
+
+        for (size_t i = 0; i < frameCount; i++)
+        {
+            channelSamples[HistoryLength + i] = 
+                static_cast<float>(frames[i * channels + channel]);
+        }
+
+        // Once a file's loudest passage is found, few tiles of samples are
+        // loud enough to need oversampling.
+        truePeaks[channel] = OversampledPeak(
+            channelSamples.data(), frameCount, truePeaks[channel]);
+
+        std::copy(channelSamples.end() - HistoryLength, channelSamples.end(),
+                  history);
+    }
+}
+
+void LoudnessAnalyzer::Begin(const SampleFormat& format)
+{
+    Reset(format.channels, format.sampleRate, format.bitsPerSample);
+}
+
+void LoudnessAnalyzer::Process(const SampleBlock& block)
+{
+    const std::int32_t* interleaved = block.Interleaved();
+    if (interleaved != nullptr)
+        AddInterleaved(interleaved, block.SampleCount());
+    else
+        AddPlanar(block.channels, block.frameCount);
+}
+
+void LoudnessAnalyzer::Prime(const SampleBlock& block)
+{
+    if (channels == 0 || block.channelCount != channels)
+        return;
+
+    size_t frameCount = block.frameCount;
+    frames.resize(frameCount * channels);
+    for (size_t i = 0; i < frameCount; i++)
+    {
+        for (int channel = 0; channel < channels; channel++)
+        {
+            frames[i * channels + channel] = 
+                block.Sample(channel, i) * sampleScale;
+        }
+    }
+
+    // The filter's output is only wanted for its state, so the sums it
+    // leaves are cleared rather than counted in the first 100 ms.
+    FilterFrames(frames.data(), frameCount);
+    std::fill(subBlockSums.begin(), subBlockSums.end(), 0.0);
+
+    constexpr size_t HistoryLength{ TruePeakTaps - 1 };
+    size_t kept = std::min(frameCount, HistoryLength);
+    for (int channel = 0; channel < channels; channel++)
+    {
+        float* history = &truePeakHistory[channel * HistoryLength];
+        std::copy(history + kept, history + HistoryLength, history);
+        for (size_t i = 0; i < kept; i++)
+        {
+            size_t frame = frameCount - kept + i;
+            history[HistoryLength - kept + i] = 
+                static_cast<float>(frames[frame * channels + channel]);
+        }
+    }
+}
+
+void LoudnessAnalyzer::Append(const SampleAnalyzer& next)
+{
+    const auto& other = static_cast<const LoudnessAnalyzer&>(next);
+    if (other.channels != channels || other.subBlockLength != subBlockLength)
+        return;
+
+    // Only the last part ends part way through 100 ms, unless the file
+    // was shorter than its header said, so the samples left over in this
+    // one's sums are dropped rather than mixed with the next part's.
+    subBlockPowers.insert(subBlockPowers.end(), 
+                          other.subBlockPowers.begin(), 
+                          other.subBlockPowers.end());
+    for (int channel = 0; channel < channels; channel++)
+        truePeaks[channel] = std::max(truePeaks[channel], 
+                                      other.truePeaks[channel]);
+
+    // The state the next part was left in is where the whole would be.
+    shelfState = other.shelfState;
+    highPassState = other.highPassState;
+    subBlockSums = other.subBlockSums;
+    subBlockFill = other.subBlockFill;
+    truePeakHistory = other.truePeakHistory;
+}
+
+LoudnessResult LoudnessAnalyzer::Result() const
+{
+    LoudnessResult result;
+    if (channels == 0)
+        return result;
+
+    result.measured = true;
+    result.channelTruePeaks.assign(truePeaks.begin(), truePeaks.end());
+
+    std::vector<double> momentary = GateWindows(
+        WindowPowers(subBlockPowers, MomentarySubBlocks),
+        IntegratedRelativeGate);
+    double sum{ 0 };
+    for (double power : momentary)
+        sum += power;
+    result.integratedLoudness = momentary.empty()
+        ? -std::numeric_limits<double>::infinity()
+        : ToLoudness(sum / momentary.size());
+
+    std::vector<double> shortTerm = GateWindows(
+        WindowPowers(subBlockPowers, ShortTermSubBlocks),
+        RangeRelativeGate);
+    if (!shortTerm.empty())
+    {
+        std::sort(shortTerm.begin(), shortTerm.end());
+        size_t last = shortTerm.size() - 1;
+        size_t low = static_cast<size_t>(
+            std::lround(last * RangeLowPercentile));
+        size_t high = static_cast<size_t>(
+            std::lround(last * RangeHighPercentile));
+        result.loudnessRange =
+            ToLoudness(shortTerm[high]) - ToLoudness(shortTerm[low]);
+    }
+
+    return result;
+}
@@ -0,0 +1,235 @@
+// LowBitAnalyzer.cpp - Defines the LowBitAnalyzer class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <algorithm>
+#include "LowBitAnalyzer.h"
+
+/// @brief The upper bits of a sample rounded to the nearest multiple of
+/// 256, which is the sample less its low byte taken as a signed residual.
+static std::int32_t UpperBits(std::int32_t sample)
+{
+    return (sample >> 8) + ((sample >> 7) & 1);
+}
+
+void LowBitAnalyzer::Reset(int channelCount)
+{
+    accumulators.assign(std::max(channelCount, 0), ChannelAccumulator{ });
+}
+
+void LowBitAnalyzer::ChannelAccumulator::Fold()
+{
+    for (int lane = 0; lane < Lanes; lane++)
+    {
+        for (int row = 0; row < Rows; row++)
+        {
+            for (int value = 0; value < ByteValues; value++)
+            {
+                totals[row][value] += lanes[lane][row][value];
+                lanes[lane][row][value] = 0;
+            }
+        }
+    }
+    unfoldedCount = 0;
+}
+
+void LowBitAnalyzer::Add(
+    int channel, 
+    const std::int32_t* samples, 
+    size_t count,
+    size_t stride)
+{
+    if (count == 0)
+        return;
+
+    ChannelAccumulator& accumulator = accumulators[channel];
+    if (accumulator.unfoldedCount + count > FoldInterval)
+        accumulator.Fold();
+
+    // The first sample of the file has nothing before it to step from.
+    std::int32_t previousUpper = accumulator.hasPrevious
+        ? accumulator.previousUpper 
+        : UpperBits(samples[0]);
+
+    // Consecutive samples go to consecutive lanes, which are merged when
+    // the result is taken, so a block can always start at the first one.
+    auto addSample = [&](std::int32_t sample, int lane)
+    {
+        std::int32_t upper = UpperBits(sample);
+        std::int32_t step = upper - previousUpper;
+        previousUpper = upper;
+
+        int row = 1 + (step == 1) - (step == -1);
+        accumulator.lanes[lane][row][sample & 0xFF]++;
+    };
+
+    size_t i{ 0 };
+    for (; i + Lanes <= count; i += Lanes)
+    {
+        for (int lane = 0; lane < Lanes; lane++)
+            addSample(samples[(i + lane) * stride], lane);
+    }
+    for (; i < count; i++)
+        addSample(samples[i * stride], 0);
+
+    accumulator.previousUpper = previousUpper;
+    accumulator.hasPrevious = true;
+    accumulator.sampleCount += count;
+    accumulator.unfoldedCount += count;
+}
+
+void LowBitAnalyzer::AddInterleaved(const std::int32_t* samples, size_t count)
+{
+    // Each channel is taken in turn across the whole block, rather than
+    // sample by sample, so its histogram is the only one being updated.
+    size_t channels = accumulators.size();
+    for (size_t channel = 0; channel < channels && channel < count; channel++)
+    {
+        size_t channelCount = (count - channel + channels - 1) / channels;
+        Add(channel, samples + channel, channelCount, channels);
+    }
+}
+
+void LowBitAnalyzer::Begin(const SampleFormat& format)
+{
+    Reset(format.bitsPerSample > 8 ? format.channels : 0);
+}
+
+void LowBitAnalyzer::Process(const SampleBlock& block)
+{
+    for (int channel = 0; channel < ChannelCount(); channel++)
+    {
+        Add(channel, block.channels[channel], block.frameCount, 
+            block.stride);
+    }
+}
+
+void LowBitAnalyzer::Prime(const SampleBlock& block)
+{
+    for (int channel = 0; channel < ChannelCount(); channel++)
+    {
+        ChannelAccumulator& accumulator = accumulators[channel];
+        accumulator.previousUpper = 
+            UpperBits(block.Sample(channel, block.frameCount - 1));
+        accumulator.hasPrevious = true;
+    }
+}
+
+void LowBitAnalyzer::Append(const SampleAnalyzer& next)
+{
+    const auto& other = static_cast<const LowBitAnalyzer&>(next);
+    if (other.accumulators.size() != accumulators.size())
+        return;
+
+    for (size_t channel = 0; channel < accumulators.size(); channel++)
+    {
+        ChannelAccumulator& accumulator = accumulators[channel];
+        const ChannelAccumulator& part = other.accumulators[channel];
+        for (int row = 0; row < Rows; row++)
+        {
+            for (int value = 0; value < ByteValues; value++)
+            {
+                std::uint64_t count = part.totals[row][value];
+                for (int lane = 0; lane < Lanes; lane++)
+                    count += part.lanes[lane][row][value];
+                accumulator.totals[row][value] += count;
+            }
+        }
+
+        accumulator.sampleCount += part.sampleCount;
+        if (part.hasPrevious)
+        {
+            accumulator.previousUpper = part.previousUpper;
+            accumulator.hasPrevious = true;
+        }
+    }
+}
+
+LowBitResult LowBitAnalyzer::Result() const
+{
+    LowBitResult result;
+    std::uint64_t totalSamples{ 0 };
+    double weightedScore{ 0 };
+
+    for (const ChannelAccumulator& accumulator : accumulators)
+    {
+        LowBitChannelStats stats;
+        stats.sampleCount = accumulator.sampleCount;
+
+        // Sums for the correlation over the samples in the step rows, taking
+        // the low byte as a signed residual. The step is +1 or -1, so its
+        // square sums to the count.
+        double n{ 0 };
+        double stepSum{ 0 };
+        double residualSum{ 0 };
+        double residualSquareSum{ 0 };
+        double productSum{ 0 };
+
+        for (int value = 0; value < ByteValues; value++)
+        {
+            std::uint64_t rowCounts[Rows]{ };
+            for (int row = 0; row < Rows; row++)
+            {
+                rowCounts[row] = accumulator.totals[row][value];
+                for (int lane = 0; lane < Lanes; lane++)
+                    rowCounts[row] += accumulator.lanes[lane][row][value];
+            }
+
+            std::uint64_t count = rowCounts[0] + rowCounts[1] + rowCounts[2];
+            if (count > 0)
+            {
+                double p = static_cast<double>(count) / stats.sampleCount;
+                stats.entropy -= p * std::log2(p);
+            }
+
+            double residual = static_cast<std::int8_t>(value);
+            double down = static_cast<double>(rowCounts[StepDownRow]);
+            double up = static_cast<double>(rowCounts[StepUpRow]);
+            n += down + up;
+            stepSum += up - down;
+            residualSum += residual * (down + up);
+            residualSquareSum += residual * residual * (down + up);
+            productSum += residual * (up - down);
+        }
+
+        // Pearson's correlation from the sums, which is 0 if either the
+        // residual or the step never varied.
+        double residualVariance = n * residualSquareSum - 
+                                  residualSum * residualSum;
+        double stepVariance = n * n - stepSum * stepSum;
+        if (residualVariance > 0 && stepVariance > 0)
+        {
+            double covariance = n * productSum - residualSum * stepSum;
+            stats.correlation = covariance /
+                std::sqrt(residualVariance * stepVariance);
+        }
+
+        // Over a few hundred steps independent noise still shows a small
+        // correlation by chance, so only what's beyond three standard errors
+        // counts against the score.
+        double noise = n > 0 ? 3.0 / std::sqrt(n) : 1.0;
+        double correlation = std::max(std::fabs(stats.correlation) - noise,
+                                      0.0);
+        double score = (1.0 - stats.entropy / 8.0) * (1.0 - correlation);
+        weightedScore += std::clamp(score, 0.0, 1.0) * stats.sampleCount;
+        totalSamples += stats.sampleCount;
+        result.channels.push_back(stats);
+    }
+
+    if (totalSamples > 0)
+        result.score = weightedScore / totalSamples;
+    return result;
+}
@@ -19,15 +19,10 @@
 enum ID
 {
     File = 1,
-    Analyze
-};
-
-enum Column
-{
-    FileName = 0,
-    BitDepth,
-    SampleRate,
-    IsUpscaled
+    Folder,
+    Analyze,
+    Pause,
+    Cancel
 };
 
 // catch the event from the thread
@@ -36,6 +31,9 @@ EVT_COMMAND(AnalysisThread::StatusUpdateID, wxEVT_COMMAND_TEXT_UPDATED,
             MainWindow::OnStatusUpdate)
 EVT_COMMAND(AnalysisThread::StatusCompleteID, wxEVT_COMMAND_TEXT_UPDATED,
             MainWindow::OnAnalysisComplete)
+EVT_THREAD(AnalysisThread::StatusResultsID, MainWindow::OnResults)
+EVT_THREAD(ImportThread::ImportResultsID, MainWindow::OnImportResults)
+EVT_THREAD(ImportThread::ImportCompleteID, MainWindow::OnImportComplete)
 END_EVENT_TABLE()
 
 MainWindow::MainWindow(wxString programInfo) : 
@@ -55,7 +53,13 @@ MainWindow::MainWindow(wxString programInfo) :
         fileMenu, ID::File, "&Open...\tCtrl-O", 
         "Opens audio files for analysis" 
     };
+    openFolderMenuItem = new wxMenuItem
+    {
+        fileMenu, ID::Folder, "Open &Folder...\tCtrl-Shift-O", 
+        "Opens every audio file in a folder and its subfolders" 
+    };
     fileMenu->Append(openMenuItem);
+    fileMenu->Append(openFolderMenuItem);
     fileMenu->AppendSeparator();
     fileMenu->Append(wxID_EXIT);
  
@@ -71,17 +75,39 @@ MainWindow::MainWindow(wxString programInfo) :
     CreateStatusBar();
     SetStatusText("Ready");
 
-    fileListView = new wxListView{ topPanel, wxID_ANY, 
-                                   wxDefaultPosition, wxSize{600, 400} };
-    fileListView->AppendColumn("File Name", wxLIST_FORMAT_LEFT, 300);
-    fileListView->AppendColumn("Bit Depth");
-    fileListView->AppendColumn("Sample Rate");
-    fileListView->AppendColumn("Is Upscaled");
+    wxBoxSizer* topSizer = new wxBoxSizer{ wxVERTICAL };
+    wxBoxSizer* filterSizer = new wxBoxSizer{ wxHORIZONTAL };
+
+    filterText = new wxTextCtrl{ topPanel, wxID_ANY };
+    filterText->SetHint("Filter by file name");
+    upscaledOnlyBox = new wxCheckBox{ topPanel, wxID_ANY, "Upscaled only" };
+    filterSizer->Add(filterText, 1, wxALL | wxEXPAND, 5);
+    filterSizer->Add(upscaledOnlyBox, 0, wxALL | wxCENTER, 5);
+
+    fileListView = new FileListView{ topPanel, fileTable, wxSize{600, 400} };
+    topSizer->Add(filterSizer, 0, wxEXPAND);
+    topSizer->Add(fileListView, 1, wxEXPAND);
+    topPanel->SetSizer(topSizer);
+
+    // Files and folders dropped on the list are added to it.
+    fileListView->SetDropTarget(new MediaDropTarget
+    {
+        [this](std::vector<std::string> paths)
+        {
+            StartImport(std::move(paths), false);
+        }
+    });
 
     analyzeButton = new wxButton{ bottomPanel, ID::Analyze, "Analyze" };
+    pauseButton = new wxButton{ bottomPanel, ID::Pause, "Pause" };
+    cancelButton = new wxButton{ bottomPanel, ID::Cancel, "Cancel" };
+    pauseButton->Enable(false);
+    cancelButton->Enable(false);
     progressBar = new wxGauge{ bottomPanel, wxID_ANY, 100, 
                                wxDefaultPosition, wxSize{ 200, 20 } };
     bottomSizer->Add(analyzeButton, 0, wxALL, 5);
+    bottomSizer->Add(pauseButton, 0, wxALL, 5);
+    bottomSizer->Add(cancelButton, 0, wxALL, 5);
     bottomSizer->Add(progressBar, 0, wxALL | wxCENTER, 5);
     bottomPanel->SetSizerAndFit(bottomSizer);
  
@@ -94,56 +120,50 @@ MainWindow::MainWindow(wxString programInfo) :
     logger->Add(logFile.get());
 
     Bind(wxEVT_MENU, &MainWindow::OnOpen, this, ID::File);
+    Bind(wxEVT_MENU, &MainWindow::OnOpenFolder, this, ID::Folder);
     Bind(wxEVT_MENU, &MainWindow::OnAbout, this, wxID_ABOUT);
     Bind(wxEVT_MENU, &MainWindow::OnExit, this, wxID_EXIT);
     Bind(wxEVT_BUTTON, &MainWindow::OnAnalyze, this, ID::Analyze);
+    Bind(wxEVT_BUTTON, &MainWindow::OnPause, this, ID::Pause);
+    Bind(wxEVT_BUTTON, &MainWindow::OnCancel, this, ID::Cancel);
+    fileListView->Bind(wxEVT_LIST_COL_CLICK, &MainWindow::OnColumnClick, 
+                       this);
+    filterText->Bind(wxEVT_TEXT, &MainWindow::OnFilterChanged, this);
+    upscaledOnlyBox->Bind(wxEVT_CHECKBOX, &MainWindow::OnFilterChanged, 
+                          this);
 }
 
 void MainWindow::OnOpen(wxCommandEvent& event)
 {
     wxFileDialog dialog(this, _("Open media file"), "", "",
-                        "Media files (*.wav;*.flac)|*.wav;*.flac", 
+                        "Media files (*.wav;*.flac;*.aif;*.aiff;*.aifc)|"
+                        "*.wav;*.flac;*.aif;*.aiff;*.aifc", 
                         wxFD_OPEN | wxFD_FILE_MUST_EXIST | wxFD_MULTIPLE);
 
     if (dialog.ShowModal() == wxID_OK)
     {
-        fileList.clear();
         wxArrayString paths;
         dialog.GetPaths(paths);
 
-        for (wxString path : paths)
-        {
-            std::string pathString = path.ToStdString();
-            std::filesystem::path filePath{ pathString };
-            std::string fileName{ filePath.stem().string() };
-            std::string extension { filePath.extension().string() };
-
-            std::shared_ptr<MediaFile> file;
-            if (extension == ".wav")
-            {
-                file = std::make_shared<WaveFile>(pathString, logger);
-            }  
-            else if (extension == ".flac")
-            {
-                file = std::make_shared<FlacFile>(pathString, logger);
-            }   
-            else
-            {
-                wxMessageBox("Unsupported file type!", "Error", 
-                            wxOK | wxICON_ERROR);
-            }
-
-            file->Open();
-            if (!file->IsOpen())
-                ShowError("Unable to open file!");
-
-            fileList.push_back(file);
-        }
+        // Nothing is opened here; files that can't be read show as errors
+        // once the import reaches them.
+        std::vector<std::string> roots;
+        for (const wxString& path : paths)
+            roots.push_back(path.ToStdString());
             
-        PopulateFileListView();
+        StartImport(std::move(roots), true);
     }
 }
 
+void MainWindow::OnOpenFolder(wxCommandEvent& event)
+{
+    wxDirDialog dialog(this, _("Open folder"), "", 
+                       wxDD_DEFAULT_STYLE | wxDD_DIR_MUST_EXIST);
+
+    if (dialog.ShowModal() == wxID_OK)
+        StartImport({ dialog.GetPath().ToStdString() }, true);
+}
+
 void MainWindow::OnExit(wxCommandEvent& event)
 {
     Close(true);
@@ -160,8 +180,17 @@ void MainWindow::OnAnalyze(wxCommandEvent& event)
 {
     analyzeButton->Enable(false);
     openMenuItem->Enable(false);
+    openFolderMenuItem->Enable(false);
+    pauseButton->SetLabel("Pause");
+    pauseButton->Enable(true);
+    cancelButton->Enable(true);
+    progressBar->SetValue(0);
 
-    AnalysisThread* thread = new AnalysisThread{ this, fileList };
+    analysisControl = std::make_shared<AnalysisControl>();
+    AnalysisThread* thread = new AnalysisThread
+    { 
+        this, TablePaths(), logger, analysisControl 
+    };
     wxThreadError error = thread->Create();
     if (error != wxTHREAD_NO_ERROR)
         ShowError("Could not create thread to analyze audio!");
@@ -171,54 +200,204 @@ void MainWindow::OnAnalyze(wxCommandEvent& event)
         ShowError("Could not run thread to analyze audio!");
 }
 
+void MainWindow::OnPause(wxCommandEvent& event)
+{
+    if (analysisControl == nullptr)
+        return;
+
+    if (analysisControl->IsPaused())
+    {
+        analysisControl->Resume();
+        pauseButton->SetLabel("Pause");
+        SetStatusText("Resuming...");
+    }
+    else
+    {
+        analysisControl->Pause();
+        pauseButton->SetLabel("Resume");
+        SetStatusText("Paused");
+    }
+}
+
+void MainWindow::OnCancel(wxCommandEvent& event)
+{
+    if (analysisControl == nullptr)
+        return;
+
+    analysisControl->Cancel();
+    pauseButton->Enable(false);
+    cancelButton->Enable(false);
+    SetStatusText("Cancelling...");
+}
+
 void MainWindow::OnStatusUpdate(wxCommandEvent& event)
 {
+    // Progress posted just before a pause or cancel shouldn't overwrite it.
+    if (analysisControl != nullptr && 
+        (analysisControl->IsPaused() || analysisControl->IsCancelled()))
+    {
+        return;
+    }
+
     progressBar->SetValue(event.GetInt());
     SetStatusText(event.GetString());
 }
 
+void MainWindow::OnResults(wxThreadEvent& event)
+{
+    for (const FileResult& result : 
+         event.GetPayload<std::vector<FileResult>>())
+    {
+        fileTable.SetFormat(result.row, result.bitsPerSample, 
+                            result.sampleRate);
+        fileTable.SetVerdict(result.row, result.verdict);
+    }
+
+    ShowResults();
+}
+
+void MainWindow::OnImportResults(wxThreadEvent& event)
+{
+    if (event.GetInt() != importSession)
+        return;
+
+    // Files already in the list, such as from a folder dropped twice, are
+    // skipped.
+    size_t firstRow = fileTable.RowCount();
+    for (const ImportedFile& file : 
+         event.GetPayload<std::vector<ImportedFile>>())
+    {
+        size_t row = fileTable.Add(file.path);
+        if (row == FileTable::NoRow)
+            continue;
+
+        fileTable.SetFormat(row, file.bitsPerSample, file.sampleRate);
+        if (file.failed)
+            fileTable.SetVerdict(row, FileVerdict::Failed);
+    }
+
+    fileTable.ExtendView(firstRow);
+    fileListView->RefreshView();
+
+    if (analysisControl == nullptr)
+    {
+        std::stringstream status;
+        status << "Importing... " << fileTable.RowCount() << " files";
+        SetStatusText(status.str());
+    }
+}
+
+void MainWindow::OnImportComplete(wxThreadEvent& event)
+{
+    if (event.GetInt() != importSession || analysisControl != nullptr)
+        return;
+
+    std::stringstream status;
+    status << fileTable.RowCount() << " files";
+    SetStatusText(status.str());
+}
+
 void MainWindow::OnAnalysisComplete(wxCommandEvent& event)
 {
+    bool cancelled = event.GetInt() != 0;
+    analysisControl.reset();
     analyzeButton->Enable(true);
     openMenuItem->Enable(true);
-    progressBar->SetValue(100);
-    UpdateFileListView();
-    SetStatusText("Ready");
+    openFolderMenuItem->Enable(true);
+    pauseButton->SetLabel("Pause");
+    pauseButton->Enable(false);
+    cancelButton->Enable(false);
+    if (!cancelled)
+        progressBar->SetValue(100);
+
+    RefreshFileListView();
+    SetStatusText(cancelled ? "Analysis cancelled" : "Ready");
+}
+
+void MainWindow::OnColumnClick(wxListEvent& event)
+{
+    int column = event.GetColumn();
+    if (column < 0)
+        return;
+
+    // Clicking the sorted column again reverses it.
+    FileTable::Column sortColumn = static_cast<FileTable::Column>(column);
+    bool ascending = sortColumn != fileTable.SortColumn() || 
+                     !fileTable.IsSortAscending();
+    fileTable.SetSort(sortColumn, ascending);
+    RefreshFileListView();
+}
+
+void MainWindow::OnFilterChanged(wxCommandEvent& event)
+{
+    fileTable.SetFilter(filterText->GetValue().ToStdString(), 
+                        upscaledOnlyBox->IsChecked());
+    RefreshFileListView();
 }
 
 void MainWindow::PopulateFileListView()
 {
-    fileListView->DeleteAllItems();
+    RefreshFileListView();
+}
 
-    int itemIndex{ 0 };
-    for (std::shared_ptr<MediaFile> file : fileList)
+void MainWindow::StartImport(
+    std::vector<std::string> roots, 
+    bool newSelection)
+{
+    if (newSelection)
     {
-        std::filesystem::path path{ file->FileName() };
-        fileListView->InsertItem(itemIndex, path.filename().string());
-        itemIndex++;
+        if (importControl != nullptr)
+            importControl->Cancel();
+
+        importSession++;
+        importControl.reset();
+        fileTable.Clear();
+        PopulateFileListView();
     }
-}
 
-void MainWindow::UpdateFileListView()
-{
-    int itemIndex{ 0 };
-    for (std::shared_ptr<MediaFile> file : fileList)
+    if (importControl == nullptr)
+        importControl = std::make_shared<AnalysisControl>();
+
+    if (analysisControl == nullptr)
+        SetStatusText("Importing...");
+
+    ImportThread* thread = new ImportThread
+    {
+        this, std::move(roots), importSession, importControl
+    };
+    if (thread->Create() != wxTHREAD_NO_ERROR || 
+        thread->Run() != wxTHREAD_NO_ERROR)
     {
-        std::filesystem::path path{ file->FileName() };
-        fileListView->SetItem(itemIndex, Column::FileName, 
-                              path.filename().string());
-        fileListView->SetItem(itemIndex, Column::BitDepth, 
-                              std::to_string(file->BitsPerSample()));
-        fileListView->SetItem(itemIndex, Column::SampleRate, 
-                              std::to_string(file->SampleRate()));
-        if (file->IsUpscaled())
-            fileListView->SetItem(itemIndex, Column::IsUpscaled, "Yes");
-        else
-            fileListView->SetItem(itemIndex, Column::IsUpscaled, "No");
-        itemIndex++;
+        ShowError("Could not run thread to import files!");
     }
 }
 
+std::vector<std::string> MainWindow::TablePaths() const
+{
+    std::vector<std::string> paths;
+    paths.reserve(fileTable.RowCount());
+    for (size_t row = 0; row < fileTable.RowCount(); row++)
+        paths.push_back(fileTable.Path(row));
+
+    return paths;
+}
+
+void MainWindow::ShowResults()
+{
+    // Sorting a large table again for every batch would stall the window,
+    // so the view is only rebuilt when the results can change it.
+    if (fileTable.ViewDependsOnResults())
+        RefreshFileListView();
+    else
+        fileListView->Refresh();
+}
+
+void MainWindow::RefreshFileListView()
+{
+    fileTable.UpdateView();
+    fileListView->RefreshView();
+}
+
 void MainWindow::ShowError(wxString message)
 {
     wxMessageBox(message, "AudioResolutionAnalyzer", wxOK | wxICON_ERROR);
@@ -0,0 +1,76 @@
+// MappedFile.cpp - Defines the MappedFile class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "MappedFile.h"
+#include "FileDescriptor.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+MappedFile::MappedFile(std::string fileName) :
+    fileName{ fileName },
+    mapping{ nullptr },
+    mappingSize{ 0 }
+{ }
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+void MappedFile::Open()
+{
+    if (IsOpen())
+        return;
+
+#ifndef _WIN32
+    int descriptor = OpenDescriptor(fileName, ReadOnlyFlags);
+    if (descriptor < 0)
+        return;
+
+    // The mapping keeps the file referenced, so the descriptor isn't needed
+    // once it exists.
+    std::uint64_t size = DescriptorSize(descriptor);
+    if (size > 0)
+    {
+        void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, 
+                             descriptor, 0);
+        if (address != MAP_FAILED)
+        {
+            madvise(address, size, MADV_SEQUENTIAL);
+            mapping = address;
+            mappingSize = size;
+            SetData(mapping, mappingSize);
+        }
+    }
+
+    CloseDescriptor(descriptor);
+#endif
+}
+
+void MappedFile::Close()
+{
+    if (!IsOpen())
+        return;
+
+#ifndef _WIN32
+    munmap(mapping, mappingSize);
+#endif
+    mapping = nullptr;
+    mappingSize = 0;
+    SetData(nullptr, 0);
+}
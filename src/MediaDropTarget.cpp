@@ -0,0 +1,30 @@
+// MediaDropTarget.cpp - Defines the MediaDropTarget class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "MediaDropTarget.h"
+
+bool MediaDropTarget::OnDropFiles(
+    wxCoord x, 
+    wxCoord y, 
+    const wxArrayString& fileNames)
+{
+    std::vector<std::string> paths;
+    for (const wxString& fileName : fileNames)
+        paths.push_back(fileName.ToStdString());
+
+    handler(std::move(paths));
+    return true;
+}
@@ -0,0 +1,89 @@
+// MediaFile.cpp - Defines the functions declared with the MediaFile class.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "MediaFile.h"
+#include "WaveFile.h"
+#include "FlacFile.h"
+#include "AiffFile.h"
+
+MediaFile::MediaFile()
+{
+    analyzers.Add(std::make_shared<UpscaleAnalyzer>());
+    analyzers.Add(std::make_shared<EffectiveBitsAnalyzer>());
+    analyzers.Add(std::make_shared<LowBitAnalyzer>());
+    analyzers.Add(std::make_shared<DistinctValueAnalyzer>());
+    analyzers.Add(std::make_shared<LevelAnalyzer>());
+    analyzers.Add(std::make_shared<LoudnessAnalyzer>());
+}
+
+bool MediaFile::IsUpscaled() const
+{
+    std::shared_ptr<UpscaleAnalyzer> upscale = 
+        analyzers.Find<UpscaleAnalyzer>();
+    return upscale != nullptr && upscale->IsUpscaled();
+}
+
+LowBitResult MediaFile::LowBits() const
+{
+    std::shared_ptr<LowBitAnalyzer> lowBits = analyzers.Find<LowBitAnalyzer>();
+    return lowBits != nullptr ? lowBits->Result() : LowBitResult{ };
+}
+
+DistinctValueResult MediaFile::DistinctValues() const
+{
+    std::shared_ptr<DistinctValueAnalyzer> distinctValues = 
+        analyzers.Find<DistinctValueAnalyzer>();
+    return distinctValues != nullptr ? distinctValues->Result() 
+                                     : DistinctValueResult{ };
+}
+
+LevelResult MediaFile::Levels() const
+{
+    std::shared_ptr<LevelAnalyzer> levels = analyzers.Find<LevelAnalyzer>();
+    return levels != nullptr ? levels->Result() : LevelResult{ };
+}
+
+LoudnessResult MediaFile::Loudness() const
+{
+    std::shared_ptr<LoudnessAnalyzer> loudness = 
+        analyzers.Find<LoudnessAnalyzer>();
+    return loudness != nullptr ? loudness->Result() : LoudnessResult{ };
+}
+
+std::shared_ptr<MediaFile> CreateMediaFile(
+    std::string fileName, 
+    std::shared_ptr<Logging::Logger> logger)
+{
+    return CreateMediaFile(GetType(fileName), fileName, logger);
+}
+
+std::shared_ptr<MediaFile> CreateMediaFile(
+    MediaFileType type,
+    std::string fileName, 
+    std::shared_ptr<Logging::Logger> logger)
+{
+    switch (type)
+    {
+        case MediaFileType::Wave:
+            return std::make_shared<WaveFile>(fileName, logger);
+        case MediaFileType::Flac:
+            return std::make_shared<FlacFile>(fileName, logger);
+        case MediaFileType::Aiff:
+            return std::make_shared<AiffFile>(fileName, logger);
+        default:
+            return nullptr;
+    }
+}
@@ -0,0 +1,58 @@
+// MediaFileType.cpp - Defines the MediaFileType functions.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <filesystem>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include "MediaFileType.h"
+
+MediaFileType GetType(std::string fileName)
+{
+    std::filesystem::path path = std::filesystem::path{ fileName };
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::toupper);
+    
+    if (ext == ".WAV")
+        return MediaFileType::Wave;
+    else if (ext == ".FLAC")
+        return MediaFileType::Flac;
+    else if (ext == ".AIF" || ext == ".AIFF" || ext == ".AIFC")
+        return MediaFileType::Aiff;
+    return MediaFileType::Unsupported;
+}
+
+MediaFileType DetectType(const void* header, size_t size)
+{
+    const char* bytes = static_cast<const char*>(header);
+
+    // FLAC files may start with an ID3v2 tag, which libFLAC skips.
+    if (size >= 4 && (std::memcmp(bytes, "fLaC", 4) == 0 || 
+                      std::memcmp(bytes, "ID3", 3) == 0))
+        return MediaFileType::Flac;
+
+    if (size < TypeSignatureSize)
+        return MediaFileType::Unsupported;
+
+    if (std::memcmp(bytes, "RIFF", 4) == 0 && 
+        std::memcmp(bytes + 8, "WAVE", 4) == 0)
+        return MediaFileType::Wave;
+    else if (std::memcmp(bytes, "FORM", 4) == 0 && 
+             (std::memcmp(bytes + 8, "AIFF", 4) == 0 || 
+              std::memcmp(bytes + 8, "AIFC", 4) == 0))
+        return MediaFileType::Aiff;
+    return MediaFileType::Unsupported;
+}
@@ -0,0 +1,314 @@
+// MediaProbe.cpp - Defines the media file probe functions.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sstream>
+#include <cstring>
+#include <limits>
+#include "MediaProbe.h"
+#include "FileReader.h"
+#include "ByteOrder.h"
+#include "WaveFile.h"
+#include "AiffFile.h"
+#include "FlacFile.h"
+
+// Headers are small, so a probe reads through a small buffer instead of the
+// megabyte FileReader uses by default for streaming sample data.
+static constexpr size_t ProbeBufferSize{ 4096 };
+
+static std::string FormatTag(std::uint32_t audioFormat)
+{
+    if (audioFormat == WaveFile::WaveFormatPcm)
+        return "WAVE PCM";
+    else if (audioFormat == WaveFile::WaveFormatExtensible)
+        return "WAVE Extensible";
+
+    std::stringstream tag;
+    tag << "WAVE 0x" << std::hex << audioFormat;
+    return tag.str();
+}
+
+static void ProbeWave(ByteSource& reader, ProbeResult& result)
+{
+    std::uint8_t header[12];
+    if (reader.Read(header, sizeof(header)) != sizeof(header) ||
+        std::memcmp(header, "RIFF", 4) != 0 ||
+        std::memcmp(header + 8, "WAVE", 4) != 0)
+    {
+        result.error = "Not a RIFF WAVE file";
+        return;
+    }
+
+    int blockAlign = 0;
+    while (true)
+    {
+        std::uint8_t chunkHeader[8];
+        if (reader.Read(chunkHeader, sizeof(chunkHeader)) != 8)
+        {
+            result.error = "No data chunk found";
+            return;
+        }
+
+        std::uint32_t size = DecodeLittleEndian(chunkHeader + 4, 4);
+        std::uint64_t next = reader.Position() + size + (size & 1);
+
+        if (std::memcmp(chunkHeader, "fmt ", 4) == 0)
+        {
+            std::uint8_t format[16];
+            if (size < sizeof(format) || 
+                reader.Read(format, sizeof(format)) != sizeof(format))
+            {
+                result.error = "Invalid format chunk";
+                return;
+            }
+
+            result.format = FormatTag(DecodeLittleEndian(format, 2));
+            result.channels = DecodeLittleEndian(format + 2, 2);
+            result.sampleRate = DecodeLittleEndian(format + 4, 4);
+            blockAlign = DecodeLittleEndian(format + 12, 2);
+            result.bitsPerSample = DecodeLittleEndian(format + 14, 2);
+        }
+        else if (std::memcmp(chunkHeader, "data", 4) == 0)
+        {
+            // Streamed WAVE files may leave the size as a placeholder, in
+            // which case the data runs to the end of the file. The number of
+            // samples in a stream isn't known until it ends, so it is left 0.
+            std::uint64_t dataSize = size;
+            std::uint64_t position = reader.Position();
+            if (WaveFile::IsPlaceholderSize(size,
+                    DecodeLittleEndian(header + 4, 4), position,
+                    result.fileSize))
+            {
+                dataSize = result.fileSize > position 
+                    ? result.fileSize - position : 0;
+            }
+
+            if (blockAlign > 0)
+                result.totalSamples = dataSize / blockAlign;
+            return;
+        }
+
+        reader.Seek(next);
+    }
+}
+
+static void ProbeFlac(ByteSource& reader, ProbeResult& result)
+{
+    std::uint8_t marker[4];
+    if (reader.Read(marker, sizeof(marker)) != sizeof(marker))
+    {
+        result.error = "Not a FLAC file";
+        return;
+    }
+
+    // FLAC files are sometimes prefixed with an ID3v2 tag, which libFLAC
+    // skips too. Its size is stored as a 28-bit "syncsafe" integer.
+    if (std::memcmp(marker, "ID3", 3) == 0)
+    {
+        std::uint8_t tagHeader[6];
+        if (reader.Read(tagHeader, sizeof(tagHeader)) != sizeof(tagHeader))
+        {
+            result.error = "Truncated ID3 tag";
+            return;
+        }
+
+        std::uint32_t tagSize = (tagHeader[2] & 0x7F) << 21 | 
+                                (tagHeader[3] & 0x7F) << 14 |
+                                (tagHeader[4] & 0x7F) << 7 | 
+                                (tagHeader[5] & 0x7F);
+        reader.Seek(10 + tagSize);
+        if (reader.Read(marker, sizeof(marker)) != sizeof(marker))
+        {
+            result.error = "Not a FLAC file";
+            return;
+        }
+    }
+
+    // STREAMINFO must be the first metadata block, so the probe only ever
+    // needs the block header plus its 34 bytes.
+    std::uint8_t block[4 + 34];
+    if (std::memcmp(marker, "fLaC", 4) != 0 || 
+        reader.Read(block, sizeof(block)) != sizeof(block) ||
+        (block[0] & 0x7F) != 0)
+    {
+        result.error = "FLAC STREAMINFO not found";
+        return;
+    }
+
+    // After the block and frame size fields, STREAMINFO packs a 20-bit
+    // sample rate, 3-bit channel count - 1, 5-bit bits per sample - 1 and
+    // 36-bit total sample count into 8 bytes.
+    const std::uint8_t* info = block + 4 + 10;
+    result.format = "FLAC";
+    result.sampleRate = info[0] << 12 | info[1] << 4 | info[2] >> 4;
+    result.channels = ((info[2] >> 1) & 0x07) + 1;
+    result.bitsPerSample = ((info[2] & 0x01) << 4 | info[3] >> 4) + 1;
+    result.totalSamples = static_cast<std::uint64_t>(info[3] & 0x0F) << 32 |
+                          static_cast<std::uint64_t>(info[4]) << 24 |
+                          info[5] << 16 | info[6] << 8 | info[7];
+}
+
+static void ProbeAiff(ByteSource& reader, ProbeResult& result)
+{
+    std::uint8_t header[12];
+    if (reader.Read(header, sizeof(header)) != sizeof(header) ||
+        std::memcmp(header, "FORM", 4) != 0 ||
+        (std::memcmp(header + 8, "AIFF", 4) != 0 &&
+         std::memcmp(header + 8, "AIFC", 4) != 0))
+    {
+        result.error = "Not an AIFF file";
+        return;
+    }
+
+    bool isAifc = std::memcmp(header + 8, "AIFC", 4) == 0;
+    while (true)
+    {
+        std::uint8_t chunkHeader[8];
+        if (reader.Read(chunkHeader, sizeof(chunkHeader)) != 8)
+        {
+            result.error = "No COMM chunk found";
+            return;
+        }
+
+        std::uint32_t size = DecodeBigEndian(chunkHeader + 4, 4);
+        std::uint64_t next = reader.Position() + size + (size & 1);
+
+        if (std::memcmp(chunkHeader, "COMM", 4) == 0)
+        {
+            // AIFF-C follows the 18 common bytes with the compression type.
+            std::uint8_t common[18 + 4];
+            size_t commonSize = isAifc ? sizeof(common) : 18;
+            if (size < commonSize || 
+                reader.Read(common, commonSize) != commonSize)
+            {
+                result.error = "Invalid COMM chunk";
+                return;
+            }
+
+            result.channels = DecodeBigEndian(common, 2);
+            result.totalSamples = DecodeBigEndian(common + 2, 4);
+            result.bitsPerSample = DecodeBigEndian(common + 6, 2);
+            result.sampleRate = AiffFile::DecodeSampleRate(common + 8);
+            result.format = isAifc 
+                ? "AIFF-C " + std::string(
+                    reinterpret_cast<char*>(common + 18), 4)
+                : "AIFF PCM";
+            return;
+        }
+
+        reader.Seek(next);
+    }
+}
+
+/// @brief Probes the header of a file of result's type, from the start of
+/// source.
+static void ProbeHeader(ByteSource& source, ProbeResult& result)
+{
+    switch (result.type)
+    {
+        case MediaFileType::Wave:
+            ProbeWave(source, result);
+            break;
+        case MediaFileType::Flac:
+            ProbeFlac(source, result);
+            break;
+        case MediaFileType::Aiff:
+            ProbeAiff(source, result);
+            break;
+        case MediaFileType::Unsupported:
+            result.error = "Unsupported file type";
+            break;
+    }
+}
+
+ProbeResult ProbeMediaFile(std::string fileName)
+{
+    ProbeResult result;
+    result.fileName = fileName;
+    result.type = GetType(fileName);
+
+    FileReader reader{ fileName, ProbeBufferSize };
+    reader.Open();
+    if (!reader.IsOpen())
+    {
+        result.error = "Unable to open file";
+        return result;
+    }
+
+    result.fileSize = reader.Size();
+    ProbeHeader(reader, result);
+    return result;
+}
+
+ProbeResult ProbeMediaSource(ByteSource& source, std::string name)
+{
+    ProbeResult result;
+    result.fileName = name;
+    result.fileSize = source.Size();
+
+    std::uint8_t signature[TypeSignatureSize];
+    size_t signatureSize = source.Read(signature, sizeof(signature));
+    result.type = DetectType(signature, signatureSize);
+    if (!source.Seek(0))
+    {
+        result.error = "Unable to read file";
+        return result;
+    }
+
+    // A stream can only go back as far as its buffer, which a large chunk
+    // ahead of the samples would take it past, so its header is left for
+    // the file that reads it.
+    if (result.fileSize == 0 && result.type != MediaFileType::Unsupported)
+        return result;
+
+    ProbeHeader(source, result);
+    return result;
+}
+
+void DescribeMediaFile(const MediaFile& file, ProbeResult& result)
+{
+    const WaveFile* waveFile = dynamic_cast<const WaveFile*>(&file);
+    if (waveFile != nullptr)
+    {
+        WaveFormat format = waveFile->Format();
+        result.format = FormatTag(format.audioFormat.Value());
+        result.channels = format.channels.Value();
+
+        // A placeholder size in a stream leaves the data unbounded.
+        int blockAlign = format.blockAlign.Value();
+        std::uint64_t dataSize = waveFile->AnalysisRange().size;
+        if (blockAlign > 0 && 
+            dataSize != std::numeric_limits<std::uint64_t>::max())
+            result.totalSamples = dataSize / blockAlign;
+    }
+
+    const FlacFile* flacFile = dynamic_cast<const FlacFile*>(&file);
+    if (flacFile != nullptr)
+    {
+        FlacFormat format = flacFile->Format();
+        result.format = "FLAC";
+        result.channels = format.channels;
+        result.totalSamples = format.totalSamples;
+
+        // STREAMINFO may leave the length 0, but a stream that was decoded
+        // to its end has been counted.
+        const FlacVerifyResult& verifyResult = flacFile->VerifyResult();
+        if (result.totalSamples == 0 && verifyResult.decodedToEnd)
+            result.totalSamples = verifyResult.samplesDecoded;
+    }
+
+    result.bitsPerSample = file.BitsPerSample();
+    result.sampleRate = file.SampleRate();
+}
@@ -0,0 +1,93 @@
+// PageCache.cpp - Defines functions for controlling the OS page cache.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+#include "PageCache.h"
+#include "FileDescriptor.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+void AdviseSequential(int descriptor)
+{
+#ifdef __linux__
+    posix_fadvise(descriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+void DropFromCache(int descriptor, std::uint64_t offset, std::uint64_t size)
+{
+#ifdef __linux__
+    posix_fadvise(descriptor, static_cast<off_t>(offset), 
+                  static_cast<off_t>(size), POSIX_FADV_DONTNEED);
+#endif
+}
+
+void DropWrittenFromCache(
+    int descriptor, 
+    std::uint64_t offset, 
+    std::uint64_t size)
+{
+#ifdef __linux__
+    // DONTNEED skips dirty pages, so wait for this range to be written back
+    // first. Only this range is synced, unlike fdatasync.
+    sync_file_range(descriptor, static_cast<off64_t>(offset), 
+                    static_cast<off64_t>(size), 
+                    SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | 
+                    SYNC_FILE_RANGE_WAIT_AFTER);
+    DropFromCache(descriptor, offset, size);
+#endif
+}
+
+CacheResidency MeasureCacheResidency(std::string fileName)
+{
+    CacheResidency residency;
+#ifdef __linux__
+    int descriptor = OpenDescriptor(fileName, ReadOnlyFlags);
+    if (descriptor < 0)
+        return residency;
+
+    std::uint64_t size = DescriptorSize(descriptor);
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (size > 0 && pageSize > 0)
+    {
+        // Mapping the file doesn't read it; mincore then reports which of
+        // the mapped pages the cache already holds.
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, 
+                             descriptor, 0);
+        if (mapping != MAP_FAILED)
+        {
+            residency.totalPages = (size + pageSize - 1) / pageSize;
+            std::vector<unsigned char> pages(residency.totalPages);
+            if (mincore(mapping, size, pages.data()) == 0)
+            {
+                for (unsigned char page : pages)
+                    residency.cachedPages += page & 1;
+            }
+            else
+            {
+                residency.totalPages = 0;
+            }
+
+            munmap(mapping, size);
+        }
+    }
+
+    CloseDescriptor(descriptor);
+#endif
+    return residency;
+}
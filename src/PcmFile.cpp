@@ -0,0 +1,230 @@
+// PcmFile.cpp - Defines the PcmFile class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "PcmFile.h"
+
+PcmFile::PcmFile(
+    std::string fileName,
+    std::shared_ptr<Logging::Logger> logger)
+{
+    this->fileName = fileName;
+    this->logger = logger;
+    this->dataOffset = 0;
+    this->dataSize = 0;
+    this->sampleOrder = Endianness::Little;
+    this->hasSigned8BitSamples = false;
+    this->sampleBlockSize = 0;
+    this->hasPart = false;
+    this->leadInFrames = 0;
+    this->primeFrames = 0;
+    this->cachePolicy = CachePolicy::Normal;
+    reader = std::make_shared<FileReader>(fileName);
+    input = reader;
+    sampleSource = reader;
+}
+
+void PcmFile::SetCachePolicy(CachePolicy policy)
+{
+    cachePolicy = policy;
+    reader->SetCachePolicy(policy);
+}
+
+void PcmFile::Analyze(bool dumpSamples)
+{
+    // The analyzers see samples at the size of their container, as that is
+    // the scale they are aligned to.
+    int channels = std::max(Channels(), 1);
+    analyzers.Begin(SampleFormat{ channels, BytesPerSample() * 8, 
+                                  SampleRate() });
+
+    size_t frameSize = static_cast<size_t>(channels);
+    blockChannels.resize(frameSize);
+    primeFrames = hasPart ? leadInFrames : 0;
+    sampleBlockSize = NextBlockSize();
+    sampleBlock.clear();
+    sampleBlock.reserve(std::max(frameSize, SamplesPerBlock));
+    ByteRange range = AnalysisRange();
+
+    switch (BytesPerSample())
+    {
+        case 1:
+            ReadSamples(*sampleSource, range, [&](std::int32_t value)
+            {
+                return AnalyzeNextSample<Binary::UInt8Field>(
+                    value, dumpSamples);
+            });
+            break;
+        case 2:
+            ReadSamples(*sampleSource, range, [&](std::int32_t value)
+            {
+                return AnalyzeNextSample<Binary::Int16Field>(
+                    value, dumpSamples);
+            });
+            break;
+        case 3:
+            ReadSamples(*sampleSource, range, [&](std::int32_t value)
+            {
+                return AnalyzeNextSample<Binary::Int24Field>(
+                    value, dumpSamples);
+            });
+            break;
+        case 4:
+            ReadSamples(*sampleSource, range, [&](std::int32_t value)
+            {
+                return AnalyzeNextSample<Binary::Int32Field>(
+                    value, dumpSamples);
+            });
+            break;
+    }
+
+    AnalyzeSampleBlock();
+    analyzers.End();
+}
+
+void PcmFile::AnalyzeSampleBlock()
+{
+    // A truncated file can end part way through a frame, which is left out.
+    size_t channels = blockChannels.size();
+    for (size_t channel = 0; channel < channels; channel++)
+        blockChannels[channel] = sampleBlock.data() + channel;
+
+    SampleBlock block;
+    block.channels = blockChannels.data();
+    block.channelCount = static_cast<int>(channels);
+    block.frameCount = sampleBlock.size() / channels;
+    block.stride = channels;
+
+    if (primeFrames > 0)
+    {
+        analyzers.Prime(block);
+        primeFrames -= std::min<std::uint64_t>(primeFrames, block.frameCount);
+        sampleBlockSize = NextBlockSize();
+    }
+    else
+    {
+        analyzers.Process(block);
+    }
+
+    sampleBlock.clear();
+}
+
+size_t PcmFile::NextBlockSize() const
+{
+    size_t frameSize = std::max<size_t>(blockChannels.size(), 1);
+    size_t blockSize = std::max(frameSize, 
+                                SamplesPerBlock - SamplesPerBlock % frameSize);
+    if (primeFrames > 0 && primeFrames < blockSize / frameSize)
+        return static_cast<size_t>(primeFrames) * frameSize;
+    return blockSize;
+}
+
+bool PcmFile::SetAnalysisPart(
+    std::uint64_t firstFrame, 
+    std::uint64_t frameCount, 
+    std::uint64_t leadIn)
+{
+    std::uint64_t frameSize = 
+        static_cast<std::uint64_t>(BytesPerSample()) * std::max(Channels(), 1);
+    if (frameSize == 0 || !analyzers.CanAppend())
+        return false;
+
+    // The lead-in is read as the start of the range. A part past the end
+    // of the data, as the last of a file whose header overstated it can
+    // be, reads nothing.
+    leadIn = std::min(leadIn, firstFrame);
+    std::uint64_t dataFrames = dataSize / frameSize;
+    std::uint64_t startFrame = std::min(firstFrame - leadIn, dataFrames);
+    std::uint64_t available = dataFrames - startFrame;
+    std::uint64_t frames = 
+        std::min(available, leadIn + std::min(frameCount, available));
+
+    part.offset = dataOffset + startFrame * frameSize;
+    part.size = frames * frameSize;
+    hasPart = true;
+    leadInFrames = leadIn;
+    return true;
+}
+
+bool PcmFile::OpenInput()
+{
+    if (input == reader && !reader->IsOpen())
+        reader->Open();
+
+    return IsOpen();
+}
+
+bool PcmFile::OpenWriter(std::string outputFileName)
+{
+    // Conversion copies chunks and whole files through the reader, which
+    // only has the file when it was opened by name.
+    if (input != reader)
+    {
+        logger->Write(
+            "Only files opened by name can be converted", 
+            Logging::LogLevel::Error);
+        return false;
+    }
+
+    writer = std::make_shared<FileWriter>(outputFileName);
+    writer->SetCachePolicy(cachePolicy);
+    writer->Open();
+    if (!writer->IsOpen())
+    {
+        logger->Write("Unable to open output file", Logging::LogLevel::Error);
+        return false;
+    }
+    return true;
+}
+
+bool PcmFile::WriteConvertedSamples(ConversionMethod method, BitDepth depth)
+{
+    switch (BytesPerSample())
+    {
+        case 1:
+            return ConvertSamples<Binary::UInt8Field>(method, depth);
+        case 2:
+            return ConvertSamples<Binary::Int16Field>(method, depth);
+        case 3:
+            return ConvertSamples<Binary::Int24Field>(method, depth);
+        case 4:
+            return ConvertSamples<Binary::Int32Field>(method, depth);
+        default:
+            return false;
+    }
+}
+
+long PcmFile::CalculateNumberOfSamples()
+{
+    int bytesPerSample = BytesPerSample();
+    return bytesPerSample > 0 ? dataSize / bytesPerSample : 0;
+}
+
+long PcmFile::CalculateNewDataSize(BitDepth depth, long numberOfSamples)
+{
+    switch (depth)
+    {
+        case BitDepth::UInt8:
+            return numberOfSamples * 1;
+        case BitDepth::Int16:
+            return numberOfSamples * 2;
+        case BitDepth::Int24:
+            return numberOfSamples * 3;
+        case BitDepth::Int32:
+            return numberOfSamples * 4;
+        default:
+            return 0;
+    }
+}
@@ -57,6 +57,26 @@ int Program::Run()
         logFile->SetMinLogLevel(Logging::LogLevel::Debug);    
     }
     
+    if (serveOption->IsSpecified())
+        return Serve();
+
+    if (mergeOption->IsSpecified())
+        return MergeInventories();
+
+    if (probeOption->IsSpecified())
+        return ProbeFiles();
+
+    if (analyzeOption->IsSpecified() && 
+        std::filesystem::is_directory(inputFileParam->Value()))
+        return AnalyzeFiles();
+
+    if (convertOption->IsSpecified() && 
+        std::filesystem::is_directory(inputFileParam->Value()))
+        return ConvertFiles();
+
+    if (benchmarkOption->IsSpecified())
+        return BenchmarkAnalysis();
+
     std::shared_ptr<MediaFile> inputFile = OpenFile(inputFileParam->Value());
     if (inputFile == nullptr)
         return ExitStatusInputFileError;
@@ -65,25 +85,30 @@ int Program::Run()
     if (directCopyParam->IsSpecified())
         method = ConversionMethod::DirectCopy;
 
+    int status = ExitStatusSuccess;
     if (to8BitParam->IsSpecified())
     {
-        inputFile->Convert(outputFileParam->Value(), BitDepth::UInt8, method);
-        return ExitStatusSuccess;
+        if (!inputFile->Convert(
+                outputFileParam->Value(), BitDepth::UInt8, method))
+            status = ExitStatusOutputFileError;
     }
     else if (to16BitParam->IsSpecified())
     {
-        inputFile->Convert(outputFileParam->Value(), BitDepth::Int16, method);
-        return ExitStatusSuccess;
+        if (!inputFile->Convert(
+                outputFileParam->Value(), BitDepth::Int16, method))
+            status = ExitStatusOutputFileError;
     }
     else if (to24BitParam->IsSpecified())
     {
-        inputFile->Convert(outputFileParam->Value(), BitDepth::Int24, method);
-        return ExitStatusSuccess;
+        if (!inputFile->Convert(
+                outputFileParam->Value(), BitDepth::Int24, method))
+            status = ExitStatusOutputFileError;
     }
     else if (to32BitParam->IsSpecified())
     {
-        inputFile->Convert(outputFileParam->Value(), BitDepth::Int32, method);
-        return ExitStatusSuccess;
+        if (!inputFile->Convert(
+                outputFileParam->Value(), BitDepth::Int32, method))
+            status = ExitStatusOutputFileError;
     }
     else if (analyzeOption->IsSpecified())
     {
@@ -95,15 +120,62 @@ int Program::Run()
         }
         logger->Write("");
 
+        if (readOption->IsSpecified())
+        {
+            std::shared_ptr<ByteSource> source = OpenByteSource(
+                inputFileParam->Value(), GetReadStrategy());
+            if (source == nullptr)
+            {
+                logger->Write("Unable to open file", Logging::LogLevel::Error);
+                return ExitStatusInputFileError;
+            }
+
+            inputFile->SetAnalysisSource(source);
+        }
+
+        // Verifying happens in the same decode as the analysis, so it only
+        // needs switching on beforehand.
+        FlacFile* flacFile = dynamic_cast<FlacFile*>(inputFile.get());
+        if (flacFile != nullptr)
+            flacFile->SetVerify(verifyOption->IsSpecified());
+
+        ConfigureAnalyzers(inputFile.get());
         inputFile->Analyze(dumpOption->IsSpecified());
         PrintMediaInfo(inputFile.get());
         PrintAnalysisResults(inputFile.get());
-        return ExitStatusSuccess;
+        if (inputFile->Analyzers().RingSettings().analysisThreads > 0)
+            PrintRingStats(inputFile.get());
+
+        if (flacFile != nullptr && flacFile->IsVerifying())
+            status = PrintVerifyResults(flacFile);
     }
     else
     {
-        return PrintMediaInfo(inputFile.get());
+        status = PrintMediaInfo(inputFile.get());
+    }
+
+    if (noCacheOption->IsSpecified() && 
+        inputFileParam->Value() != StandardInputName)
+    {
+        // Release the file first so what it drops on close has been dropped
+        // by the time we measure.
+        inputFile = nullptr;
+
+        logger->Write("");
+        PrintSectionHeader("Page Cache");
+        PrintCacheResidency(
+            "Input Retained", 
+            MeasureCacheResidency(inputFileParam->Value()));
+
+        if (convertOption->IsSpecified())
+        {
+            PrintCacheResidency(
+                "Output Retained", 
+                MeasureCacheResidency(outputFileParam->Value()));
+        }
     }
+
+    return status;
 }
 
 void Program::DefineParams()
@@ -115,16 +187,27 @@ void Program::DefineParams()
 
     CmdLine::PosParam::Definition inputFileDef;
     inputFileDef.name = "input-file";
-    inputFileDef.description = "The file to use as input for the conversion";
+    inputFileDef.description = 
+        "The file to use as input, or - to read standard input as a stream";
     inputFileDef.isMandatory = true;
     inputFileParam = std::make_shared<CmdLine::PosParam>(inputFileDef);
 
     CmdLine::PosParam::Definition outputFileDef;
     outputFileDef.name = "output-file";
-    outputFileDef.description = "The file to write the converted data to";
+    outputFileDef.description = 
+        "The file to write the converted data or probe inventory to";
     outputFileDef.isMandatory = false;
     outputFileParam = std::make_shared<CmdLine::PosParam>(outputFileDef);
 
+    // Shards are given as a value rather than a choice of options, so a
+    // batch can be spread over any number of processes.
+    CmdLine::PosParam::Definition shardParamDef;
+    shardParamDef.name = "shard";
+    shardParamDef.description = 
+        "The shard -H handles, as index/count from 1/count to count/count";
+    shardParamDef.isMandatory = false;
+    shardParam = std::make_shared<CmdLine::PosParam>(shardParamDef);
+
     CmdLine::Option::Definition analyzeDef;
     analyzeDef.shortName = 'a';
     analyzeDef.longName = "analyze";
@@ -199,6 +282,175 @@ void Program::DefineParams()
     dumpDef.longName = "dump-samples";
     dumpDef.description = "dumps samples to a text file. Use with -a.";
     dumpOption = std::make_shared<CmdLine::Option>(dumpDef);
+
+    CmdLine::Option::Definition probeDef;
+    probeDef.shortName = 'p';
+    probeDef.longName = "probe";
+    probeDef.description = 
+        "writes a CSV or NDJSON format inventory of a file or folder";
+    probeOption = std::make_shared<CmdLine::Option>(probeDef);
+
+    CmdLine::Option::Definition ioUringDef;
+    ioUringDef.shortName = 'u';
+    ioUringDef.longName = "io-uring";
+    ioUringDef.description = 
+        "reads ahead with io_uring when analyzing a folder";
+    ioUringOption = std::make_shared<CmdLine::Option>(ioUringDef);
+
+    CmdLine::ValueOption::Definition queueDepthDef;
+    queueDepthDef.shortName = 'q';
+    queueDepthDef.longName = "queue-depth";
+    queueDepthDef.description = 
+        "sets the number of reads each worker keeps in flight with -u";
+    queueDepthOption = std::make_shared<CmdLine::ValueOption>(queueDepthDef);
+
+    for (unsigned int depth : QueueDepths)
+    {
+        CmdLine::OptionParam::Definition depthDef;
+        depthDef.name = std::to_string(depth);
+        depthDef.description = "keeps " + depthDef.name + " reads in flight";
+        queueDepthParams.push_back(
+            std::make_shared<CmdLine::OptionParam>(depthDef));
+        queueDepthOption->Add(queueDepthParams.back().get());
+    }
+
+    CmdLine::Option::Definition noCacheDef;
+    noCacheDef.shortName = 'n';
+    noCacheDef.longName = "no-cache";
+    noCacheDef.description = 
+        "drops files from the page cache as they are read and written";
+    noCacheOption = std::make_shared<CmdLine::Option>(noCacheDef);
+
+    CmdLine::OptionParam::Definition bufferedDef;
+    bufferedDef.name = "buffered";
+    bufferedDef.description = "reads through a buffer of up to 1 MB";
+    bufferedParam = std::make_shared<CmdLine::OptionParam>(bufferedDef);
+
+    CmdLine::OptionParam::Definition mappedDef;
+    mappedDef.name = "mmap";
+    mappedDef.description = "maps the file into memory";
+    mappedParam = std::make_shared<CmdLine::OptionParam>(mappedDef);
+
+    CmdLine::OptionParam::Definition memoryDef;
+    memoryDef.name = "memory";
+    memoryDef.description = "loads the whole file into memory first";
+    memoryParam = std::make_shared<CmdLine::OptionParam>(memoryDef);
+
+    CmdLine::ValueOption::Definition readDef;
+    readDef.shortName = 'r';
+    readDef.longName = "read";
+    readDef.description = "specifies how the file is read for analysis";
+    readOption = std::make_shared<CmdLine::ValueOption>(readDef);
+    readOption->Add(bufferedParam.get());
+    readOption->Add(mappedParam.get());
+    readOption->Add(memoryParam.get());
+
+    CmdLine::Option::Definition benchmarkDef;
+    benchmarkDef.shortName = 'b';
+    benchmarkDef.longName = "benchmark";
+    benchmarkDef.description = 
+        "times analysis of the file with each way of reading it";
+    benchmarkOption = std::make_shared<CmdLine::Option>(benchmarkDef);
+
+    CmdLine::Option::Definition verifyDef;
+    verifyDef.shortName = 'v';
+    verifyDef.longName = "verify";
+    verifyDef.description = 
+        "checks FLAC CRCs and MD5 signatures while analyzing. Use with -a.";
+    verifyOption = std::make_shared<CmdLine::Option>(verifyDef);
+
+    CmdLine::Option::Definition quickDef;
+    quickDef.shortName = 'k';
+    quickDef.longName = "quick";
+    quickDef.description = 
+        "only tests for an upscale, stopping once it is settled. Use with -a.";
+    quickOption = std::make_shared<CmdLine::Option>(quickDef);
+
+    CmdLine::Option::Definition hashDef;
+    hashDef.shortName = 'x';
+    hashDef.longName = "hash";
+    hashDef.description = 
+        "hashes the decoded samples while analyzing. Use with -a.";
+    hashOption = std::make_shared<CmdLine::Option>(hashDef);
+
+    CmdLine::ValueOption::Definition analysisThreadsDef;
+    analysisThreadsDef.shortName = 'g';
+    analysisThreadsDef.longName = "analysis-threads";
+    analysisThreadsDef.description = 
+        "analyzes on separate threads from the decoding. Use with -a.";
+    analysisThreadsOption = 
+        std::make_shared<CmdLine::ValueOption>(analysisThreadsDef);
+
+    for (unsigned int count : AnalysisThreadCounts)
+    {
+        CmdLine::OptionParam::Definition countDef;
+        countDef.name = std::to_string(count);
+        countDef.description = "analyzes on " + countDef.name + " threads";
+        analysisThreadsParams.push_back(
+            std::make_shared<CmdLine::OptionParam>(countDef));
+        analysisThreadsOption->Add(analysisThreadsParams.back().get());
+    }
+
+    CmdLine::Option::Definition serveDef;
+    serveDef.shortName = 'S';
+    serveDef.longName = "serve";
+    serveDef.description = 
+        "answers analysis requests on the Unix socket named by input-file";
+    serveOption = std::make_shared<CmdLine::Option>(serveDef);
+
+    CmdLine::Option::Definition resumeDef;
+    resumeDef.shortName = 'R';
+    resumeDef.longName = "resume";
+    resumeDef.description = 
+        "journals a folder batch beside output-file to resume it if stopped";
+    resumeOption = std::make_shared<CmdLine::Option>(resumeDef);
+
+    CmdLine::Option::Definition shardDef;
+    shardDef.shortName = 'H';
+    shardDef.longName = "shard";
+    shardDef.description = 
+        "handles the one shard of a folder batch named by shard";
+    shardOption = std::make_shared<CmdLine::Option>(shardDef);
+
+    CmdLine::Option::Definition mergeDef;
+    mergeDef.shortName = 'M';
+    mergeDef.longName = "merge";
+    mergeDef.description = 
+        "combines the inventories in the input-file folder into output-file";
+    mergeOption = std::make_shared<CmdLine::Option>(mergeDef);
+}
+
+/// @brief Reads a shard given as index/count, where index is from 1 to
+/// count.
+/// @return False if text isn't a shard.
+static bool ParseShard(
+    const std::string& text, 
+    unsigned int& index, 
+    unsigned int& count)
+{
+    size_t slash = text.find('/');
+    if (slash == std::string::npos || slash == 0 || 
+        slash + 1 == text.size() || 
+        text.find_first_not_of("0123456789/") != std::string::npos ||
+        text.find('/', slash + 1) != std::string::npos)
+        return false;
+
+    try
+    {
+        unsigned long parsedIndex = std::stoul(text.substr(0, slash));
+        unsigned long parsedCount = std::stoul(text.substr(slash + 1));
+        if (parsedIndex < 1 || parsedIndex > parsedCount || 
+            parsedCount > std::numeric_limits<unsigned int>::max())
+            return false;
+
+        index = static_cast<unsigned int>(parsedIndex);
+        count = static_cast<unsigned int>(parsedCount);
+        return true;
+    }
+    catch (const std::out_of_range&)
+    {
+        return false;
+    }
 }
 
 bool Program::ParseArguments()
@@ -206,12 +458,27 @@ bool Program::ParseArguments()
     CmdLine::Parser parser{ progParam.get(), arguments };
     parser.Add(inputFileParam.get());
     parser.Add(outputFileParam.get());
+    parser.Add(shardParam.get());
     parser.Add(analyzeOption.get());
     parser.Add(convertOption.get());
     parser.Add(methodOption.get());
     parser.Add(logOption.get());
     parser.Add(debugOption.get());
     parser.Add(dumpOption.get());
+    parser.Add(probeOption.get());
+    parser.Add(ioUringOption.get());
+    parser.Add(queueDepthOption.get());
+    parser.Add(noCacheOption.get());
+    parser.Add(readOption.get());
+    parser.Add(benchmarkOption.get());
+    parser.Add(verifyOption.get());
+    parser.Add(quickOption.get());
+    parser.Add(hashOption.get());
+    parser.Add(analysisThreadsOption.get());
+    parser.Add(serveOption.get());
+    parser.Add(resumeOption.get());
+    parser.Add(shardOption.get());
+    parser.Add(mergeOption.get());
     CmdLine::Parser::Status status = parser.Parse();
 
     if (status == CmdLine::Parser::Status::Failure)
@@ -232,6 +499,16 @@ bool Program::ParseArguments()
         logger->Write(parser.GenerateUsage());
         return false;
     }
+    else if (shardOption->IsSpecified() != shardParam->IsSpecified() ||
+             (shardOption->IsSpecified() && 
+              !ParseShard(shardParam->Value(), shardIndex, shardCount)))
+    {
+        logger->Write(
+            "-H needs a shard after output-file, given as index/count "
+            "such as 2/8", 
+            Logging::LogLevel::Error);
+        return false;
+    }
     else
     {
         return true;
@@ -268,24 +545,21 @@ void Program::PrintField(
 
 int Program::PrintMediaInfo(MediaFile* file)
 {
-    MediaFileType type = GetType(file->FileName());
-    switch (type)
-    {
-        case MediaFileType::Wave:
-        {
-            WaveFile* waveFile = dynamic_cast<WaveFile*>(file);
-            return PrintWaveInfo(waveFile);
-        }
-        case MediaFileType::Flac:
-        {
-            FlacFile* flacFile = dynamic_cast<FlacFile*>(file);
-            return PrintFlacInfo(flacFile);
-        }
-        case MediaFileType::Unsupported:
-        {
-            return ExitStatusUnsupportedFile;
-        }
-    }
+    // The type is told from the file's class rather than its name, as a
+    // stream read from standard input doesn't have one.
+    WaveFile* waveFile = dynamic_cast<WaveFile*>(file);
+    if (waveFile != nullptr)
+        return PrintWaveInfo(waveFile);
+
+    FlacFile* flacFile = dynamic_cast<FlacFile*>(file);
+    if (flacFile != nullptr)
+        return PrintFlacInfo(flacFile);
+
+    AiffFile* aiffFile = dynamic_cast<AiffFile*>(file);
+    if (aiffFile != nullptr)
+        return PrintAiffInfo(aiffFile);
+
+    return ExitStatusUnsupportedFile;
 }
 
 int Program::PrintWaveInfo(WaveFile* file)
@@ -318,41 +592,284 @@ int Program::PrintFlacInfo(FlacFile* file)
     PrintField("Sample Rate", std::to_string(format.sampleRate));
     PrintField("Block Size", std::to_string(format.blockSize));
     PrintField("Bits / Sample", std::to_string(format.bitsPerSample));
-    PrintField("Total Samples", std::to_string(format.totalSamples));
+
+    // A streaming encoder may not know the length when it writes STREAMINFO.
+    PrintField("Total Samples", format.totalSamples > 0 
+        ? std::to_string(format.totalSamples) : "unknown");
+    logger->Write("");
+
+    // Wasted bits are only known once the frames have been decoded.
+    if (file->FrameCount() == 0)
+        return ExitStatusSuccess;
+
+    PrintSectionHeader("Wasted Bits");
+    const std::vector<WastedBitsStats>& wastedBits = file->WastedBits();
+    for (size_t channel = 0; channel < wastedBits.size(); channel++)
+    {
+        const WastedBitsStats& stats = wastedBits[channel];
+        double bytePercent = stats.subframeCount > 0 
+            ? 100.0 * stats.byteWastedCount / stats.subframeCount : 0.0;
+
+        std::stringstream value;
+        value << "min " << stats.minimumWastedBits << ", mean " << std::fixed 
+              << std::setprecision(2) << stats.MeanWastedBits() << ", " 
+              << std::setprecision(1) << bytePercent << "% with 8 or more";
+        PrintField("Channel " + std::to_string(channel + 1), value.str());
+    }
+
+    std::stringstream settled;
+    settled << file->FramesSettledByHeaders() << " of " << file->FrameCount();
+    PrintField("Settled by Headers", settled.str());
+    logger->Write("");
+
+    return ExitStatusSuccess;
+}
+
+int Program::PrintAiffInfo(AiffFile* file)
+{
+    PrintSectionHeader("Format Info");
+    PrintField("Form Type", file->FormType());
+    PrintField("Compression", file->CompressionType());
+    PrintField("Channels", std::to_string(file->Channels()));
+    PrintField("Sample Rate", std::to_string(file->SampleRate()));
+    PrintField("Bits / Sample", std::to_string(file->BitsPerSample()));
+    PrintField("Sample Frames", std::to_string(file->SampleFrames()));
     logger->Write("");
 
     return ExitStatusSuccess;
 }
 
+/// @brief Formats a level in decibels, or some other logarithmic unit such
+/// as LUFS, which is negative infinity for silence.
+static std::string FormatDecibels(double decibels, std::string unit)
+{
+    if (std::isinf(decibels))
+        return "-inf " + unit;
+
+    std::stringstream text;
+    text << std::fixed << std::setprecision(2) << decibels << " " << unit;
+    return text.str();
+}
+
+void Program::ConfigureAnalyzers(MediaFile* file)
+{
+    // The zero low byte test and the effective bits are both settled by the
+    // first sample with its lowest bit set, which for a natural recording
+    // is near the start, so on their own they rarely read the whole file.
+    if (quickOption->IsSpecified())
+    {
+        file->Analyzers().Clear();
+        file->Analyzers().Add(std::make_shared<UpscaleAnalyzer>());
+        file->Analyzers().Add(std::make_shared<EffectiveBitsAnalyzer>());
+    }
+
+    if (hashOption->IsSpecified())
+        file->Analyzers().Add(std::make_shared<SampleHashAnalyzer>());
+
+    SampleRingSettings ringSettings;
+    for (size_t i = 0; i < analysisThreadsParams.size(); i++)
+    {
+        if (analysisThreadsParams[i]->IsSpecified())
+            ringSettings.analysisThreads = AnalysisThreadCounts[i];
+    }
+    file->Analyzers().SetRingSettings(ringSettings);
+}
+
 void Program::PrintAnalysisResults(MediaFile* file)
 {
+    LevelResult levels = file->Levels();
+    if (!levels.channels.empty())
+    {
+        PrintSectionHeader("Levels");
+        for (size_t channel = 0; channel < levels.channels.size(); channel++)
+        {
+            const LevelChannelStats& stats = levels.channels[channel];
+            std::stringstream value;
+            value << "peak " << FormatDecibels(stats.PeakDbfs(), "dBFS") 
+                  << ", RMS " << FormatDecibels(stats.RmsDbfs(), "dBFS") 
+                  << ", DC offset " 
+                  << std::fixed << std::setprecision(4) 
+                  << stats.dcOffset * 100 << "%, clipped " 
+                  << stats.clippedSamples << " samples in " 
+                  << stats.clippedRuns << " runs";
+            PrintField("Channel " + std::to_string(channel + 1), value.str());
+        }
+        logger->Write("");
+    }
+
+    LoudnessResult loudness = file->Loudness();
+    if (loudness.measured)
+    {
+        PrintSectionHeader("Loudness");
+        PrintField("Integrated Loudness", 
+                   FormatDecibels(loudness.integratedLoudness, "LUFS"));
+        PrintField("Loudness Range", 
+                   FormatDecibels(loudness.loudnessRange, "LU"));
+        PrintField("True Peak", 
+                   FormatDecibels(loudness.TruePeakDbtp(), "dBTP"));
+        logger->Write("");
+    }
+
+    LowBitResult lowBits = file->LowBits();
+    if (!lowBits.channels.empty())
+    {
+        PrintSectionHeader("Low Bits");
+        for (size_t channel = 0; channel < lowBits.channels.size(); channel++)
+        {
+            const LowBitChannelStats& stats = lowBits.channels[channel];
+            std::stringstream value;
+            value << "entropy " << std::fixed << std::setprecision(2) 
+                  << stats.entropy << " bits, correlation " 
+                  << stats.correlation;
+            PrintField("Channel " + std::to_string(channel + 1), value.str());
+        }
+
+        std::stringstream score;
+        score << std::fixed << std::setprecision(2) << lowBits.score;
+        PrintField("Dither Score", score.str());
+        logger->Write("");
+    }
+
+    DistinctValueResult distinctValues = file->DistinctValues();
+    if (distinctValues.analyzed)
+    {
+        PrintSectionHeader("Distinct Values");
+        PrintField("Distinct Values", 
+                   std::to_string(distinctValues.distinctValues));
+        PrintField("Quantization Step", 
+                   std::to_string(distinctValues.quantizationStep));
+        PrintField("Range", std::to_string(distinctValues.minimum) + " to " + 
+                            std::to_string(distinctValues.maximum));
+        logger->Write("");
+    }
+
     PrintSectionHeader("Analysis Results");
+
+    std::shared_ptr<EffectiveBitsAnalyzer> effectiveBits = 
+        file->Analyzers().Find<EffectiveBitsAnalyzer>();
+    if (effectiveBits != nullptr)
+    {
+        PrintField("Effective Bits", 
+                   std::to_string(effectiveBits->EffectiveBits()) + " of " + 
+                   std::to_string(effectiveBits->BitsPerSample()));
+    }
+
+    std::shared_ptr<SampleHashAnalyzer> sampleHash = 
+        file->Analyzers().Find<SampleHashAnalyzer>();
+    if (sampleHash != nullptr)
+    {
+        std::stringstream hash;
+        hash << std::hex << std::setw(16) << std::setfill('0') 
+             << sampleHash->Hash();
+        PrintField("Sample Hash", hash.str());
+    }
     
     if (file->IsUpscaled())
     {
         logger->Write("File appears to be an upscale conversion");
     }
+    else if (lowBits.IsLikelyDitheredUpscale())
+    {
+        logger->Write("File appears to be a dithered upscale conversion");
+    }
+    else if (distinctValues.IsLikelyScaledUpscale())
+    {
+        logger->Write("File appears to be a gain-scaled upscale conversion");
+    }
     else
     {
         logger->Write("File appears to be a natural bit-depth");
     }
 }
 
+void Program::PrintRingStats(MediaFile* file)
+{
+    const SampleRingSettings& settings = file->Analyzers().RingSettings();
+    const SampleRingStats& stats = file->Analyzers().RingStats();
+
+    logger->Write("");
+    PrintSectionHeader("Analysis Threads");
+    PrintField("Threads", std::to_string(settings.analysisThreads));
+
+    std::stringstream buffers;
+    buffers << settings.bufferCount << " of " << settings.framesPerBuffer 
+            << " frames";
+    PrintField("Buffers", buffers.str());
+    PrintField("Blocks", std::to_string(stats.blocks));
+
+    std::stringstream producer;
+    producer << stats.producerStalls << " (" << std::fixed 
+             << std::setprecision(3) << stats.producerStallSeconds << " s)";
+    PrintField("Decoder Stalls", producer.str());
+
+    std::stringstream consumer;
+    consumer << stats.consumerStalls << " (" << std::fixed 
+             << std::setprecision(3) << stats.consumerStallSeconds << " s)";
+    PrintField("Analysis Stalls", consumer.str());
+}
+
+int Program::PrintVerifyResults(FlacFile* file)
+{
+    const FlacVerifyResult& result = file->VerifyResult();
+
+    logger->Write("");
+    PrintSectionHeader("Integrity");
+    PrintField("MD5 Signature", result.hasMd5 ? "present" : "absent");
+    if (result.hasMd5 && result.decodedToEnd)
+        PrintField("MD5 Check", result.md5Matches ? "matches" : "MISMATCH");
+    PrintField("CRC Errors", std::to_string(result.crcErrors));
+    PrintField("Other Errors", std::to_string(result.otherErrors));
+
+    std::stringstream samples;
+    samples << result.samplesDecoded << " of " << result.totalSamples;
+    PrintField("Samples Decoded", samples.str());
+
+    PrintField("Verdict", result.Verdict());
+
+    if (result.IsIntact())
+        return ExitStatusSuccess;
+    return ExitStatusVerifyFailed;
+}
+
+void Program::PrintCacheResidency(
+    std::string label, 
+    CacheResidency residency)
+{
+    double percent = residency.totalPages > 0 
+        ? 100.0 * residency.cachedPages / residency.totalPages : 0.0;
+
+    std::stringstream value;
+    value << residency.cachedPages << " of " << residency.totalPages 
+          << " pages (" << std::fixed << std::setprecision(1) << percent 
+          << "%)";
+    PrintField(label, value.str());
+}
+
+CachePolicy Program::GetCachePolicy()
+{
+    if (noCacheOption->IsSpecified())
+        return CachePolicy::Streaming;
+    return CachePolicy::Normal;
+}
+
+ReadStrategy Program::GetReadStrategy()
+{
+    if (mappedParam->IsSpecified())
+        return ReadStrategy::MemoryMapped;
+    else if (memoryParam->IsSpecified())
+        return ReadStrategy::InMemory;
+    else
+        return ReadStrategy::Buffered;
+}
+
 std::shared_ptr<MediaFile> Program::OpenFile(std::string fileName)
 {
-    std::shared_ptr<MediaFile> inputFile;
-    MediaFileType type = GetType(fileName);
-    switch (type)
+    std::shared_ptr<MediaFile> inputFile = fileName == StandardInputName
+        ? CreateStreamFile() : CreateMediaFile(fileName, logger);
+    if (inputFile == nullptr)
     {
-        case MediaFileType::Wave:
-            inputFile = std::make_shared<WaveFile>(fileName, logger);
-            break;
-        case MediaFileType::Flac:
-            inputFile = std::make_shared<FlacFile>(fileName, logger);
-            break;
-        case MediaFileType::Unsupported:
-            logger->Write("Unsupported file type", Logging::LogLevel::Error);
-            return nullptr;
+        logger->Write("Unsupported file type", Logging::LogLevel::Error);
+        return nullptr;
     }
 
     if (inputFile->Exists())
@@ -371,6 +888,7 @@ std::shared_ptr<MediaFile> Program::OpenFile(std::string fileName)
 
     try
     {
+        inputFile->SetCachePolicy(GetCachePolicy());
         inputFile->Open();
     }
     catch (const MediaFormatError& error)
@@ -382,15 +900,704 @@ std::shared_ptr<MediaFile> Program::OpenFile(std::string fileName)
     return inputFile;
 }
 
-MediaFileType GetType(std::string fileName)
+std::shared_ptr<MediaFile> Program::CreateStreamFile()
 {
-    std::filesystem::path path = std::filesystem::path{ fileName };
-    std::string ext = path.extension().string();
-    std::transform(ext.begin(), ext.end(), ext.begin(), ::toupper);
-    
-    if (ext == ".WAV")
-        return MediaFileType::Wave;
-    else if (ext == ".FLAC")
-        return MediaFileType::Flac;
-    return MediaFileType::Unsupported;
-}
\ No newline at end of file
+    // The first bytes stay in the stream's buffer, so the file can read its
+    // header from the start again.
+    auto stream = std::make_shared<StreamSource>(StandardInputDescriptor);
+    std::uint8_t signature[TypeSignatureSize];
+    size_t signatureSize = stream->Read(signature, sizeof(signature));
+    stream->Seek(0);
+
+    std::shared_ptr<MediaFile> file = CreateMediaFile(
+        DetectType(signature, signatureSize), StandardInputName, logger);
+    if (file != nullptr)
+        file->SetInput(stream);
+
+    return file;
+}
+
+std::ostream* Program::OpenInventory(
+    std::ofstream& outputFile, 
+    InventoryFormat& format)
+{
+    // The inventory goes to standard output unless an output file is given,
+    // in which case its extension picks the format.
+    format = InventoryFormat::Csv;
+    if (!outputFileParam->IsSpecified())
+        return &std::cout;
+
+    outputFile.open(outputFileParam->Value());
+    if (!outputFile)
+    {
+        logger->Write(
+            "Unable to open inventory file", 
+            Logging::LogLevel::Error);
+        return nullptr;
+    }
+
+    format = GetInventoryFormat(outputFileParam->Value());
+    return &outputFile;
+}
+
+std::unique_ptr<FileShard> Program::OpenShard()
+{
+    if (shardCount == 0)
+        return nullptr;
+
+    auto shard = std::make_unique<FileShard>(
+        inputFileParam->Value(), shardIndex - 1, shardCount);
+
+    std::stringstream summary;
+    summary << "Shard " << shardIndex << "/" << shardCount << " has " 
+            << shard->FileCount() << " files, " << std::fixed 
+            << std::setprecision(1) 
+            << shard->Size() / (1024.0 * 1024.0) << " MB";
+    logger->Write(summary.str());
+    return shard;
+}
+
+int Program::ProbeFiles()
+{
+    std::string inputPath = inputFileParam->Value();
+    if (!std::filesystem::exists(inputPath))
+    {
+        std::stringstream error;
+        error << inputPath << " does not exist!";
+        logger->Write(error.str(), Logging::LogLevel::Error);
+        return ExitStatusInputFileError;
+    }
+
+    std::ofstream outputFile;
+    InventoryFormat format;
+    std::ostream* output = OpenInventory(outputFile, format);
+    if (output == nullptr)
+        return ExitStatusOutputFileError;
+
+    InventoryWriter inventory{ *output, format };
+    inventory.WriteHeader();
+
+    std::unique_ptr<FileShard> shard = OpenShard();
+
+    // The directory walk feeds a bounded queue, so workers start probing as
+    // soon as the first file is found and memory stays flat no matter how
+    // many files the walk turns up.
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int workerCount = cores * ProbeWorkersPerCore;
+    WorkQueue<std::string> queue{ workerCount * 64 };
+    std::atomic<unsigned long> fileCount{ 0 };
+    std::atomic<unsigned long> errorCount{ 0 };
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < workerCount; i++)
+    {
+        workers.emplace_back([&]()
+        {
+            std::string fileName;
+            while (queue.Pop(fileName))
+            {
+                ProbeResult result = ProbeMediaFile(fileName);
+                if (!result.error.empty())
+                    errorCount++;
+
+                inventory.Write(result);
+                fileCount++;
+            }
+        });
+    }
+
+    unsigned long walkErrorCount{ 0 };
+    EnumerateMediaFiles(inputPath, [&](const std::string& fileName)
+    {
+        if (shard == nullptr || shard->Contains(fileName))
+            queue.Push(fileName);
+    }, 
+    nullptr, 
+    [&](const std::string& folder, const std::error_code& error)
+    {
+        walkErrorCount++;
+        logger->Write(folder + ": " + error.message(), 
+                      Logging::LogLevel::Error);
+    });
+    queue.Close();
+
+    for (std::thread& worker : workers)
+        worker.join();
+
+    output->flush();
+
+    std::chrono::duration<double> elapsed = 
+        std::chrono::steady_clock::now() - start;
+    double filesPerSecond = elapsed.count() > 0 
+        ? fileCount / elapsed.count() : 0.0;
+
+    std::stringstream summary;
+    summary << "Probed " << fileCount << " files (" << errorCount 
+            << " errors) in " << std::fixed << std::setprecision(2) 
+            << elapsed.count() << " s, " << std::setprecision(0) 
+            << filesPerSecond << " files/s";
+    logger->Write(summary.str());
+
+    // The inventory has no row for the files in folders the walk couldn't
+    // finish, so it isn't complete.
+    if (walkErrorCount > 0)
+        return ExitStatusInputFileError;
+
+    return ExitStatusSuccess;
+}
+
+std::unique_ptr<BatchJournal> Program::OpenJournal(
+    std::string kind, 
+    const BatchJournal::RecordHandler& handler)
+{
+    if (!outputFileParam->IsSpecified())
+    {
+        logger->Write(
+            "Resuming needs an output file to keep the journal beside", 
+            Logging::LogLevel::Error);
+        return nullptr;
+    }
+
+    // A folder given with a trailing separator has no file name of its own,
+    // so the journal is named after the folder instead of going inside it.
+    std::filesystem::path journalName{ outputFileParam->Value() };
+    if (!journalName.has_filename())
+        journalName = journalName.parent_path();
+    journalName += JournalExtension;
+
+    auto journal = std::make_unique<BatchJournal>(journalName.string(), kind);
+    std::string error = journal->Open(handler);
+    if (!error.empty())
+    {
+        logger->Write(error, Logging::LogLevel::Error);
+        return nullptr;
+    }
+
+    return journal;
+}
+
+int Program::AnalyzeFiles()
+{
+    std::ofstream outputFile;
+    InventoryFormat format;
+    std::ostream* output = OpenInventory(outputFile, format);
+    if (output == nullptr)
+        return ExitStatusOutputFileError;
+
+    InventoryWriter inventory{ *output, format, true };
+    inventory.WriteHeader();
+
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    BatchSettings settings;
+    settings.useIoUring = ioUringOption->IsSpecified();
+    settings.workerCount = settings.useIoUring 
+        ? cores : cores * AnalysisWorkersPerCore;
+    settings.queueDepth = DefaultQueueDepth;
+    settings.cachePolicy = GetCachePolicy();
+    settings.verify = verifyOption->IsSpecified();
+    for (size_t i = 0; i < queueDepthParams.size(); i++)
+    {
+        if (queueDepthParams[i]->IsSpecified())
+            settings.queueDepth = QueueDepths[i];
+    }
+
+    // The inventory is written again from scratch, with the rows the
+    // journal kept for the files earlier runs finished, so it doesn't
+    // matter how much of it those runs managed to write.
+    std::unique_ptr<BatchJournal> journal;
+    if (resumeOption->IsSpecified())
+    {
+        std::string kind = format == InventoryFormat::Csv 
+            ? "analyze csv" : "analyze ndjson";
+        if (settings.verify)
+            kind += " verify";
+
+        journal = OpenJournal(kind, 
+            [&](const std::string& fileName, const std::string& row)
+            {
+                inventory.WriteFormatted(row);
+            });
+        if (journal == nullptr)
+            return ExitStatusOutputFileError;
+    }
+
+    std::unique_ptr<FileShard> shard = OpenShard();
+
+    BatchAnalyzer analyzer{ settings };
+    BatchStats stats = analyzer.Run(
+        inputFileParam->Value(), 
+        [&](const BatchResult& result)
+        {
+            std::string row = inventory.Format(result);
+            inventory.WriteFormatted(row);
+
+            // Files that failed aren't journaled, so a resumed run tries
+            // them again in case what stopped them was passing.
+            if (journal != nullptr && result.probe.error.empty())
+                journal->Record(result.probe.fileName, row);
+        },
+        [&](const std::string& fileName)
+        {
+            if (shard != nullptr && !shard->Contains(fileName))
+                return false;
+            return journal == nullptr || !journal->Contains(fileName);
+        });
+
+    output->flush();
+    if (journal != nullptr && !journal->Flush())
+    {
+        logger->Write(
+            "Unable to write the journal, so some files will be redone", 
+            Logging::LogLevel::Warning);
+    }
+
+    for (const std::string& walkError : stats.walkErrors)
+        logger->Write(walkError, Logging::LogLevel::Error);
+
+    // The summary doubles as a benchmark, so runs with and without io_uring
+    // or at different queue depths can be compared on the same folder.
+    double megabytesPerSecond = stats.seconds > 0 
+        ? stats.bytesAnalyzed / (1024.0 * 1024.0) / stats.seconds : 0.0;
+
+    std::stringstream summary;
+    summary << "Analyzed " << stats.fileCount << " files (" 
+            << stats.errorCount << " errors) in " << std::fixed 
+            << std::setprecision(2) << stats.seconds << " s, " 
+            << std::setprecision(1) << megabytesPerSecond << " MB/s with "
+            << settings.workerCount << " workers";
+
+    if (stats.usedIoUring)
+        summary << " using io_uring at queue depth " << settings.queueDepth;
+    else if (settings.useIoUring)
+        summary << " (io_uring unavailable, used blocking reads)";
+
+    if (journal != nullptr)
+        summary << ", " << journal->EarlierCount() << " done by earlier runs";
+
+    logger->Write(summary.str());
+
+    PrintCacheResidency("Page Cache Retained", stats.cacheResidency);
+
+    if (settings.verify)
+    {
+        PrintField("Failed Verification", 
+                   std::to_string(stats.verifyFailureCount));
+        if (stats.verifyFailureCount > 0)
+            return ExitStatusVerifyFailed;
+    }
+
+    if (!stats.walkErrors.empty())
+        return ExitStatusInputFileError;
+
+    return ExitStatusSuccess;
+}
+
+int Program::ConvertFiles()
+{
+    if (!outputFileParam->IsSpecified())
+    {
+        logger->Write(
+            "Converting a folder needs an output folder", 
+            Logging::LogLevel::Error);
+        return ExitStatusOutputFileError;
+    }
+
+    struct DepthChoice
+    {
+        CmdLine::OptionParam* param;
+        BitDepth depth;
+        const char* name;
+    };
+
+    DepthChoice depths[]{ 
+        { to8BitParam.get(), BitDepth::UInt8, "8-bit" },
+        { to16BitParam.get(), BitDepth::Int16, "16-bit" },
+        { to24BitParam.get(), BitDepth::Int24, "24-bit" },
+        { to32BitParam.get(), BitDepth::Int32, "32-bit" } };
+
+    std::string kind{ "convert" };
+    BitDepth depth = BitDepth::Int16;
+    bool hasDepth{ false };
+    for (const DepthChoice& choice : depths)
+    {
+        if (choice.param->IsSpecified())
+        {
+            depth = choice.depth;
+            kind += std::string{ " " } + choice.name;
+            hasDepth = true;
+        }
+    }
+
+    if (!hasDepth)
+    {
+        logger->Write("No bit depth to convert to", Logging::LogLevel::Error);
+        return ExitStatusInvalidArgsError;
+    }
+
+    ConversionMethod method = ConversionMethod::LinearScaling;
+    if (directCopyParam->IsSpecified())
+        method = ConversionMethod::DirectCopy;
+    kind += method == ConversionMethod::DirectCopy 
+        ? " directcopy" : " linearscale";
+
+    std::unique_ptr<BatchJournal> journal;
+    if (resumeOption->IsSpecified())
+    {
+        journal = OpenJournal(kind);
+        if (journal == nullptr)
+            return ExitStatusOutputFileError;
+    }
+
+    std::filesystem::path inputRoot{ inputFileParam->Value() };
+    std::filesystem::path outputRoot{ outputFileParam->Value() };
+    std::unique_ptr<FileShard> shard = OpenShard();
+
+    // Conversion reads and writes every byte, so it is bound by storage and
+    // runs one worker per core rather than the several analysis runs.
+    unsigned int workerCount = std::max(
+        1u, std::thread::hardware_concurrency());
+    WorkQueue<std::string> queue{ workerCount * 64 };
+    std::atomic<unsigned long> fileCount{ 0 };
+    std::atomic<unsigned long> errorCount{ 0 };
+    unsigned long skippedCount{ 0 };
+    unsigned long walkErrorCount{ 0 };
+
+    // Errors are reported here with the file they belong to, so the files
+    // themselves write to a logger with no channels.
+    auto fileLogger = std::make_shared<Logging::Logger>();
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < workerCount; i++)
+    {
+        workers.emplace_back([&]()
+        {
+            std::string fileName;
+            while (queue.Pop(fileName))
+            {
+                std::filesystem::path outputName = outputRoot / 
+                    std::filesystem::path{ fileName }.lexically_relative(
+                        inputRoot);
+                std::string partialName = 
+                    outputName.string() + PartialExtension;
+
+                // Each file is written under a temporary name and only given
+                // its own once the conversion is complete, so whatever an
+                // interrupted run left under the temporary name is redone.
+                std::error_code error;
+                std::filesystem::create_directories(
+                    outputName.parent_path(), error);
+                std::filesystem::remove(partialName, error);
+
+                std::string reason;
+                try
+                {
+                    std::shared_ptr<MediaFile> file = CreateMediaFile(
+                        fileName, fileLogger);
+                    if (file == nullptr)
+                        throw MediaFormatError{ "Unsupported file type" };
+
+                    // Convert syncs the output as it closes it, so a file is
+                    // on disk before it is renamed and journaled as done.
+                    file->SetCachePolicy(GetCachePolicy());
+                    file->Open();
+                    if (!file->Convert(partialName, depth, method))
+                        reason = "Unable to convert " + fileName;
+                }
+                catch (const MediaFormatError& formatError)
+                {
+                    reason = formatError.what();
+                }
+
+                if (reason.empty())
+                {
+                    std::filesystem::rename(partialName, outputName, error);
+                    if (error)
+                        reason = "Unable to rename " + partialName;
+                }
+
+                fileCount++;
+                if (!reason.empty())
+                {
+                    errorCount++;
+                    std::filesystem::remove(partialName, error);
+                    logger->Write(fileName + ": " + reason, 
+                                  Logging::LogLevel::Error);
+                }
+                else if (journal != nullptr)
+                {
+                    journal->Record(fileName, outputName.string());
+                }
+            }
+        });
+    }
+
+    // A file an earlier run finished is only passed over if its output is
+    // still there; one that was since deleted is converted again.
+    EnumerateMediaFiles(inputRoot.string(), [&](const std::string& fileName)
+    {
+        if (shard != nullptr && !shard->Contains(fileName))
+            return;
+
+        if (journal != nullptr && journal->Contains(fileName))
+        {
+            std::filesystem::path outputName = outputRoot / 
+                std::filesystem::path{ fileName }.lexically_relative(
+                    inputRoot);
+            if (std::filesystem::exists(outputName))
+            {
+                skippedCount++;
+                return;
+            }
+        }
+
+        queue.Push(fileName);
+    }, 
+    nullptr, 
+    [&](const std::string& folder, const std::error_code& error)
+    {
+        walkErrorCount++;
+        logger->Write(folder + ": " + error.message(), 
+                      Logging::LogLevel::Error);
+    });
+    queue.Close();
+
+    for (std::thread& worker : workers)
+        worker.join();
+
+    if (journal != nullptr && !journal->Flush())
+    {
+        logger->Write(
+            "Unable to write the journal, so some files will be redone", 
+            Logging::LogLevel::Warning);
+    }
+
+    std::chrono::duration<double> elapsed = 
+        std::chrono::steady_clock::now() - start;
+
+    std::stringstream summary;
+    summary << "Converted " << fileCount - errorCount << " files (" 
+            << errorCount << " errors) in " << std::fixed 
+            << std::setprecision(2) << elapsed.count() << " s";
+    if (journal != nullptr)
+        summary << ", " << skippedCount << " done by earlier runs";
+    logger->Write(summary.str());
+
+    if (errorCount > 0)
+        return ExitStatusOutputFileError;
+    if (walkErrorCount > 0)
+        return ExitStatusInputFileError;
+
+    return ExitStatusSuccess;
+}
+
+int Program::MergeInventories()
+{
+    std::string inputPath = inputFileParam->Value();
+    if (!std::filesystem::is_directory(inputPath))
+    {
+        std::stringstream error;
+        error << inputPath << " is not a folder!";
+        logger->Write(error.str(), Logging::LogLevel::Error);
+        return ExitStatusInputFileError;
+    }
+
+    std::ofstream outputFile;
+    InventoryFormat format;
+    std::ostream* output = OpenInventory(outputFile, format);
+    if (output == nullptr)
+        return ExitStatusOutputFileError;
+
+    // Only the inventories in the format being written are merged, which
+    // passes over journals and the like kept beside them. The report itself
+    // may be in the same folder, and is left out.
+    std::vector<std::string> fileNames;
+    std::error_code error;
+    for (const auto& entry : 
+         std::filesystem::directory_iterator{ inputPath, error })
+    {
+        std::string fileName = entry.path().string();
+        if (!IsInventoryFile(fileName, format))
+            continue;
+
+        if (outputFileParam->IsSpecified() && 
+            std::filesystem::equivalent(
+                fileName, outputFileParam->Value(), error))
+            continue;
+
+        fileNames.push_back(fileName);
+    }
+
+    if (fileNames.empty())
+    {
+        logger->Write("No inventories to merge", Logging::LogLevel::Error);
+        return ExitStatusInputFileError;
+    }
+
+    // Sorted so the same row wins a duplicate whatever order the folder
+    // lists its files in.
+    std::sort(fileNames.begin(), fileNames.end());
+
+    InventoryMerger merger{ format };
+    for (const std::string& fileName : fileNames)
+    {
+        std::string mergeError = merger.Add(fileName);
+        if (!mergeError.empty())
+        {
+            logger->Write(mergeError, Logging::LogLevel::Error);
+            return ExitStatusInputFileError;
+        }
+    }
+
+    merger.Write(*output);
+    output->flush();
+
+    std::stringstream summary;
+    summary << "Merged " << merger.RowCount() << " files from " 
+            << fileNames.size() << " inventories (" 
+            << merger.DuplicateCount() << " duplicates)";
+    logger->Write(summary.str());
+
+    return ExitStatusSuccess;
+}
+
+int Program::BenchmarkAnalysis()
+{
+    // The first pass warms the page cache so every strategy reads the file
+    // from memory and the timings compare only the cost of reading it.
+    std::shared_ptr<MediaFile> inputFile = OpenFile(inputFileParam->Value());
+    if (inputFile == nullptr)
+        return ExitStatusInputFileError;
+
+    logger->Write("Benchmarking analysis, please wait...");
+    logger->Write("");
+    inputFile->Analyze(false);
+
+    PrintSectionHeader("Analysis Throughput");
+
+    ReadStrategy strategies[]{ 
+        ReadStrategy::Buffered, 
+        ReadStrategy::MemoryMapped, 
+        ReadStrategy::InMemory };
+
+    for (ReadStrategy strategy : strategies)
+    {
+        std::string name = ReadStrategyName(strategy);
+        std::shared_ptr<ByteSource> source = OpenByteSource(
+            inputFileParam->Value(), strategy);
+        if (source == nullptr)
+        {
+            PrintField(name, "unavailable");
+            continue;
+        }
+
+        std::shared_ptr<MediaFile> file = CreateMediaFile(
+            inputFileParam->Value(), logger);
+        file->Open();
+        file->SetAnalysisSource(source);
+
+        auto start = std::chrono::steady_clock::now();
+        file->Analyze(false);
+        std::chrono::duration<double> elapsed = 
+            std::chrono::steady_clock::now() - start;
+
+        double megabytes = file->AnalysisRange().size / (1024.0 * 1024.0);
+        double megabytesPerSecond = elapsed.count() > 0 
+            ? megabytes / elapsed.count() : 0.0;
+
+        std::stringstream result;
+        result << std::fixed << std::setprecision(1) << megabytesPerSecond 
+               << " MB/s (" << std::setprecision(3) << elapsed.count() 
+               << " s)";
+        PrintField(name, result.str());
+    }
+
+    // FLAC analysis normally settles frames from their wasted bits, so time
+    // the per-sample path too and check that both reach the same verdict.
+    FlacFile* flacFile = dynamic_cast<FlacFile*>(inputFile.get());
+    if (flacFile != nullptr)
+    {
+        flacFile->SetUseWastedBits(false);
+
+        auto start = std::chrono::steady_clock::now();
+        flacFile->Analyze(false);
+        std::chrono::duration<double> elapsed = 
+            std::chrono::steady_clock::now() - start;
+
+        bool fullVerdict = flacFile->IsUpscaled();
+        flacFile->SetUseWastedBits(true);
+        flacFile->Analyze(false);
+
+        std::stringstream result;
+        result << std::fixed << std::setprecision(3) << elapsed.count() 
+               << " s, verdict " 
+               << (fullVerdict == flacFile->IsUpscaled() ? "matches" 
+                                                         : "DIFFERS");
+        PrintField("full decode", result.str());
+    }
+
+    return ExitStatusSuccess;
+}
+
+#ifndef _WIN32
+/// @brief The server Serve is running, for the signal handler to stop.
+static std::atomic<AnalysisServer*> runningServer{ nullptr };
+
+static void StopServer(int signal)
+{
+    AnalysisServer* server = runningServer.load();
+    if (server != nullptr)
+        server->Stop();
+}
+#endif
+
+int Program::Serve()
+{
+#ifdef _WIN32
+    logger->Write("Serving requests is not supported on this platform", 
+                  Logging::LogLevel::Error);
+    return ExitStatusNotImplemented;
+#else
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    ServerSettings settings;
+    settings.socketPath = inputFileParam->Value();
+    settings.workerCount = cores * AnalysisWorkersPerCore;
+    settings.batch.cachePolicy = GetCachePolicy();
+    settings.batch.verify = verifyOption->IsSpecified();
+
+    AnalysisServer server{ settings, logger };
+    if (!server.Start())
+        return ExitStatusServerError;
+
+    // Interrupting the server, or a service manager stopping it, lets the
+    // requests already made finish before it exits. SA_RESTART is left
+    // off so the signal also interrupts the wait for a connection.
+    runningServer = &server;
+    struct sigaction action{ };
+    action.sa_handler = StopServer;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    std::stringstream listening;
+    listening << "Serving requests on " << settings.socketPath << " with " 
+              << settings.workerCount << " workers";
+    logger->Write(listening.str());
+
+    server.Run();
+    runningServer = nullptr;
+
+    ServerStats stats = server.Stats();
+    std::stringstream summary;
+    summary << "Served " << stats.requests << " requests on " 
+            << stats.connections << " connections (" << stats.cacheHits 
+            << " from cache), analyzed " << stats.filesAnalyzed 
+            << " files and converted " << stats.filesConverted;
+    logger->Write(summary.str());
+
+    return ExitStatusSuccess;
+#endif
+}
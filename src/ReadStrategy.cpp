@@ -0,0 +1,82 @@
+// ReadStrategy.cpp - Defines the functions declared with ReadStrategy.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+#include "ReadStrategy.h"
+#include "FileReader.h"
+#include "MappedFile.h"
+#include "MemorySource.h"
+
+/// @brief A MemorySource that owns a copy of a whole file.
+class LoadedFile : public MemorySource
+{
+public:
+    LoadedFile(std::vector<std::uint8_t> bytes) : bytes{ std::move(bytes) }
+    {
+        SetData(this->bytes.data(), this->bytes.size());
+    }
+private:
+    std::vector<std::uint8_t> bytes;
+};
+
+std::shared_ptr<ByteSource> OpenByteSource(
+    std::string fileName, 
+    ReadStrategy strategy)
+{
+    switch (strategy)
+    {
+        case ReadStrategy::MemoryMapped:
+        {
+            auto file = std::make_shared<MappedFile>(fileName);
+            file->Open();
+            if (file->IsOpen())
+                return file;
+            return nullptr;
+        }
+        case ReadStrategy::InMemory:
+        {
+            FileReader reader{ fileName };
+            reader.Open();
+            if (!reader.IsOpen())
+                return nullptr;
+
+            std::vector<std::uint8_t> bytes(reader.Size());
+            bytes.resize(reader.Read(bytes.data(), bytes.size()));
+            return std::make_shared<LoadedFile>(std::move(bytes));
+        }
+        default:
+        {
+            auto file = std::make_shared<FileReader>(fileName);
+            file->Open();
+            if (file->IsOpen())
+                return file;
+            return nullptr;
+        }
+    }
+}
+
+std::string ReadStrategyName(ReadStrategy strategy)
+{
+    switch (strategy)
+    {
+        case ReadStrategy::MemoryMapped:
+            return "mmap";
+        case ReadStrategy::InMemory:
+            return "memory";
+        default:
+            return "buffered";
+    }
+}
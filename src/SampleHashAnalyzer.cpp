@@ -0,0 +1,47 @@
+// SampleHashAnalyzer.cpp - Defines the SampleHashAnalyzer class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "SampleHashAnalyzer.h"
+
+void SampleHashAnalyzer::Process(const SampleBlock& block)
+{
+    std::uint64_t value{ hash };
+
+    const std::int32_t* interleaved = block.Interleaved();
+    if (interleaved != nullptr)
+    {
+        size_t count = block.SampleCount();
+        for (size_t i = 0; i < count; i++)
+        {
+            value ^= static_cast<std::uint32_t>(interleaved[i]);
+            value *= Prime;
+        }
+    }
+    else
+    {
+        for (size_t frame = 0; frame < block.frameCount; frame++)
+        {
+            for (int channel = 0; channel < block.channelCount; channel++)
+            {
+                value ^= static_cast<std::uint32_t>(
+                    block.Sample(channel, frame));
+                value *= Prime;
+            }
+        }
+    }
+
+    hash = value;
+}
@@ -0,0 +1,213 @@
+// SampleRing.cpp - Defines the SampleRing class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <thread>
+#include <cstring>
+#include <algorithm>
+#include "SampleRing.h"
+
+/// @brief The number of checks a waiting side makes before it yields, and
+/// before it sleeps.
+static constexpr int SpinAttempts{ 64 };
+static constexpr int YieldAttempts{ 256 };
+
+static constexpr std::chrono::microseconds SleepInterval{ 50 };
+
+/// @brief Waits a little longer each attempt before the caller checks the
+/// ring again.
+static void Backoff(int& attempt)
+{
+    if (attempt >= YieldAttempts)
+        std::this_thread::sleep_for(SleepInterval);
+    else if (attempt >= SpinAttempts)
+        std::this_thread::yield();
+
+    attempt = std::min(attempt + 1, YieldAttempts);
+}
+
+static double SecondsSince(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+SampleRing::SampleRing(
+    const SampleRingSettings& settings,
+    int channels,
+    int consumers) :
+    buffers(std::max<size_t>(settings.bufferCount, 1)),
+    consumers(std::max(consumers, 1)),
+    channels{ std::max(channels, 1) },
+    framesPerBuffer{ std::max<size_t>(settings.framesPerBuffer, 1) }
+{
+    for (Buffer& buffer : buffers)
+    {
+        buffer.samples.resize(this->channels * framesPerBuffer);
+        buffer.channelSamples.resize(this->channels);
+    }
+}
+
+bool SampleRing::Push(const SampleBlock& block)
+{
+    for (size_t first = 0; first < block.frameCount; first += framesPerBuffer)
+    {
+        std::uint64_t next = position.load(std::memory_order_relaxed);
+        bool anyAttached{ true };
+        if (!HasFreeBuffer(next, anyAttached))
+        {
+            auto start = std::chrono::steady_clock::now();
+            producerStalls++;
+
+            int attempt{ 0 };
+            while (!HasFreeBuffer(next, anyAttached))
+                Backoff(attempt);
+            producerStallSeconds += SecondsSince(start);
+        }
+
+        if (!anyAttached)
+            return false;
+
+        size_t frameCount = std::min(framesPerBuffer, block.frameCount - first);
+        Fill(buffers[next % buffers.size()], block, first, frameCount);
+        blocks++;
+
+        // Publishes the samples along with the index, so a consumer that
+        // sees the new index sees the whole buffer.
+        position.store(next + 1, std::memory_order_release);
+    }
+    return true;
+}
+
+void SampleRing::Close()
+{
+    isClosed.store(true, std::memory_order_release);
+}
+
+const SampleBlock* SampleRing::Acquire(int consumer)
+{
+    Consumer& reader = consumers[consumer];
+    std::uint64_t next = reader.position.load(std::memory_order_relaxed);
+    if (position.load(std::memory_order_acquire) == next)
+    {
+        auto start = std::chrono::steady_clock::now();
+        reader.stalls++;
+
+        int attempt{ 0 };
+        while (position.load(std::memory_order_acquire) == next)
+        {
+            // The decoder's last block is published before it closes the
+            // ring, so the position is checked once more after the close.
+            if (isClosed.load(std::memory_order_acquire) &&
+                position.load(std::memory_order_acquire) == next)
+            {
+                reader.stallSeconds += SecondsSince(start);
+                return nullptr;
+            }
+            Backoff(attempt);
+        }
+        reader.stallSeconds += SecondsSince(start);
+    }
+
+    return &buffers[next % buffers.size()].block;
+}
+
+void SampleRing::Release(int consumer)
+{
+    Consumer& reader = consumers[consumer];
+    std::uint64_t next = reader.position.load(std::memory_order_relaxed) + 1;
+    reader.position.store(next, std::memory_order_release);
+}
+
+void SampleRing::Detach(int consumer)
+{
+    consumers[consumer].isDetached.store(true, std::memory_order_release);
+}
+
+SampleRingStats SampleRing::Stats() const
+{
+    SampleRingStats stats;
+    stats.blocks = blocks;
+    stats.producerStalls = producerStalls;
+    stats.producerStallSeconds = producerStallSeconds;
+    for (const Consumer& reader : consumers)
+    {
+        stats.consumerStalls += reader.stalls;
+        stats.consumerStallSeconds += reader.stallSeconds;
+    }
+    return stats;
+}
+
+bool SampleRing::HasFreeBuffer(std::uint64_t next, bool& anyAttached) const
+{
+    anyAttached = false;
+    for (const Consumer& reader : consumers)
+    {
+        if (reader.isDetached.load(std::memory_order_acquire))
+            continue;
+
+        anyAttached = true;
+        std::uint64_t read = reader.position.load(std::memory_order_acquire);
+        if (next - read >= buffers.size())
+            return false;
+    }
+    return true;
+}
+
+void SampleRing::Fill(
+    Buffer& buffer,
+    const SampleBlock& block,
+    size_t first,
+    size_t frameCount)
+{
+    SampleBlock& copy = buffer.block;
+    copy.channels = buffer.channelSamples.data();
+    copy.channelCount = channels;
+    copy.frameCount = frameCount;
+    copy.zeroLowBits = block.zeroLowBits;
+
+    // The block keeps its layout, so an interleaved one is a single copy.
+    const std::int32_t* interleaved = block.Interleaved();
+    if (interleaved != nullptr)
+    {
+        std::memcpy(buffer.samples.data(), interleaved + first * channels,
+                    frameCount * channels * sizeof(std::int32_t));
+        for (int channel = 0; channel < channels; channel++)
+            buffer.channelSamples[channel] = buffer.samples.data() + channel;
+        copy.stride = channels;
+        return;
+    }
+
+    for (int channel = 0; channel < channels; channel++)
+    {
+        std::int32_t* samples =
+            buffer.samples.data() + channel * framesPerBuffer;
+        const std::int32_t* source =
+            block.channels[channel] + first * block.stride;
+        if (block.stride == 1)
+        {
+            std::memcpy(samples, source, frameCount * sizeof(std::int32_t));
+        }
+        else
+        {
+            for (size_t i = 0; i < frameCount; i++)
+                samples[i] = source[i * block.stride];
+        }
+        buffer.channelSamples[channel] = samples;
+    }
+    copy.stride = 1;
+}
@@ -0,0 +1,90 @@
+// StreamSource.cpp - Defines the StreamSource class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstring>
+#include "StreamSource.h"
+#include "FileDescriptor.h"
+
+StreamSource::StreamSource(int descriptor, size_t bufferSize) :
+    descriptor{ descriptor },
+    buffer(std::max<size_t>(bufferSize, 1)),
+    bufferStart{ 0 },
+    bufferPosition{ 0 },
+    bufferLength{ 0 }
+{ 
+#ifdef _WIN32
+    // Standard input is opened in text mode, which would mangle the bytes.
+    _setmode(descriptor, _O_BINARY);
+#endif
+}
+
+size_t StreamSource::Read(void* data, size_t size)
+{
+    std::uint8_t* destination = static_cast<std::uint8_t*>(data);
+    size_t bytesRead{ 0 };
+
+    while (bytesRead < size)
+    {
+        if (bufferPosition == bufferLength && !FillBuffer())
+            break;
+
+        size_t count = std::min(size - bytesRead, 
+                                bufferLength - bufferPosition);
+        std::memcpy(destination + bytesRead, 
+                    buffer.data() + bufferPosition, 
+                    count);
+        bufferPosition += count;
+        bytesRead += count;
+    }
+
+    return bytesRead;
+}
+
+bool StreamSource::Seek(std::uint64_t position)
+{
+    if (position < bufferStart)
+        return false;
+
+    while (position > bufferStart + bufferLength)
+    {
+        bufferPosition = bufferLength;
+        if (!FillBuffer())
+            return false;
+    }
+
+    bufferPosition = static_cast<size_t>(position - bufferStart);
+    return true;
+}
+
+bool StreamSource::FillBuffer()
+{
+    if (bufferLength == buffer.size())
+    {
+        bufferStart += bufferLength;
+        bufferPosition = 0;
+        bufferLength = 0;
+    }
+
+    long long result = ReadDescriptor(descriptor, 
+                                      buffer.data() + bufferLength, 
+                                      buffer.size() - bufferLength);
+    if (result <= 0)
+        return false;
+
+    bufferLength += static_cast<size_t>(result);
+    return true;
+}
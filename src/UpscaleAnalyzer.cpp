@@ -0,0 +1,47 @@
+// UpscaleAnalyzer.cpp - Defines the UpscaleAnalyzer class methods.
+//
+// Copyright (C) 2025 Stephen Bonar
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "UpscaleAnalyzer.h"
+
+void UpscaleAnalyzer::Process(const SampleBlock& block)
+{
+    // A block whose decoder already knows the low byte is zero, such as a
+    // FLAC frame with enough wasted bits, is settled without looking.
+    if (!isUpscaled || block.zeroLowBits >= LowByteBits)
+        return;
+
+    for (int channel = 0; channel < block.channelCount; channel++)
+    {
+        const std::int32_t* samples = block.channels[channel];
+        for (size_t i = 0; i < block.frameCount; i++)
+        {
+            // Perform a bitwise and against the bitmask 0xFF to select the
+            // bits in the least significant byte. If even one is non-zero,
+            // the file is not likely to be an upscale conversion.
+            if ((samples[i * block.stride] & 0xFF) != 0)
+            {
+                isUpscaled = false;
+                return;
+            }
+        }
+    }
+}
+
+void UpscaleAnalyzer::Append(const SampleAnalyzer& next)
+{
+    const auto& other = static_cast<const UpscaleAnalyzer&>(next);
+    isUpscaled = isUpscaled && other.isUpscaled;
+}
@@ -14,16 +14,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <limits>
 #include "WaveFile.h"
 
 WaveFile::WaveFile(
     std::string fileName, 
-    std::shared_ptr<Logging::Logger> logger)
+    std::shared_ptr<Logging::Logger> logger) : PcmFile{ fileName, logger }
 {
-    this->fileName = fileName;
-    this->logger = logger;
-    this->isUpscaled = false;
-    readStream = std::make_shared<Binary::RawFileStream>(fileName);
     //sampleDumper = std::make_shared<SampleDumper>(fileName);
 }
 
@@ -32,286 +29,219 @@ void WaveFile::Open()
     if (!Exists())
         logger->Write("File does not exist!", Logging::LogLevel::Error);
 
-    if (!readStream->IsOpen())
+    if (!OpenInput())
     {
-        readStream->Open(Binary::FileMode::Read);
-        if (!readStream->IsOpen())
-            logger->Write("Unable to open file", Logging::LogLevel::Error);
+        logger->Write("Unable to open file", Logging::LogLevel::Error);
+        return;
     }
-        
-    //chunkHeader = ReadChunkHeader();
-    readStream->Read(&riffChunkHeader);
-    readStream->Read(&riffFileType);
 
+    input->Seek(0);
+    ReadChunkHeader(riffChunkHeader);
+
+    std::uint8_t fileType[4];
+    ReadBytes(fileType, sizeof(fileType));
+    riffFileType.SetValue(std::string(reinterpret_cast<char*>(fileType), 4));
+
+    // Only the 'fmt ' chunk is read into memory. Every other chunk before
+    // the data is recorded in the index and skipped, so a large embedded
+    // chunk such as cover art costs no more to open than a small one.
+    otherChunks.clear();
     bool dataFound = false;
 
     while (!dataFound)
     {
         Binary::ChunkHeader subChunkHeader;
-        //RiffSubChunkHeader subChunkHeader = ReadSubChunkHeader();
-        readStream->Read(&subChunkHeader);
+        ReadChunkHeader(subChunkHeader);
 
-        if (subChunkHeader.id.ToString() == "fmt ")
+        ChunkIndexEntry chunk;
+        chunk.id = subChunkHeader.id.ToString();
+        chunk.offset = input->Position();
+        chunk.size = subChunkHeader.dataSize.Value();
+
+        if (chunk.id == "fmt ")
         {
             formatHeader.id.SetValue(subChunkHeader.id.Value());
             formatHeader.dataSize.SetValue(subChunkHeader.dataSize.Value());
-
-            try
-            {
-                readStream->Read(&format);
-                //format = ReadWaveFormat();
-            }
-            catch (const MediaFormatError& error)
-            {
-                throw;
-            } 
+            formatOffset = chunk.offset;
+            ReadWaveFormat();
+            input->Seek(chunk.offset + chunk.PaddedSize());
         }
-        else if (subChunkHeader.id.ToString() == "data")
+        else if (chunk.id == "data")
         {
             dataHeader.id.SetValue(subChunkHeader.id.Value());
             dataHeader.dataSize.SetValue(subChunkHeader.dataSize.Value());
+            dataOffset = chunk.offset;
+            dataSize = chunk.size;
             dataFound = true;
+
+            // Streamed WAVE files may leave the size as a placeholder, in
+            // which case the data runs to the end of the file, or of the
+            // stream when its length isn't known.
+            if (IsPlaceholderSize(subChunkHeader.dataSize.Value(),
+                    riffChunkHeader.dataSize.Value(), dataOffset,
+                    input->Size()))
+            {
+                std::uint64_t fileSize = input->Size();
+                if (fileSize == 0)
+                    dataSize = std::numeric_limits<std::uint64_t>::max();
+                else if (fileSize > dataOffset)
+                    dataSize = fileSize - dataOffset;
+            }
         }
         else
         {
-            auto subChunkID = std::make_shared<Binary::StringField>(4);
-            auto subChunkSize = std::make_shared<Binary::UInt32Field>(0);
-            auto subChunkData = std::make_shared<Binary::RawField>(
-                subChunkHeader.dataSize.Value());
-
-            subChunkID->SetValue(subChunkHeader.id.Value());
-            subChunkSize->SetValue(subChunkHeader.dataSize.Value());
-            readStream->Read(subChunkData.get());
-
-            otherFields.push_back(subChunkID);
-            otherFields.push_back(subChunkSize);
-            otherFields.push_back(subChunkData);
+            otherChunks.push_back(chunk);
+            input->Seek(chunk.offset + chunk.PaddedSize());
         }
     }
 }
 
-/*
-RiffChunkHeader WaveFile::ReadChunkHeader()
+void WaveFile::ReadBytes(void* data, size_t size)
 {
-    RiffChunkHeader header;
-    readStream->Read(&header.id);
-    readStream->Read(&header.size);
-    readStream->Read(&header.type);
-    return header;
+    if (input->Read(data, size) != size)
+        throw MediaFormatError{ "Unexpected end of WAVE file" };
 }
 
-RiffSubChunkHeader WaveFile::ReadSubChunkHeader()
+void WaveFile::ReadChunkHeader(Binary::ChunkHeader& header)
 {
-    RiffSubChunkHeader header;
-    readStream->Read(&header.id);
-    readStream->Read(&header.size);
-    return header;
+    std::uint8_t bytes[8];
+    ReadBytes(bytes, sizeof(bytes));
+    header.id.SetValue(std::string(reinterpret_cast<char*>(bytes), 4));
+    header.dataSize.SetValue(DecodeLittleEndian(bytes + 4, 4));
 }
-*/
 
-WaveFormat WaveFile::ReadWaveFormat()
+void WaveFile::ReadWaveFormat()
 {
-    WaveFormat format;
-
-    readStream->Read(&format.audioFormat);
-    if (format.audioFormat.Value() == WaveFormatExtensible)
-        throw MediaFormatError{ "Extensible WAVE format not yet supported" };
-    else if (format.audioFormat.Value() != WaveFormatPcm)
-        throw MediaFormatError{ "Non-PCM wave formats not supported" };
-
-    readStream->Read(&format.channels);
-    readStream->Read(&format.sampleRate);
-    readStream->Read(&format.byteRate);
-    readStream->Read(&format.blockAlign);
-    readStream->Read(&format.bitsPerSample);
-
-    return format;
+    constexpr size_t pcmFormatSize{ 16 };
+    if (formatHeader.dataSize.Value() < pcmFormatSize)
+        throw MediaFormatError{ "WAVE format chunk is too small" };
+
+    std::uint8_t bytes[pcmFormatSize];
+    ReadBytes(bytes, sizeof(bytes));
+    format.audioFormat.SetValue(DecodeLittleEndian(bytes, 2));
+    format.channels.SetValue(DecodeLittleEndian(bytes + 2, 2));
+    format.sampleRate.SetValue(DecodeLittleEndian(bytes + 4, 4));
+    format.byteRate.SetValue(DecodeLittleEndian(bytes + 8, 4));
+    format.blockAlign.SetValue(DecodeLittleEndian(bytes + 12, 2));
+    format.bitsPerSample.SetValue(DecodeLittleEndian(bytes + 14, 2));
 }
 
-void WaveFile::Analyze(bool dumpSamples)
+void WaveFile::WriteChunkHeader(std::string id, std::uint32_t dataSize)
 {
-    unsigned long bytesRemaining = dataHeader.dataSize.Value();
-
-    // Start by assuming the file is an upscale conversion; the analysis will
-    // disprove it if it finds any non-zero least significant bytes.
-    isUpscaled = true;
-    
-    int bytesPerSample = 0;
-    switch (format.bitsPerSample.Value())
-    {
-        case 8:
-            bytesPerSample = 1;
-            break;
-        case 16:
-            bytesPerSample = 2;
-            break;
-        case 24:
-            bytesPerSample = 3;
-            break;
-        case 32:
-            bytesPerSample = 4;
-            break;
-    }
-    if (bytesPerSample == 0)
-        return;
+    std::uint8_t bytes[8];
+    id.copy(reinterpret_cast<char*>(bytes), 4);
+    EncodeLittleEndian(dataSize, bytes + 4, 4);
+    writer->Write(bytes, sizeof(bytes));
+}
 
-    while (bytesRemaining > 0)
-    {
-        switch (format.bitsPerSample.Value())
-        {
-            case 8:
-                AnalyzeNextSample<Binary::UInt8Field>(dumpSamples);
-                break;
-            case 16:
-                AnalyzeNextSample<Binary::Int16Field>(dumpSamples);
-                break;
-            case 24:
-                AnalyzeNextSample<Binary::Int24Field>(dumpSamples);
-                break;
-            case 32:
-                AnalyzeNextSample<Binary::Int32Field>(dumpSamples);
-                break;
-        }
-        
-        bytesRemaining -= bytesPerSample;
-    }
+void WaveFile::WriteFormatInfo(WaveFormat& format)
+{
+    std::uint8_t bytes[16];
+    EncodeLittleEndian(format.audioFormat.Value(), bytes, 2);
+    EncodeLittleEndian(format.channels.Value(), bytes + 2, 2);
+    EncodeLittleEndian(format.sampleRate.Value(), bytes + 4, 4);
+    EncodeLittleEndian(format.byteRate.Value(), bytes + 8, 4);
+    EncodeLittleEndian(format.blockAlign.Value(), bytes + 12, 2);
+    EncodeLittleEndian(format.bitsPerSample.Value(), bytes + 14, 2);
+    writer->Write(bytes, sizeof(bytes));
 }
 
-void WaveFile::Convert(
+bool WaveFile::Convert(
     std::string outputFileName, 
     BitDepth depth, 
     ConversionMethod method)
 {
-    // Open the file stream for writing so we can write the converted data. 
-    writeStream = std::make_shared<Binary::RawFileStream>(outputFileName);
-    if (!writeStream->IsOpen())
-        writeStream->Open(Binary::FileMode::Write);
+    // Open the file for writing so we can write the converted data. 
+    if (!OpenWriter(outputFileName))
+        return false;
 
     // Calculate how the file will change after the conversion so we can set
     // the headers of the converted file to the appropriate values.
     long numberOfSamples = CalculateNumberOfSamples();
     long newDataSize = CalculateNewDataSize(depth, numberOfSamples);
-    long sizeChange = newDataSize - dataHeader.dataSize.Value();
 
-    // Write the modified headers to the converted file to reflect the changes.
-    /*
-    WriteChunkHeader(GetNewChunkHeader(sizeChange));
-    WriteSubChunkHeader(formatHeader);
-    WriteFormatInfo(GetNewWaveFormat(depth));
-    */
-    Binary::ChunkHeader newChunkHeader;
-    newChunkHeader.id.SetValue(riffChunkHeader.id.Value());
-    newChunkHeader.dataSize.SetValue(riffChunkHeader.dataSize.Value() + sizeChange);
-    Binary::ChunkHeader formatSubChunk;
-    formatSubChunk.id.SetValue("fmt ");
-    formatSubChunk.dataSize.SetValue(16);
-    WaveFormat newFormat = GetNewWaveFormat(depth);
-    writeStream->Write(&newChunkHeader);
-    writeStream->Write(&riffFileType);
-    writeStream->Write(&formatSubChunk);
-    writeStream->Write(&newFormat);
+    // A direct copy to the same bit depth leaves every sample unchanged, so
+    // a file whose headers are already the ones written below is copied
+    // as-is. Cloning it lets the kernel copy it, or share its extents on
+    // filesystems with reflinks.
+    if (method == ConversionMethod::DirectCopy && 
+        newDataSize == dataHeader.dataSize.Value() &&
+        HasConvertedLayout(depth))
+    {
+        if (!writer->CloneFrom(*reader) || !writer->Close())
+        {
+            logger->Write("Unable to copy file", Logging::LogLevel::Error);
+            return false;
+        }
+        return true;
+    }
 
+    // The RIFF size covers the file type, the 16 byte PCM format chunk we
+    // write, each copied chunk with its pad byte, and the new data chunk.
+    constexpr std::uint64_t chunkHeaderSize{ 8 };
+    std::uint64_t newRiffSize = 4 + chunkHeaderSize + 16;
+    for (const ChunkIndexEntry& chunk : otherChunks)
+        newRiffSize += chunkHeaderSize + chunk.PaddedSize();
+    newRiffSize += chunkHeaderSize + newDataSize + (newDataSize & 1);
 
-    // Writes the additional subchunk fields that this program is not concerned
-    // about. This is things like the fields for the info subchunk. It copies 
-    // these as-is to the new file.
-    for (auto field : otherFields)
-        writeStream->Write(field.get());
+    // Write the modified headers to the converted file to reflect the changes.
+    WaveFormat newFormat = GetNewWaveFormat(depth);
+    WriteChunkHeader(riffChunkHeader.id.Value(), newRiffSize);
+    writer->Write(riffFileType.Value().data(), 4);
+    WriteChunkHeader("fmt ", 16);
+    WriteFormatInfo(newFormat);
+
+    // Copies the additional subchunks that this program is not concerned
+    // about, such as the info subchunk, as-is to the new file. They are read
+    // from the source file now rather than being held in memory since Open,
+    // and FileWriter copies them in the kernel where it can.
+    for (const ChunkIndexEntry& chunk : otherChunks)
+    {
+        WriteChunkHeader(chunk.id, chunk.size);
+        if (!writer->WriteFrom(*reader, chunk.offset, chunk.PaddedSize()))
+        {
+            logger->Write("Unable to copy chunk", Logging::LogLevel::Error);
+            return false;
+        }
+    }
 
     // After writing all the other subchunk fields, the data subchunk should be
     // written last. 
-    Binary::ChunkHeader newDataHeader;
-    newDataHeader.id.SetValue(dataHeader.id.Value());
-    newDataHeader.dataSize.SetValue(newDataSize);
-    //WriteSubChunkHeader(newDataHeader);
-    writeStream->Write(&newDataHeader);
-
-    // We determine the number of bytes remaining in the existing file so we 
-    // don't read past the end of the file.
-    long bytesRemaining = dataHeader.dataSize.Value();
-
-    // We need to know bytes per sample so we can see how many bytes are
-    // remaining after we convert each sample.
-    int bytesPerSample = format.bitsPerSample.Value() / 8;
-
-    // Now convert each sample and write out the converted samples to finish 
-    // the conversion.
-    while (bytesRemaining > 0)
-    {
-        bool success = false;
+    WriteChunkHeader(dataHeader.id.Value(), newDataSize);
 
-        switch (format.bitsPerSample.Value())
+    // A direct copy to the depth the samples already have leaves them as
+    // the same bytes, so they are copied as they are, in the kernel where
+    // FileWriter can. Linear scaling refuses to convert to the same depth.
+    if (method == ConversionMethod::DirectCopy && 
+        newDataSize == numberOfSamples * BytesPerSample())
+    {
+        if (!writer->WriteFrom(*reader, dataOffset, newDataSize))
         {
-            case 8:
-                success = ConvertNext<Binary::UInt8Field>(method, depth);
-                break;
-            case 16:
-                success = ConvertNext<Binary::Int16Field>(method, depth);
-                break;
-            case 24:
-                success = ConvertNext<Binary::Int24Field>(method, depth);
-                break;
-            case 32:
-                success = ConvertNext<Binary::Int32Field>(method, depth);
-                break;
+            logger->Write("Unable to copy samples", Logging::LogLevel::Error);
+            return false;
         }
-
-        if (!success)
-            break;
-      
-        bytesRemaining -= bytesPerSample;
     }
-}
-
-long WaveFile::CalculateNumberOfSamples()
-{
-    constexpr int bitsPerByte{ 8 };
-    int bytesPerSample = format.bitsPerSample.Value() / bitsPerByte;
-    return dataHeader.dataSize.Value() / bytesPerSample;
-}
-
-long WaveFile::CalculateNewDataSize(BitDepth depth, long numberOfSamples)
-{
-    switch (depth)
+    else if (!WriteConvertedSamples(method, depth))
     {
-        case BitDepth::UInt8:
-            return numberOfSamples * 1;
-        case BitDepth::Int16:
-            return numberOfSamples * 2;
-        case BitDepth::Int24:
-            return numberOfSamples * 3;
-        case BitDepth::Int32:
-            return numberOfSamples * 4;
-        default:
-            return 0;
+        logger->Write("Unable to convert samples", Logging::LogLevel::Error);
+        return false;
     }
-}
 
-/*
-void WaveFile::WriteChunkHeader(RiffChunkHeader header)
-{
-    writeStream->Write(&header.id);
-    writeStream->Write(&header.size);
-    writeStream->Write(&header.type);
-}
+    // Chunks must start on even offsets, so an odd sized data chunk is
+    // followed by a pad byte.
+    if (newDataSize & 1)
+    {
+        std::uint8_t pad{ 0 };
+        writer->Write(&pad, 1);
+    }
 
-void WaveFile::WriteSubChunkHeader(RiffSubChunkHeader header)
-{
-    writeStream->Write(&header.id);
-    writeStream->Write(&header.size);
+    if (!writer->Close())
+    {
+        logger->Write("Unable to write output file", Logging::LogLevel::Error);
+        return false;
+    }
+    return true;
 }
-*/
-
-/*
-void WaveFile::WriteFormatInfo(WaveFormat format)
-{
-    writeStream->Write(&format.audioFormat);
-    writeStream->Write(&format.channels);
-    writeStream->Write(&format.sampleRate);
-    writeStream->Write(&format.byteRate);
-    writeStream->Write(&format.blockAlign);
-    writeStream->Write(&format.bitsPerSample);
-}*/
 
 /*
 RiffChunkHeader WaveFile::GetNewChunkHeader(long sizeIncrease)
@@ -365,4 +295,46 @@ WaveFormat WaveFile::GetNewWaveFormat(BitDepth depth)
     newFormat.bitsPerSample.SetValue(bitsPerSample);
 
     return newFormat;
+}
+
+bool WaveFile::HasConvertedLayout(BitDepth depth)
+{
+    constexpr std::uint64_t chunkHeaderSize{ 8 };
+    constexpr std::uint64_t pcmFormatSize{ 16 };
+    WaveFormat newFormat = GetNewWaveFormat(depth);
+    if (formatOffset != 12 + chunkHeaderSize ||
+        formatHeader.dataSize.Value() != pcmFormatSize ||
+        newFormat.blockAlign.Value() != format.blockAlign.Value() ||
+        newFormat.byteRate.Value() != format.byteRate.Value() ||
+        newFormat.bitsPerSample.Value() != format.bitsPerSample.Value())
+        return false;
+
+    std::uint64_t end = formatOffset + pcmFormatSize;
+    for (const ChunkIndexEntry& chunk : otherChunks)
+    {
+        if (chunk.offset != end + chunkHeaderSize)
+            return false;
+        end = chunk.offset + chunk.PaddedSize();
+    }
+
+    // Convert drops whatever follows the data chunk, so nothing may.
+    std::uint64_t dataEnd = dataOffset + dataSize + (dataSize & 1);
+    return dataOffset == end + chunkHeaderSize &&
+           riffChunkHeader.dataSize.Value() == dataEnd - chunkHeaderSize &&
+           reader->Size() == dataEnd;
+}
+
+bool WaveFile::IsPlaceholderSize(std::uint32_t dataSize,
+    std::uint32_t riffSize, std::uint64_t dataOffset, std::uint64_t fileSize)
+{
+    if (dataSize == 0xFFFFFFFF)
+        return true;
+    if (dataSize != 0)
+        return false;
+
+    // A streamed RIFF size is a placeholder too and says nothing about
+    // what follows the data chunk.
+    if (fileSize == 0 || riffSize == 0 || riffSize == 0xFFFFFFFF)
+        return true;
+    return std::uint64_t{ riffSize } + 8 <= dataOffset;
 }
\ No newline at end of file